@@ -0,0 +1,95 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Runs random page reads over a file larger than the buffer pool, dirtying a share
+ * of the pages read, with the background writer off and on. Reports how many dirty
+ * pages were written by eviction in the foreground versus by the background writer,
+ * and the mean and 99th percentile readPage latency.
+ *
+ * Usage: bench_background_writer [frames] [pages] [dirty_percent] [seconds_per_run]
+ *                                [pages_per_round] [interval_ms]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 256;
+	const std::uint32_t pages = argc > 2 ? std::atoi(argv[2]) : 1000;
+	const std::uint32_t dirtyPercent = argc > 3 ? std::atoi(argv[3]) : 30;
+	const double seconds = argc > 4 ? std::atof(argv[4]) : 2.0;
+	BackgroundWriterConfig config;
+	config.pagesPerRound = argc > 5 ? std::atoi(argv[5]) : config.pagesPerRound;
+	config.intervalMs = argc > 6 ? std::atoi(argv[6]) : config.intervalMs;
+	const std::string filename = "bench_background_writer.db";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+	std::vector<PageId> pageIds(pages);
+	{
+		File file = File::create(filename);
+		for (std::uint32_t i = 0; i < pages; i++)
+		{
+			pageIds[i] = file.allocatePage().page_number();
+		}
+	}
+
+	std::cout << "writer\treads\tfg writes\tbg writes\tmean us\tp99 us\n";
+	for (int run = 0; run < 2; run++)
+	{
+		File file = File::open(filename);
+		PageBufferManager bufMgr(frames);
+		if (run == 1)
+		{
+			bufMgr.startBackgroundWriter(config);
+		}
+		std::vector<double> latencies;
+		std::uint32_t seed = 12345;
+		const std::chrono::steady_clock::time_point end =
+			std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+		while (std::chrono::steady_clock::now() < end)
+		{
+			seed = seed * 1103515245 + 12345;
+			const PageId pageNo = pageIds[(seed >> 8) % pages];
+			Page *page;
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			bufMgr.readPage(&file, pageNo, page);
+			latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+			bufMgr.unPinPage(&file, pageNo, (seed >> 4) % 100 < dirtyPercent);
+		}
+		bufMgr.stopBackgroundWriter();
+
+		double total = 0;
+		for (std::size_t i = 0; i < latencies.size(); i++)
+		{
+			total += latencies[i];
+		}
+		std::sort(latencies.begin(), latencies.end());
+		std::cout << (run == 1 ? "on" : "off") << "\t" << latencies.size() << "\t"
+				  << bufMgr.getBufStats().foregroundwrites << "\t" << bufMgr.getBufStats().backgroundwrites << "\t"
+				  << total / latencies.size() << "\t" << latencies[latencies.size() * 99 / 100] << "\n";
+		bufMgr.flushFile(&file);
+	}
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,166 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures loading a file page by page with File::allocatePage. The rate is
+ * printed for each tenth of the load, so allocation that slows down as the file
+ * grows shows up as falling rates. Then every tenth page is deleted and
+ * allocated again, which reuses free pages in the middle of the file.
+ *
+ * Last, the same number of pages is loaded into fresh files as extents: with
+ * File::allocatePages, with and without preallocating the disk space, and through
+ * a buffer pool, where PageBufferManager::allocatePage in a loop is compared with
+ * PageBufferManager::allocatePages. The pool loads unpin every page dirty, as a
+ * loader filling the pages would.
+ *
+ * Usage: bench_bulk_load [pages] [pages per extent] [frames]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "file.h"
+#include "file_iterator.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static void removeFile(const std::string &filename)
+{
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t pages = argc > 1 ? std::atoi(argv[1]) : 100000;
+	const std::uint32_t extentPages = argc > 2 ? std::atoi(argv[2]) : 256;
+	const std::uint32_t frames = argc > 3 ? std::atoi(argv[3]) : 4096;
+	const std::string filename = "bench_bulk_load.db";
+	removeFile(filename);
+
+	std::vector<PageId> pageNos;
+	{
+		File file = File::create(filename);
+		std::cout << "pages loaded\tpages/s\n";
+		const std::uint32_t step = pages >= 10 ? pages / 10 : 1;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const std::chrono::steady_clock::time_point loadStart = start;
+		for (std::uint32_t i = 1; i <= pages; i++)
+		{
+			pageNos.push_back(file.allocatePage().page_number());
+			if (i % step == 0)
+			{
+				std::cout << i << "\t" << (long)(step / secondsSince(start)) << "\n";
+				start = std::chrono::steady_clock::now();
+			}
+		}
+		std::cout << "load\t" << secondsSince(loadStart) << " s\n";
+
+		start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < pageNos.size(); i += 10)
+		{
+			file.deletePage(pageNos[i]);
+		}
+		const double deleteSeconds = secondsSince(start);
+		start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < pageNos.size(); i += 10)
+		{
+			file.allocatePage();
+		}
+		std::cout << "delete every tenth page\t" << deleteSeconds << " s\n"
+				  << "allocate them again\t" << secondsSince(start) << " s\n";
+	}
+
+	// Check the load by walking the used list of the file opened again
+	std::uint32_t used = 0;
+	{
+		File file = File::open(filename);
+		for (FileIterator iter = file.begin(); iter != file.end(); ++iter)
+		{
+			used++;
+		}
+	}
+	if (used != pages)
+	{
+		std::cout << "ERROR: " << used << " used pages after loading " << pages << "\n";
+	}
+	File::remove(filename);
+	if (used != pages)
+	{
+		return 1;
+	}
+
+	std::cout << "\nmethod\tseconds\tpages/s\n";
+	for (int preallocate = 0; preallocate < 2; preallocate++)
+	{
+		{
+			File file = File::create(filename);
+			std::vector<Page> extent;
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (std::uint32_t loaded = 0; loaded < pages; loaded += extentPages)
+			{
+				file.allocatePages(std::min(extentPages, pages - loaded), extent, preallocate);
+			}
+			const double seconds = secondsSince(start);
+			std::cout << "File::allocatePages" << (preallocate ? ", preallocated" : "") << "\t" << seconds << "\t"
+					  << (long)(pages / seconds) << "\n";
+		}
+		File::remove(filename);
+	}
+	for (int extents = 0; extents < 2; extents++)
+	{
+		{
+			File file = File::create(filename);
+			PageBufferManager bufMgr(frames);
+			std::vector<PageId> pageNumbers;
+			std::vector<Page *> extent;
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (std::uint32_t loaded = 0; loaded < pages; loaded += extentPages)
+			{
+				const std::uint32_t count = std::min(extentPages, pages - loaded);
+				if (extents)
+				{
+					bufMgr.allocatePages(&file, count, pageNumbers, extent);
+				}
+				else
+				{
+					pageNumbers.resize(count);
+					extent.resize(count);
+					for (std::uint32_t i = 0; i < count; i++)
+					{
+						bufMgr.allocatePage(&file, pageNumbers[i], extent[i]);
+					}
+				}
+				for (std::uint32_t i = 0; i < count; i++)
+				{
+					bufMgr.unPinPage(&file, pageNumbers[i], true);
+				}
+			}
+			bufMgr.flushFile(&file);
+			const double seconds = secondsSince(start);
+			std::cout << (extents ? "PageBufferManager::allocatePages" : "PageBufferManager::allocatePage loop") << "\t"
+					  << seconds << "\t" << (long)(pages / seconds) << "\n";
+		}
+		File::remove(filename);
+	}
+	return 0;
+}
@@ -0,0 +1,235 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures the clock sweep per evicted frame over a large pool: ClockPolicy over
+ * FrameTable bitmaps, a word at a time and with AVX2, against a frame-at-a-time
+ * sweep over an array of per-frame structs laid out like the former BufferStatus. Before each batch of
+ * evictions a share of the frames is referenced again (untimed), so the hand has to
+ * pass referenced and pinned frames to find victims.
+ *
+ * A second table shows the worst case of a single eviction: every frame is
+ * referenced, so the hand goes around the whole pool once before it finds a victim.
+ *
+ * Usage: bench_clock_sweep [frames] [rounds]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "frame_table.h"
+#include "replacement_policy.h"
+
+using namespace badgerdb;
+
+/**
+ * Per-frame metadata as stored before the frame table
+ */
+struct FrameStatus
+{
+	File *file;
+	PageId pageNo;
+	FrameId frameNo;
+	std::atomic<int> pinCnt;
+	std::atomic<bool> dirty;
+	bool valid;
+	std::atomic<bool> refbit;
+	std::atomic<bool> inRing;
+};
+
+/**
+ * The former ClockPolicy::pickVictim, one frame at a time
+ */
+static bool pickVictim(std::vector<FrameStatus> &table, FrameId &clockHand, FrameId &frame)
+{
+	const std::uint32_t numBufs = table.size();
+	std::uint32_t nPinnedPages = 0;
+	while (true)
+	{
+		if (table[clockHand].pinCnt > 0)
+		{
+			nPinnedPages += 1;
+			clockHand = (clockHand + 1) % numBufs;
+		}
+		else if (!table[clockHand].valid || !table[clockHand].refbit)
+		{
+			frame = clockHand;
+			return true;
+		}
+		else
+		{
+			table[clockHand].refbit = false;
+			clockHand = (clockHand + 1) % numBufs;
+		}
+		if (nPinnedPages == numBufs)
+		{
+			return false;
+		}
+	}
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 1 << 20;
+	const std::uint32_t rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+	const std::uint32_t evictionsPerRound = frames / 64;
+	const int pinnedPercents[] = {0, 50, 90};
+	// In thousandths
+	const int referencedShares[] = {500, 900, 990, 999};
+
+	std::cout << "pinned %\treferenced %\tstructs ns/evict\tbitmaps ns/evict\tAVX2 ns/evict\n";
+	for (int p = 0; p < 3; p++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			unsigned seed = 42;
+			std::vector<char> pinned(frames);
+			for (std::uint32_t i = 0; i < frames; i++)
+			{
+				pinned[i] = (int)(rand_r(&seed) % 100) < pinnedPercents[p];
+			}
+
+			std::vector<FrameStatus> structs(frames);
+			FrameTable scalarTable(frames, PoolMemoryConfig());
+			FrameTable vectorTable(frames, PoolMemoryConfig());
+			FrameTable *tables[] = {&scalarTable, &vectorTable};
+			std::unique_ptr<ReplacementPolicy> clocks[] = {
+				std::unique_ptr<ReplacementPolicy>(ReplacementPolicy::create(ReplacementPolicyType::CLOCK, frames, &scalarTable)),
+				std::unique_ptr<ReplacementPolicy>(ReplacementPolicy::create(ReplacementPolicyType::CLOCK, frames, &vectorTable))};
+			for (FrameId i = 0; i < frames; i++)
+			{
+				structs[i].frameNo = i;
+				structs[i].valid = true;
+				structs[i].pinCnt = pinned[i];
+				structs[i].refbit = false;
+				for (int t = 0; t < 2; t++)
+				{
+					tables[t]->reserve(i);
+					tables[t]->set(i, NULL, i + 1);
+					if (!pinned[i])
+						tables[t]->unpin(i);
+				}
+			}
+
+			double structSeconds = 0, bitmapSeconds[] = {0, 0};
+			FrameId clockHand = frames - 1;
+			for (std::uint32_t round = 0; round < rounds; round++)
+			{
+				for (FrameId i = 0; i < frames; i++)
+				{
+					if ((int)(rand_r(&seed) % 1000) < referencedShares[r])
+					{
+						structs[i].refbit = true;
+						scalarTable.setReferenced(i, true);
+						vectorTable.setReferenced(i, true);
+					}
+				}
+
+				// An evicted frame is refilled and unpinned right away, as after a miss
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				for (std::uint32_t e = 0; e < evictionsPerRound; e++)
+				{
+					FrameId victim;
+					pickVictim(structs, clockHand, victim);
+					// Clear() and pinCnt = 1 in evictFrame, Set() in publishFrame, then unPinPage
+					FrameStatus &status = structs[victim];
+					status.pinCnt = 0;
+					status.file = NULL;
+					status.pageNo = Page::INVALID_NUMBER;
+					status.dirty = false;
+					status.refbit = false;
+					status.valid = false;
+					status.inRing = false;
+					status.pinCnt = 1;
+					status.pageNo = victim + 1;
+					status.pinCnt = 1;
+					status.dirty = false;
+					status.valid = true;
+					status.refbit = true;
+					status.pinCnt -= 1;
+				}
+				structSeconds += secondsSince(start);
+
+				for (int t = 0; t < 2; t++)
+				{
+					FrameTable::setVectorized(t == 1);
+					start = std::chrono::steady_clock::now();
+					for (std::uint32_t e = 0; e < evictionsPerRound; e++)
+					{
+						FrameId victim;
+						clocks[t]->pickVictim(victim);
+						tables[t]->reserve(victim);
+						tables[t]->set(victim, NULL, victim + 1);
+						tables[t]->unpin(victim);
+					}
+					bitmapSeconds[t] += secondsSince(start);
+				}
+			}
+			const double evictions = (double)rounds * evictionsPerRound;
+			std::cout << pinnedPercents[p] << "\t" << referencedShares[r] / 10.0 << "\t"
+					  << structSeconds * 1e9 / evictions << "\t" << bitmapSeconds[0] * 1e9 / evictions
+					  << "\t" << bitmapSeconds[1] * 1e9 / evictions << "\n";
+		}
+	}
+
+	std::cout << "\npinned %\tstructs us/revolution\tbitmaps us/revolution\tAVX2 us/revolution\n";
+	for (int p = 0; p < 3; p++)
+	{
+		unsigned seed = 42;
+		std::vector<FrameStatus> structs(frames);
+		FrameTable table(frames, PoolMemoryConfig());
+		std::unique_ptr<ReplacementPolicy> clock(ReplacementPolicy::create(ReplacementPolicyType::CLOCK, frames, &table));
+		for (FrameId i = 0; i < frames; i++)
+		{
+			const bool pin = (int)(rand_r(&seed) % 100) < pinnedPercents[p];
+			structs[i].valid = true;
+			structs[i].pinCnt = pin;
+			table.reserve(i);
+			table.set(i, NULL, i + 1);
+			if (!pin)
+				table.unpin(i);
+		}
+		FrameId clockHand = frames - 1;
+		double seconds[] = {0, 0, 0};
+		for (std::uint32_t round = 0; round < rounds; round++)
+		{
+			for (FrameId i = 0; i < frames; i++)
+			{
+				structs[i].refbit = true;
+				table.setReferenced(i, true);
+			}
+			FrameId victim;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			pickVictim(structs, clockHand, victim);
+			seconds[0] += secondsSince(start);
+			for (int t = 0; t < 2; t++)
+			{
+				FrameTable::setVectorized(t == 1);
+				if (t == 1)
+				{
+					for (FrameId i = 0; i < frames; i++)
+						table.setReferenced(i, true);
+				}
+				start = std::chrono::steady_clock::now();
+				clock->pickVictim(victim);
+				seconds[t + 1] += secondsSince(start);
+			}
+		}
+		std::cout << pinnedPercents[p] << "\t" << seconds[0] * 1e6 / rounds << "\t"
+				  << seconds[1] * 1e6 / rounds << "\t" << seconds[2] * 1e6 / rounds << "\n";
+	}
+	return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures buffer-hit throughput of PageBufferManager::readPage/unPinPage with
+ * 1 to 32 threads on a hot working set that fits in the buffer pool.
+ *
+ * Usage: bench_concurrent_hits [hot_pages] [seconds_per_run]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t hotPages = argc > 1 ? std::atoi(argv[1]) : 1024;
+	const double seconds = argc > 2 ? std::atof(argv[2]) : 1.0;
+	const std::string filename = "bench_concurrent_hits.db";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		PageBufferManager bufMgr(hotPages + 64);
+
+		std::vector<PageId> pageIds(hotPages);
+		for (std::uint32_t i = 0; i < hotPages; i++)
+		{
+			Page *page;
+			bufMgr.allocatePage(&file, pageIds[i], page);
+			bufMgr.unPinPage(&file, pageIds[i], true);
+		}
+
+		std::cout << "threads\thits/s\tspeedup\n";
+		double baseline = 0;
+		for (int nThreads = 1; nThreads <= 32; nThreads *= 2)
+		{
+			std::atomic<bool> stop(false);
+			std::atomic<long> totalHits(0);
+			std::vector<std::thread> workers;
+			for (int t = 0; t < nThreads; t++)
+			{
+				workers.push_back(std::thread([&, t]()
+											  {
+					std::uint32_t seed = 12345 + t;
+					long hits = 0;
+					Page *page;
+					while (!stop.load(std::memory_order_relaxed))
+					{
+						seed = seed * 1103515245 + 12345;
+						const PageId pageNo = pageIds[(seed >> 8) % hotPages];
+						bufMgr.readPage(&file, pageNo, page);
+						bufMgr.unPinPage(&file, pageNo, false);
+						hits++;
+					}
+					totalHits += hits; }));
+			}
+			std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+			stop = true;
+			for (std::size_t t = 0; t < workers.size(); t++)
+			{
+				workers[t].join();
+			}
+			const double rate = totalHits / seconds;
+			if (nThreads == 1)
+			{
+				baseline = rate;
+			}
+			std::cout << nThreads << "\t" << (long)rate << "\t" << rate / baseline << "\n";
+		}
+		bufMgr.flushFile(&file);
+	}
+	File::remove(filename);
+	return 0;
+}
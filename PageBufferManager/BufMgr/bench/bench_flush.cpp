@@ -0,0 +1,112 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures writing back a large number of dirty buffered pages of one file:
+ * one File::writePage call per page (how flushFile used to write), one
+ * File::writePages call, and PageBufferManager::flushFile, which uses writePages,
+ * in CHECKPOINT mode (pages copied and kept) and in the default EVICT mode. After
+ * each flushFile every page is read again through the pool: hits after a
+ * checkpoint, reads from the file after an evicting flush.
+ *
+ * Usage: bench_flush [pages]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static void createFile(const std::string &filename, const std::uint32_t pages)
+{
+	File file = File::create(filename);
+	for (std::uint32_t i = 0; i < pages; i++)
+	{
+		file.allocatePage();
+	}
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t pages = argc > 1 ? std::atoi(argv[1]) : 100000;
+	const std::string filename = "bench_flush.db";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+	createFile(filename, pages);
+
+	{
+		File file = File::open(filename);
+		PageBufferManager bufMgr(pages);
+		std::vector<const Page *> buffered(pages);
+		for (PageId pageNo = 1; pageNo <= pages; pageNo++)
+		{
+			Page *page;
+			bufMgr.readPage(&file, pageNo, page);
+			page->insertRecord("dirty");
+			buffered[pageNo - 1] = page;
+		}
+
+		std::cout << "method\tseconds\tpages/s\n";
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (std::uint32_t i = 0; i < pages; i++)
+		{
+			file.writePage(*buffered[i]);
+		}
+		double seconds = secondsSince(start);
+		std::cout << "writePage\t" << seconds << "\t" << (long)(pages / seconds) << "\n";
+
+		start = std::chrono::steady_clock::now();
+		file.writePages(buffered);
+		seconds = secondsSince(start);
+		std::cout << "writePages\t" << seconds << "\t" << (long)(pages / seconds) << "\n";
+
+		for (PageId pageNo = 1; pageNo <= pages; pageNo++)
+		{
+			bufMgr.unPinPage(&file, pageNo, true);
+		}
+		for (int evict = 0; evict < 2; evict++)
+		{
+			FlushOptions options;
+			options.mode = evict ? FlushMode::EVICT : FlushMode::CHECKPOINT;
+			start = std::chrono::steady_clock::now();
+			const FlushSummary summary = bufMgr.flushFile(&file, options);
+			seconds = secondsSince(start);
+			std::cout << (evict ? "flushFile evict" : "flushFile checkpoint") << "\t" << seconds << "\t"
+					  << (long)(summary.pagesWritten / seconds) << "\n";
+
+			start = std::chrono::steady_clock::now();
+			for (PageId pageNo = 1; pageNo <= pages; pageNo++)
+			{
+				Page *page;
+				bufMgr.readPage(&file, pageNo, page);
+				bufMgr.unPinPage(&file, pageNo, true);
+			}
+			seconds = secondsSince(start);
+			std::cout << "  read all pages again\t" << seconds << "\t" << (long)(pages / seconds) << "\n";
+		}
+		bufMgr.flushFile(&file);
+	}
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures handing out frames while the pool has free ones: the frame table's free
+ * list against the former clock, which found frames holding no page as its hand
+ * passed them (a word at a time over the bitmaps, as ClockPolicy did before).
+ * - warm-up: every frame of an empty pool is filled
+ * - bulk drop: the first half of the pool holds referenced pages of a file that is
+ *   kept, the second half is emptied (a file was flushed), and the hand is at frame
+ *   0; the second half is filled again
+ * The time of the first frame handed out and the mean time per frame are printed,
+ * and how many pages kept lost their reference bit (their second chance) on the way.
+ *
+ * Usage: bench_free_list [frames] [rounds]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "frame_table.h"
+
+using namespace badgerdb;
+
+/**
+ * The former ClockPolicy::pickVictim, which took invalid frames as victims
+ */
+static FrameId formerPickVictim(FrameTable &table, FrameId &clockHand)
+{
+	std::uint32_t word = FrameTable::wordOf(clockHand);
+	std::uint64_t mask = ~0ull << (clockHand % FrameTable::WORD_BITS);
+	while (true)
+	{
+		const std::uint64_t unpinned = ~table.pinnedWord(word) & mask;
+		const std::uint64_t candidates = unpinned & ~(table.validWord(word) & table.referencedWord(word));
+		if (candidates != 0)
+		{
+			const std::uint32_t victim = __builtin_ctzll(candidates);
+			table.clearReferenced(word, unpinned & ((1ull << victim) - 1));
+			clockHand = word * FrameTable::WORD_BITS + victim;
+			return clockHand;
+		}
+		table.clearReferenced(word, unpinned);
+		word = (word + 1) % table.words();
+		mask = ~0ull;
+	}
+}
+
+struct Timing
+{
+	double firstNanos;
+	double meanNanos;
+	std::uint32_t secondChancesLost;
+};
+
+/**
+ * Fills the frames [first, last) of a table whose other frames hold referenced pages
+ */
+static Timing fill(const std::uint32_t frames, const std::uint32_t first, const std::uint32_t last, const bool freeList)
+{
+	FrameTable table(frames, PoolMemoryConfig());
+	FrameId frame;
+	for (FrameId i = 0; i < frames; i++)
+	{
+		table.popFree(frame);
+		if (i < first || i >= last)
+		{
+			table.set(frame, NULL, frame + 1);
+			table.setReferenced(frame, true);
+			table.unpin(frame);
+		}
+	}
+	for (FrameId i = last; i > first; i--)
+	{
+		table.clear(i - 1);
+		table.pushFree(i - 1);
+	}
+
+	FrameId clockHand = first == 0 ? frames - 1 : 0;
+	Timing timing = {0, 0, 0};
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (FrameId i = first; i < last; i++)
+	{
+		if (freeList)
+		{
+			table.popFree(frame);
+		}
+		else
+		{
+			frame = formerPickVictim(table, clockHand);
+			table.reserve(frame);
+		}
+		table.set(frame, NULL, frame + 1);
+		if (i == first)
+		{
+			timing.firstNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+	timing.meanNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (last - first);
+	for (FrameId i = 0; i < frames; i++)
+	{
+		if ((i < first || i >= last) && !table.isReferenced(i))
+			timing.secondChancesLost++;
+	}
+	return timing;
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 1 << 20;
+	const int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+	std::cout << frames << " frames, best of " << rounds << " rounds\n";
+	std::cout << "case        method       first ns  ns/frame  second chances lost\n";
+	for (int bulkDrop = 0; bulkDrop < 2; bulkDrop++)
+	{
+		for (int freeList = 0; freeList < 2; freeList++)
+		{
+			Timing best = {1e30, 1e30, 0};
+			for (int r = 0; r < rounds; r++)
+			{
+				const Timing timing = fill(frames, bulkDrop ? frames / 2 : 0, frames, freeList);
+				best.firstNanos = std::min(best.firstNanos, timing.firstNanos);
+				best.meanNanos = std::min(best.meanNanos, timing.meanNanos);
+				best.secondChancesLost = timing.secondChancesLost;
+			}
+			std::cout << (bulkDrop ? "bulk drop   " : "warm-up     ") << (freeList ? "free list  " : "clock      ")
+					  << "  " << best.firstNanos << "  " << best.meanNanos << "  " << best.secondChancesLost << "\n";
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Compares insert, lookup and remove throughput of BufHashTbl (open addressing)
+ * with the chained hash table it replaced, at 1K, 100K and 1M frames.
+ *
+ * Usage: bench_hash_table
+ */
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "file.h"
+#include "bufHashTbl.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+/**
+ * The previous BufHashTbl: one heap-allocated node per entry, chained per bucket.
+ */
+class ChainedHashTbl
+{
+	struct Node
+	{
+		const File *file;
+		PageId pageNo;
+		FrameId frameNo;
+		Node *next;
+	};
+
+	int HTSIZE;
+	Node **ht;
+
+	int hash(const File *file, const PageId pageNo)
+	{
+		int tmp = (long)file;
+		return (tmp + pageNo) % HTSIZE;
+	}
+
+public:
+	ChainedHashTbl(const int htSize) : HTSIZE(htSize)
+	{
+		ht = new Node *[htSize];
+		for (int i = 0; i < HTSIZE; i++)
+			ht[i] = NULL;
+	}
+
+	~ChainedHashTbl()
+	{
+		for (int i = 0; i < HTSIZE; i++)
+		{
+			while (ht[i])
+			{
+				Node *tmp = ht[i];
+				ht[i] = ht[i]->next;
+				delete tmp;
+			}
+		}
+		delete[] ht;
+	}
+
+	void insert(const File *file, const PageId pageNo, const FrameId frameNo)
+	{
+		int index = hash(file, pageNo);
+		Node *node = new Node;
+		node->file = file;
+		node->pageNo = pageNo;
+		node->frameNo = frameNo;
+		node->next = ht[index];
+		ht[index] = node;
+	}
+
+	bool tryLookup(const File *file, const PageId pageNo, FrameId &frameNo)
+	{
+		for (Node *node = ht[hash(file, pageNo)]; node; node = node->next)
+		{
+			if (node->file == file && node->pageNo == pageNo)
+			{
+				frameNo = node->frameNo;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void remove(const File *file, const PageId pageNo)
+	{
+		int index = hash(file, pageNo);
+		Node *prev = NULL;
+		for (Node *node = ht[index]; node; prev = node, node = node->next)
+		{
+			if (node->file == file && node->pageNo == pageNo)
+			{
+				if (prev)
+					prev->next = node->next;
+				else
+					ht[index] = node->next;
+				delete node;
+				return;
+			}
+		}
+	}
+};
+
+static double nsPerOp(std::chrono::steady_clock::time_point start, std::uint32_t ops)
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+}
+
+/**
+ * Inserts, looks up and removes pages spread over the given files, keeping the
+ * access order scrambled so lookups do not walk the table sequentially.
+ */
+template <class Table>
+static void run(const char *name, Table &table, const std::vector<File *> &files, std::uint32_t frames)
+{
+	std::vector<std::uint32_t> order(frames);
+	for (std::uint32_t i = 0; i < frames; i++)
+		order[i] = i;
+	for (std::uint32_t i = frames - 1; i > 0; i--)
+		std::swap(order[i], order[(std::uint64_t)i * 2654435761u % (i + 1)]);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (std::uint32_t i = 0; i < frames; i++)
+		table.insert(files[i % files.size()], i / files.size() + 1, i);
+	const double insertNs = nsPerOp(start, frames);
+
+	FrameId frameNo;
+	std::uint64_t sum = 0;
+	start = std::chrono::steady_clock::now();
+	for (int round = 0; round < 4; round++)
+	{
+		for (std::uint32_t i = 0; i < frames; i++)
+		{
+			const std::uint32_t j = order[i];
+			if (table.tryLookup(files[j % files.size()], j / files.size() + 1, frameNo))
+				sum += frameNo;
+		}
+	}
+	const double lookupNs = nsPerOp(start, 4 * frames);
+
+	start = std::chrono::steady_clock::now();
+	for (std::uint32_t i = 0; i < frames; i++)
+	{
+		const std::uint32_t j = order[i];
+		table.remove(files[j % files.size()], j / files.size() + 1);
+	}
+	const double removeNs = nsPerOp(start, frames);
+
+	std::cout << name << "\t" << frames << "\t" << insertNs << "\t" << lookupNs << "\t" << removeNs
+			  << (sum == 0 && frames > 1 ? "\t(no hits?)" : "") << "\n";
+}
+
+int main()
+{
+	const int nFiles = 8;
+	std::vector<std::string> names;
+	std::vector<File *> files;
+	for (int i = 0; i < nFiles; i++)
+	{
+		names.push_back("bench_hash_table." + std::to_string(i));
+		try
+		{
+			File::remove(names.back());
+		}
+		catch (FileNotFoundException &)
+		{
+		}
+		files.push_back(new File(File::create(names.back())));
+	}
+
+	std::cout << "table\tframes\tinsert ns\tlookup ns\tremove ns\n";
+	const std::uint32_t sizes[] = {1000, 100000, 1000000};
+	for (std::uint32_t frames : sizes)
+	{
+		{
+			ChainedHashTbl chained(frames * 1.2 + 1);
+			run("chained", chained, files, frames);
+		}
+		{
+			BufHashTbl flat(frames);
+			run("flat", flat, files, frames);
+		}
+	}
+
+	for (int i = 0; i < nFiles; i++)
+	{
+		delete files[i];
+		File::remove(names[i]);
+	}
+	return 0;
+}
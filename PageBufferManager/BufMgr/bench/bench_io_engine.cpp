@@ -0,0 +1,165 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures random reads of single pages through each I/O engine at several queue
+ * depths, for a file in the working directory and, if present, one in /dev/shm.
+ * Files are opened with O_DIRECT where the file system allows it so that reads
+ * reach the device instead of the page cache.
+ *
+ * Usage: bench_io_engine [pages] [seconds]
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "io_engine.h"
+#include "page.h"
+
+using namespace badgerdb;
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool createFile(const std::string &filename, const std::uint32_t pages)
+{
+	const int fd = open(filename.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	if (fd < 0)
+	{
+		return false;
+	}
+	std::vector<char> data(Page::SIZE, 'x');
+	for (std::uint32_t i = 0; i < pages; i++)
+	{
+		if (pwrite(fd, &data[0], data.size(), (off_t)i * Page::SIZE) != (ssize_t)data.size())
+		{
+			close(fd);
+			return false;
+		}
+	}
+	fsync(fd);
+	close(fd);
+	return true;
+}
+
+/**
+ * Reads random pages for the given time with at most queueDepth reads in flight
+ * and returns the number of reads per second.
+ */
+static double measure(const int fd, IoEngineType type, const std::uint32_t queueDepth,
+					  const std::uint32_t pages, const double seconds)
+{
+	std::vector<char *> buffers(queueDepth);
+	for (std::uint32_t i = 0; i < queueDepth; i++)
+	{
+		void *buffer;
+		if (posix_memalign(&buffer, 4096, Page::SIZE) != 0)
+		{
+			std::abort();
+		}
+		buffers[i] = static_cast<char *>(buffer);
+	}
+	std::mutex latch;
+	std::condition_variable returned;
+	std::vector<char *> idle(buffers);
+	std::uint64_t completed = 0;
+	unsigned seed = 42;
+	{
+		std::unique_ptr<IoEngine> engine(IoEngine::create(type, queueDepth, queueDepth));
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (secondsSince(start) < seconds)
+		{
+			char *buffer;
+			{
+				std::unique_lock<std::mutex> guard(latch);
+				while (idle.empty())
+				{
+					returned.wait(guard);
+				}
+				buffer = idle.back();
+				idle.pop_back();
+			}
+			struct iovec iov = {buffer, Page::SIZE};
+			const off_t offset = (off_t)(rand_r(&seed) % pages) * Page::SIZE;
+			engine->submit(fd, &iov, 1, offset, false, [&, buffer](ssize_t result)
+						   {
+				if (result != (ssize_t)Page::SIZE)
+				{
+					std::abort();
+				}
+				{
+					std::lock_guard<std::mutex> guard(latch);
+					idle.push_back(buffer);
+					completed++;
+				}
+				returned.notify_one(); });
+		}
+		engine.reset();
+		const double elapsed = secondsSince(start);
+		for (std::uint32_t i = 0; i < queueDepth; i++)
+		{
+			free(buffers[i]);
+		}
+		return completed / elapsed;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t pages = argc > 1 ? std::atoi(argv[1]) : 16384;
+	const double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+	const std::string filenames[] = {"bench_io_engine.db", "/dev/shm/bench_io_engine.db"};
+	const IoEngineType types[] = {IoEngineType::IO_URING, IoEngineType::THREAD_POOL};
+	const char *typeNames[] = {"io_uring", "thread pool"};
+	const std::uint32_t depths[] = {1, 8, 64};
+
+	std::cout << "file\tO_DIRECT\tengine\tqueue depth\treads/s\n";
+	for (int f = 0; f < 2; f++)
+	{
+		if (!createFile(filenames[f], pages))
+		{
+			continue;
+		}
+		bool direct = true;
+		int fd = open(filenames[f].c_str(), O_RDONLY | O_DIRECT);
+		if (fd < 0)
+		{
+			direct = false;
+			fd = open(filenames[f].c_str(), O_RDONLY);
+		}
+		for (int t = 0; t < 2; t++)
+		{
+			for (int d = 0; d < 3; d++)
+			{
+				try
+				{
+					const double rate = measure(fd, types[t], depths[d], pages, seconds);
+					std::cout << filenames[f] << "\t" << (direct ? "yes" : "no") << "\t" << typeNames[t]
+							  << "\t" << depths[d] << "\t" << (std::uint64_t)rate << "\n";
+				}
+				catch (const std::exception &e)
+				{
+					std::cout << filenames[f] << "\t" << (direct ? "yes" : "no") << "\t" << typeNames[t]
+							  << "\t" << depths[d] << "\tunavailable\n";
+				}
+			}
+		}
+		close(fd);
+		unlink(filenames[f].c_str());
+	}
+	return 0;
+}
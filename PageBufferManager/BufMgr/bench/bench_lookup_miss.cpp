@@ -0,0 +1,82 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Compares the latency of a hash table miss reported by BufHashTbl::lookup
+ * (throws HashNotFoundException, the old readPage miss path) with the same miss
+ * reported by BufHashTbl::tryLookup.
+ *
+ * Usage: bench_lookup_miss [frames] [misses]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "file.h"
+#include "bufHashTbl.h"
+#include "exceptions/file_not_found_exception.h"
+#include "exceptions/hash_not_found_exception.h"
+
+using namespace badgerdb;
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 1024;
+	const long misses = argc > 2 ? std::atol(argv[2]) : 200000;
+	const std::string filename = "bench_lookup_miss.db";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		BufHashTbl hashTable(frames);
+		for (FrameId i = 0; i < frames; i++)
+		{
+			hashTable.insert(&file, i + 1, i);
+		}
+
+		FrameId frameNo;
+		long found = 0;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (long i = 0; i < misses; i++)
+		{
+			try
+			{
+				hashTable.lookup(&file, frames + 1 + i, frameNo);
+				found++;
+			}
+			catch (HashNotFoundException &e)
+			{
+			}
+		}
+		const double throwingNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / misses;
+
+		start = std::chrono::steady_clock::now();
+		for (long i = 0; i < misses; i++)
+		{
+			if (hashTable.tryLookup(&file, frames + 1 + i, frameNo))
+			{
+				found++;
+			}
+		}
+		const double tryNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / misses;
+
+		std::cout << "lookup (throws on miss):  " << throwingNs << " ns/miss\n";
+		std::cout << "tryLookup (returns false): " << tryNs << " ns/miss\n";
+		std::cout << "speedup: " << throwingNs / tryNs << "x (" << found << " unexpected hits)\n";
+	}
+	File::remove(filename);
+	return 0;
+}
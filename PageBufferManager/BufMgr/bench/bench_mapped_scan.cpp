@@ -0,0 +1,182 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures scanning every record of a file: with File, which reads each page
+ * into a page of its own, against MappedFile, which returns views of the pages in
+ * its mapping, both through their iterators and through a buffer pool reading
+ * with SEQUENTIAL_SCAN (the mapped file registered with the pool). Each scan runs
+ * cold, after the file was dropped from the page cache, and warm.
+ *
+ * Usage: bench_mapped_scan [pages] [frames]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "file_iterator.h"
+#include "mapped_file.h"
+#include "page_iterator.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Writes the file to disk and drops it from the page cache
+ */
+static void dropCache(const std::string &filename)
+{
+	const int fd = ::open(filename.c_str(), O_RDONLY);
+	::fdatasync(fd);
+	::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	::close(fd);
+}
+
+static std::size_t scanPage(Page &page)
+{
+	std::size_t bytes = 0;
+	for (PageIterator iter = page.begin(); iter != page.end(); ++iter)
+	{
+		bytes += (*iter).size();
+	}
+	return bytes;
+}
+
+static std::size_t scanFile(File &file)
+{
+	std::size_t bytes = 0;
+	for (FileIterator iter = file.begin(); iter != file.end(); ++iter)
+	{
+		Page page = *iter;
+		bytes += scanPage(page);
+	}
+	return bytes;
+}
+
+static std::size_t scanMappedFile(MappedFile &file)
+{
+	std::size_t bytes = 0;
+	for (MappedFileIterator iter = file.begin(); iter != file.end(); ++iter)
+	{
+		Page page = *iter;
+		bytes += scanPage(page);
+	}
+	return bytes;
+}
+
+static std::size_t scanPool(PageBufferManager &bufMgr, File *file, const std::uint32_t pages)
+{
+	std::size_t bytes = 0;
+	for (PageId pageNo = 1; pageNo <= pages; pageNo++)
+	{
+		Page *page;
+		bufMgr.readPage(file, pageNo, page, AccessHint::SEQUENTIAL_SCAN);
+		bytes += scanPage(*page);
+		bufMgr.unPinPage(file, pageNo, false);
+	}
+	return bytes;
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t pages = argc > 1 ? std::atoi(argv[1]) : 50000;
+	const std::uint32_t frames = argc > 2 ? std::atoi(argv[2]) : 1024;
+	const std::string filename = "bench_mapped_scan.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		const std::string record(100, 'r');
+		std::vector<Page> extent;
+		for (std::uint32_t loaded = 0; loaded < pages; loaded += 256)
+		{
+			file.allocatePages(std::min<std::uint32_t>(256, pages - loaded), extent);
+			std::vector<const Page *> written;
+			for (std::size_t i = 0; i < extent.size(); i++)
+			{
+				while (extent[i].hasSpaceForRecord(record))
+				{
+					extent[i].insertRecord(record);
+				}
+				written.push_back(&extent[i]);
+			}
+			file.writePages(written);
+		}
+	}
+
+	std::cout << pages << " pages, " << frames << " frames\n";
+	std::cout << "scan\tcache\tseconds\tMB/s\n";
+	std::size_t expected = 0;
+	for (int method = 0; method < 4; method++)
+	{
+		for (int warm = 0; warm < 2; warm++)
+		{
+			if (!warm)
+			{
+				dropCache(filename);
+			}
+			File file = File::open(filename);
+			MappedFile mapped(file);
+			std::size_t bytes;
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			if (method == 0)
+			{
+				bytes = scanFile(file);
+			}
+			else if (method == 1)
+			{
+				bytes = scanMappedFile(mapped);
+			}
+			else
+			{
+				PageBufferManager bufMgr(frames);
+				if (method == 3)
+				{
+					bufMgr.registerMappedFile(&mapped);
+				}
+				bytes = scanPool(bufMgr, method == 3 ? &mapped : &file, pages);
+				if (method == 3)
+				{
+					bufMgr.unregisterMappedFile(&mapped);
+				}
+			}
+			const double seconds = secondsSince(start);
+			if (expected == 0)
+			{
+				expected = bytes;
+			}
+			else if (bytes != expected)
+			{
+				std::cout << "ERROR: scanned " << bytes << " bytes instead of " << expected << "\n";
+				return 1;
+			}
+			static const char *const names[] = {"File", "MappedFile", "pool, File", "pool, MappedFile"};
+			std::cout << names[method] << "\t" << (warm ? "warm" : "cold") << "\t" << seconds << "\t"
+					  << (long)((double)pages * Page::SIZE / seconds / 1e6) << "\n";
+		}
+	}
+	File::remove(filename);
+	return 0;
+}
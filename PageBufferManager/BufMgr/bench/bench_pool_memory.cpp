@@ -0,0 +1,151 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures buffer hits spread over a large pool backed by each page size: every
+ * access reads a random page already buffered and reads its header. Reports
+ * hits per second, the memory of the process in transparent huge pages and,
+ * where perf events are permitted, data TLB load misses per hit (user space
+ * only).
+ *
+ * Usage: bench_pool_memory [frames] [seconds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static void createFile(const std::string &filename, const std::uint32_t pages)
+{
+	File file = File::create(filename);
+	for (std::uint32_t i = 0; i < pages; i++)
+	{
+		file.allocatePage();
+	}
+}
+
+/**
+ * Opens a counter of data TLB load misses of this thread, or returns -1
+ */
+static int openTlbCounter()
+{
+	struct perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HW_CACHE;
+	attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+				  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Returns the anonymous memory of this process held in transparent huge pages, in MB
+ */
+static std::uint64_t anonHugeMb()
+{
+	std::ifstream smaps("/proc/self/smaps_rollup");
+	std::string field;
+	std::uint64_t kb;
+	while (smaps >> field)
+	{
+		if (field == "AnonHugePages:" && smaps >> kb)
+		{
+			return kb / 1024;
+		}
+	}
+	return 0;
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 65536;
+	const double seconds = argc > 2 ? std::atof(argv[2]) : 3.0;
+	const std::string filename = "bench_pool_memory.db";
+	const PoolPageSize sizes[] = {PoolPageSize::NORMAL, PoolPageSize::TRANSPARENT_HUGE, PoolPageSize::EXPLICIT_HUGE};
+	const char *names[] = {"normal", "transparent huge", "explicit huge"};
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+	createFile(filename, frames);
+
+	std::cout << "asked\tobtained\thuge MB\thits/s\tdTLB misses/hit\n";
+	{
+		File file = File::open(filename);
+		for (int s = 0; s < 3; s++)
+		{
+			PoolMemoryConfig config;
+			config.pageSize = sizes[s];
+			PageBufferManager bufMgr(frames, ReplacementPolicyType::CLOCK, config);
+			std::vector<Page *> buffered(frames + 1);
+			for (PageId pageNo = 1; pageNo <= frames; pageNo++)
+			{
+				bufMgr.readPage(&file, pageNo, buffered[pageNo]);
+				bufMgr.unPinPage(&file, pageNo, false);
+			}
+
+			const int counter = openTlbCounter();
+			ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+			ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+			unsigned seed = 42;
+			std::uint64_t hits = 0;
+			volatile std::uint64_t sum = 0;
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			while ((hits & 1023) != 0 || secondsSince(start) < seconds)
+			{
+				const PageId pageNo = 1 + rand_r(&seed) % frames;
+				Page *page;
+				bufMgr.readPage(&file, pageNo, page);
+				sum += page->getFreeSpace();
+				bufMgr.unPinPage(&file, pageNo, false);
+				hits++;
+			}
+			const double elapsed = secondsSince(start);
+			ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+			long long misses = -1;
+			if (counter < 0 || read(counter, &misses, sizeof(misses)) != sizeof(misses))
+			{
+				misses = -1;
+			}
+			const char *obtained = names[(int)bufMgr.poolPageSize()];
+			std::cout << names[s] << "\t" << obtained << "\t" << anonHugeMb() << "\t" << (std::uint64_t)(hits / elapsed) << "\t";
+			if (misses >= 0)
+				std::cout << (double)misses / hits << "\n";
+			else
+				std::cout << "n/a\n";
+			if (counter >= 0)
+				close(counter);
+		}
+	}
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures sequential readPage throughput over a file with read-ahead disabled and
+ * enabled. The file is dropped from the OS page cache before each run (for clean
+ * pages, via posix_fadvise) so that reads go to the disk, and the reader spends a
+ * configurable number of microseconds of CPU time on every page.
+ *
+ * Usage: bench_prefetch [pages] [read_ahead] [work_us_per_page] [frames]
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static void dropFromPageCache(const std::string &filename)
+{
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+}
+
+static void spin(const int micros)
+{
+	const std::chrono::steady_clock::time_point until =
+		std::chrono::steady_clock::now() + std::chrono::microseconds(micros);
+	while (std::chrono::steady_clock::now() < until)
+	{
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t pages = argc > 1 ? std::atoi(argv[1]) : 2000;
+	const std::uint32_t readAhead = argc > 2 ? std::atoi(argv[2]) : 32;
+	const int workMicros = argc > 3 ? std::atoi(argv[3]) : 20;
+	const std::uint32_t frames = argc > 4 ? std::atoi(argv[4]) : 256;
+	const std::string filename = "bench_prefetch.db";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+	PageId firstPage = 0;
+	{
+		File file = File::create(filename);
+		for (std::uint32_t i = 0; i < pages; i++)
+		{
+			const PageId pageNo = file.allocatePage().page_number();
+			if (i == 0)
+			{
+				firstPage = pageNo;
+			}
+		}
+	}
+
+	std::cout << "read-ahead\tpages/s\tMB/s\tprefetched\n";
+	const std::uint32_t windows[] = {0, readAhead};
+	for (int run = 0; run < 2; run++)
+	{
+		dropFromPageCache(filename);
+		File file = File::open(filename);
+		PageBufferManager bufMgr(frames);
+		bufMgr.setReadAhead(windows[run]);
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (PageId pageNo = firstPage; pageNo < firstPage + pages; pageNo++)
+		{
+			Page *page;
+			bufMgr.readPage(&file, pageNo, page);
+			spin(workMicros);
+			bufMgr.unPinPage(&file, pageNo, false);
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << windows[run] << "\t" << (long)(pages / seconds) << "\t"
+				  << pages * (double)Page::SIZE / seconds / (1 << 20) << "\t"
+				  << bufMgr.getBufStats().prefetches << "\n";
+	}
+	File::remove(filename);
+	return 0;
+}
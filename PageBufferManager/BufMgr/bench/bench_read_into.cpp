@@ -0,0 +1,102 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures the cost of filling a buffer frame on a miss: reading a page by
+ * value and assigning it into the frame (how the buffer manager used to fill
+ * frames) against File::readPageInto, which reads straight into the frame.
+ * The file stays in the page cache, so the numbers show the CPU cost of the
+ * temporary page and the copy rather than device latency. The last line shows
+ * misses through PageBufferManager, which uses readPageInto.
+ *
+ * Usage: bench_read_into [pages] [reads]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t pages = argc > 1 ? std::atoi(argv[1]) : 1000;
+	const std::uint32_t reads = argc > 2 ? std::atoi(argv[2]) : 500000;
+	const std::string filename = "bench_read_into.db";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		std::vector<PageId> pageNos;
+		for (std::uint32_t i = 0; i < pages; i++)
+		{
+			Page page = file.allocatePage();
+			page.insertRecord("bench");
+			file.writePage(page);
+			pageNos.push_back(page.page_number());
+		}
+		std::vector<PageId> order(reads);
+		unsigned seed = 42;
+		for (std::uint32_t i = 0; i < reads; i++)
+		{
+			order[i] = pageNos[rand_r(&seed) % pages];
+		}
+
+		void *memory;
+		if (posix_memalign(&memory, Page::ALIGNMENT, Page::SIZE) != 0)
+		{
+			return 1;
+		}
+		Page frame(static_cast<char *>(memory));
+
+		std::cout << "method\tns/miss\n";
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (std::uint32_t i = 0; i < reads; i++)
+		{
+			frame = file.readPage(order[i]);
+		}
+		std::cout << "readPage + assign\t" << secondsSince(start) * 1e9 / reads << "\n";
+
+		start = std::chrono::steady_clock::now();
+		for (std::uint32_t i = 0; i < reads; i++)
+		{
+			file.readPageInto(order[i], frame);
+		}
+		std::cout << "readPageInto\t" << secondsSince(start) * 1e9 / reads << "\n";
+		free(memory);
+
+		// A one-frame pool misses on every read of a different page
+		PageBufferManager bufMgr(1);
+		start = std::chrono::steady_clock::now();
+		for (std::uint32_t i = 0; i < reads; i++)
+		{
+			Page *page;
+			bufMgr.readPage(&file, order[i], page);
+			bufMgr.unPinPage(&file, order[i], false);
+		}
+		std::cout << "PageBufferManager::readPage\t" << secondsSince(start) * 1e9 / reads << "\n";
+	}
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Replays one page access trace against a PageBufferManager configured with each
+ * replacement policy and reports the hit ratio of each.
+ *
+ * Without a trace file, a mixed workload is generated: skewed accesses to a hot set
+ * smaller than the pool, interrupted by sequential scans over the whole file.
+ * A trace file holds one page index (0-based) per line.
+ *
+ * Usage: bench_replacement_policies [frames] [file_pages] [trace_file]
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static std::vector<std::uint32_t> generateTrace(std::uint32_t filePages, std::uint32_t frames)
+{
+	std::vector<std::uint32_t> trace;
+	const std::uint32_t hotPages = frames * 3 / 4;
+	std::uint32_t seed = 42;
+	for (int phase = 0; phase < 20; phase++)
+	{
+		// OLTP phase: 80% of accesses to the first 20% of the hot set
+		for (int i = 0; i < 5000; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			const std::uint32_t r = (seed >> 8) % 100;
+			seed = seed * 1103515245 + 12345;
+			const std::uint32_t slot = (seed >> 8);
+			trace.push_back(r < 80 ? slot % (hotPages / 5 + 1) : slot % hotPages);
+		}
+		// Scan phase: a sequential pass over the cold part of the file
+		for (std::uint32_t page = hotPages; page < filePages; page++)
+		{
+			trace.push_back(page);
+		}
+	}
+	return trace;
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 200;
+	const std::uint32_t filePages = argc > 2 ? std::atoi(argv[2]) : 1000;
+	const std::string filename = "bench_replacement_policies.db";
+
+	std::vector<std::uint32_t> trace;
+	if (argc > 3)
+	{
+		std::ifstream traceFile(argv[3]);
+		std::uint32_t index;
+		while (traceFile >> index)
+		{
+			trace.push_back(index % filePages);
+		}
+	}
+	else
+	{
+		trace = generateTrace(filePages, frames);
+	}
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		std::vector<PageId> pageIds(filePages);
+		for (std::uint32_t i = 0; i < filePages; i++)
+		{
+			pageIds[i] = file.allocatePage().page_number();
+		}
+
+		const ReplacementPolicyType policies[] = {ReplacementPolicyType::CLOCK, ReplacementPolicyType::LRU_K,
+												  ReplacementPolicyType::TWO_Q, ReplacementPolicyType::ARC,
+												  ReplacementPolicyType::CLOCK_PRO};
+		const char *names[] = {"CLOCK", "LRU-2", "2Q", "ARC", "CLOCK-Pro"};
+
+		std::cout << trace.size() << " accesses, " << frames << " frames, " << filePages << " pages\n";
+		std::cout << "policy\thit ratio\n";
+		for (int p = 0; p < 5; p++)
+		{
+			PageBufferManager bufMgr(frames, policies[p]);
+			Page *page;
+			for (std::size_t i = 0; i < trace.size(); i++)
+			{
+				bufMgr.readPage(&file, pageIds[trace[i]], page);
+				bufMgr.unPinPage(&file, pageIds[trace[i]], false);
+			}
+			const BufStats &stats = bufMgr.getBufStats();
+			std::cout << names[p] << "\t" << 1.0 - (double)stats.diskreads / stats.accesses << "\n";
+		}
+	}
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures the hit ratio of a hot working set (an "index" file) while another thread
+ * repeatedly scans a file much larger than the buffer pool, once with the scan reading
+ * pages with AccessHint::NORMAL and once with AccessHint::SEQUENTIAL_SCAN.
+ *
+ * Every scan read misses in both cases since the scanned file does not fit in the
+ * pool, so the misses of the hot set are the disk reads not caused by the scan.
+ *
+ * Usage: bench_scan_ring [frames] [hot_pages] [scan_pages] [seconds_per_run]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static void createFile(const std::string &filename, const std::uint32_t pages, std::vector<PageId> &pageIds)
+{
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+	File file = File::create(filename);
+	pageIds.resize(pages);
+	for (std::uint32_t i = 0; i < pages; i++)
+	{
+		pageIds[i] = file.allocatePage().page_number();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 200;
+	const std::uint32_t hotPages = argc > 2 ? std::atoi(argv[2]) : 150;
+	const std::uint32_t scanPages = argc > 3 ? std::atoi(argv[3]) : 2000;
+	const double seconds = argc > 4 ? std::atof(argv[4]) : 2.0;
+	const std::string indexName = "bench_scan_ring_index.db";
+	const std::string tableName = "bench_scan_ring_table.db";
+
+	std::vector<PageId> hotIds;
+	std::vector<PageId> scanIds;
+	createFile(indexName, hotPages, hotIds);
+	createFile(tableName, scanPages, scanIds);
+
+	std::cout << "scan hint\thot reads\thot misses\thot hit ratio\tscan reads\n";
+	const AccessHint hints[] = {AccessHint::NORMAL, AccessHint::SEQUENTIAL_SCAN};
+	const char *hintNames[] = {"NORMAL", "SEQUENTIAL_SCAN"};
+	for (int h = 0; h < 2; h++)
+	{
+		File index = File::open(indexName);
+		File table = File::open(tableName);
+		PageBufferManager bufMgr(frames);
+		Page *page;
+
+		// Warm up the hot set before measuring
+		for (std::uint32_t i = 0; i < hotPages; i++)
+		{
+			bufMgr.readPage(&index, hotIds[i], page);
+			bufMgr.unPinPage(&index, hotIds[i], false);
+		}
+		bufMgr.clearBufStats();
+
+		std::atomic<bool> stop(false);
+		long hotReads = 0;
+		long scanReads = 0;
+		std::thread hot([&]()
+						{
+			std::uint32_t seed = 12345;
+			Page *hotPage;
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				seed = seed * 1103515245 + 12345;
+				const PageId pageNo = hotIds[(seed >> 8) % hotPages];
+				bufMgr.readPage(&index, pageNo, hotPage);
+				bufMgr.unPinPage(&index, pageNo, false);
+				hotReads++;
+			} });
+		std::thread scan([&]()
+						 {
+			Page *scanPage;
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				for (std::uint32_t i = 0; i < scanPages && !stop.load(std::memory_order_relaxed); i++)
+				{
+					bufMgr.readPage(&table, scanIds[i], scanPage, hints[h]);
+					bufMgr.unPinPage(&table, scanIds[i], false);
+					scanReads++;
+				}
+			} });
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+		stop = true;
+		hot.join();
+		scan.join();
+
+		const long hotMisses = bufMgr.getBufStats().diskreads - scanReads;
+		std::cout << hintNames[h] << "\t" << hotReads << "\t" << hotMisses << "\t"
+				  << (hotReads ? 1.0 - (double)hotMisses / hotReads : 0.0) << "\t" << scanReads << "\n";
+	}
+	File::remove(indexName);
+	File::remove(tableName);
+	return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures destroying a buffer manager whose every frame holds a dirty page: the
+ * destructor writes all of them back. The pages belong to several files and are
+ * read into the pool interleaved, so frames of one file are scattered over the pool.
+ *
+ * Usage: bench_shutdown [frames] [files]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static void createFile(const std::string &filename, const std::uint32_t pages)
+{
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+	File file = File::create(filename);
+	for (std::uint32_t i = 0; i < pages; i++)
+	{
+		file.allocatePage();
+	}
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 1 << 17;
+	const std::uint32_t numFiles = argc > 2 ? std::atoi(argv[2]) : 8;
+	const std::uint32_t pages = frames / numFiles;
+
+	std::vector<std::string> names;
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		std::ostringstream name;
+		name << "bench_shutdown." << f;
+		names.push_back(name.str());
+		createFile(names.back(), pages);
+	}
+
+	{
+		std::vector<std::unique_ptr<File> > files;
+		for (std::uint32_t f = 0; f < numFiles; f++)
+		{
+			files.push_back(std::unique_ptr<File>(new File(File::open(names[f]))));
+		}
+		PageBufferManager *bufMgr = new PageBufferManager(frames);
+		for (PageId pageNo = 1; pageNo <= pages; pageNo++)
+		{
+			for (std::uint32_t f = 0; f < numFiles; f++)
+			{
+				Page *page;
+				bufMgr->readPage(files[f].get(), pageNo, page);
+				page->insertRecord("dirty");
+				bufMgr->unPinPage(files[f].get(), pageNo, true);
+			}
+		}
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		delete bufMgr;
+		const double seconds = secondsSince(start);
+		std::cout << frames << " dirty frames of " << numFiles << " files: shutdown " << seconds << " s, "
+				  << (long)(pages * numFiles / seconds) << " pages/s\n";
+	}
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		File::remove(names[f]);
+	}
+	return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures closing many small files buffered in a large pool: each file's pages
+ * are read in (and dirtied in a second round), then PageBufferManager::flushFile is
+ * called for every file. A flush that scans the whole pool costs time in the pool
+ * size; one that walks the file's own frames costs time in the file's pages.
+ *
+ * Usage: bench_small_files [frames] [files] [pages per file]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "file.h"
+#include "pagebuffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+static void createFile(const std::string &filename, const std::uint32_t pages)
+{
+	try
+	{
+		File::remove(filename);
+	}
+	catch (FileNotFoundException &)
+	{
+	}
+	File file = File::create(filename);
+	for (std::uint32_t i = 0; i < pages; i++)
+	{
+		file.allocatePage();
+	}
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	const std::uint32_t frames = argc > 1 ? std::atoi(argv[1]) : 1 << 18;
+	const std::uint32_t numFiles = argc > 2 ? std::atoi(argv[2]) : 500;
+	const std::uint32_t pages = argc > 3 ? std::atoi(argv[3]) : 4;
+
+	std::vector<std::string> names;
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		std::ostringstream name;
+		name << "bench_small_files." << f;
+		names.push_back(name.str());
+		createFile(names.back(), pages);
+	}
+
+	std::cout << frames << " frames, " << numFiles << " files of " << pages << " pages\n";
+	std::cout << "pages\tus/flushFile\n";
+	{
+		std::vector<std::unique_ptr<File> > files;
+		for (std::uint32_t f = 0; f < numFiles; f++)
+		{
+			files.push_back(std::unique_ptr<File>(new File(File::open(names[f]))));
+		}
+		PageBufferManager bufMgr(frames);
+		for (int dirty = 0; dirty < 2; dirty++)
+		{
+			for (std::uint32_t f = 0; f < numFiles; f++)
+			{
+				for (PageId pageNo = 1; pageNo <= pages; pageNo++)
+				{
+					Page *page;
+					bufMgr.readPage(files[f].get(), pageNo, page);
+					bufMgr.unPinPage(files[f].get(), pageNo, dirty);
+				}
+			}
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (std::uint32_t f = 0; f < numFiles; f++)
+			{
+				bufMgr.flushFile(files[f].get());
+			}
+			std::cout << (dirty ? "dirty" : "clean") << "\t" << secondsSince(start) * 1e6 / numFiles << "\n";
+		}
+	}
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		File::remove(names[f]);
+	}
+	return 0;
+}
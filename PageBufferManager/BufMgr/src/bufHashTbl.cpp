@@ -16,105 +16,133 @@
 namespace badgerdb
 {
 
-  int BufHashTbl::hash(const File *file, const PageId pageNo)
+  std::uint64_t BufHashTbl::hash(const File *file, const PageId pageNo)
   {
-    int tmp, value;
-    tmp = (long)file; // cast of pointer to the file object to an integer
-    value = (tmp + pageNo) % HTSIZE;
+    // Combine the file pointer and page number, then run the 64 bit finalizer of
+    // MurmurHash3 so that every input bit affects the partition and slot bits.
+    std::uint64_t value = reinterpret_cast<std::uintptr_t>(file) * 0x9e3779b97f4a7c15ULL;
+    value ^= pageNo;
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
     return value;
   }
 
-  BufHashTbl::BufHashTbl(int htSize)
-      : HTSIZE(htSize)
+  BufHashTbl::BufHashTbl(int maxEntries)
   {
-    // allocate an array of pointers to hashBuckets
-    ht = new hashBucket *[htSize];
-    for (int i = 0; i < HTSIZE; i++)
-      ht[i] = NULL;
+    // Size every partition for twice its expected share of the entries, plus
+    // slack for small tables where the shares are uneven.
+    std::uint32_t wanted = 2 * ((maxEntries + NUM_PARTITIONS - 1) / NUM_PARTITIONS) + 16;
+    partitionSize = 1;
+    while (partitionSize < wanted)
+      partitionSize <<= 1;
+
+    // allocate all partitions in one array of empty slots
+    const std::size_t slots = (std::size_t)partitionSize * NUM_PARTITIONS;
+    ht = new hashBucket[slots];
+    for (std::size_t i = 0; i < slots; i++)
+      ht[i].file = NULL;
+    for (int i = 0; i < NUM_PARTITIONS * EPOCHS_PER_PARTITION; i++)
+      epochs[i] = 0;
   }
 
   BufHashTbl::~BufHashTbl()
   {
-    for (int i = 0; i < HTSIZE; i++)
-    {
-      hashBucket *tmpBuf = ht[i];
-      while (ht[i])
-      {
-        tmpBuf = ht[i];
-        ht[i] = ht[i]->next;
-        delete tmpBuf;
-      }
-    }
     delete[] ht;
   }
 
-  void BufHashTbl::insert(const File *file, const PageId pageNo, const FrameId frameNo)
+  std::mutex &BufHashTbl::partitionLatch(const File *file, const PageId pageNo)
   {
-    int index = hash(file, pageNo);
+    return latches[partitionOf(hash(file, pageNo))];
+  }
 
-    hashBucket *tmpBuc = ht[index];
-    while (tmpBuc)
+  hashBucket *BufHashTbl::find(const File *file, const PageId pageNo)
+  {
+    const std::uint64_t hashValue = hash(file, pageNo);
+    hashBucket *partition = ht + (std::size_t)partitionOf(hashValue) * partitionSize;
+    const std::uint32_t mask = partitionSize - 1;
+    for (std::uint32_t slot = homeSlot(hashValue), probes = 0;
+         probes < partitionSize; slot = (slot + 1) & mask, probes++)
     {
+      hashBucket *tmpBuc = &partition[slot];
+      if (tmpBuc->file == NULL)
+        return NULL;
       if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-        throw HashAlreadyPresentException(tmpBuc->file->filename(), tmpBuc->pageNo, tmpBuc->frameNo);
-      tmpBuc = tmpBuc->next;
+        return tmpBuc;
     }
-
-    tmpBuc = new hashBucket;
-    if (!tmpBuc)
-      throw HashTableException();
-
-    tmpBuc->file = (File *)file;
-    tmpBuc->pageNo = pageNo;
-    tmpBuc->frameNo = frameNo;
-    tmpBuc->next = ht[index];
-    ht[index] = tmpBuc;
+    return NULL;
   }
 
-  void BufHashTbl::lookup(const File *file, const PageId pageNo, FrameId &frameNo)
+  void BufHashTbl::insert(const File *file, const PageId pageNo, const FrameId frameNo)
   {
-    int index = hash(file, pageNo);
-    hashBucket *tmpBuc = ht[index];
-    while (tmpBuc)
+    const std::uint64_t hashValue = hash(file, pageNo);
+    hashBucket *partition = ht + (std::size_t)partitionOf(hashValue) * partitionSize;
+    const std::uint32_t mask = partitionSize - 1;
+    for (std::uint32_t slot = homeSlot(hashValue), probes = 0;
+         probes < partitionSize; slot = (slot + 1) & mask, probes++)
     {
+      hashBucket *tmpBuc = &partition[slot];
       if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
+        throw HashAlreadyPresentException(tmpBuc->file->filename(), tmpBuc->pageNo, tmpBuc->frameNo);
+      if (tmpBuc->file == NULL)
       {
-        frameNo = tmpBuc->frameNo; // return frameNo by reference
+        tmpBuc->file = (File *)file;
+        tmpBuc->pageNo = pageNo;
+        tmpBuc->frameNo = frameNo;
         return;
       }
-      tmpBuc = tmpBuc->next;
     }
 
-    throw HashNotFoundException(file->filename(), pageNo);
+    // every slot of the partition is in use
+    throw HashTableException();
   }
 
-  void BufHashTbl::remove(const File *file, const PageId pageNo)
+  bool BufHashTbl::tryLookup(const File *file, const PageId pageNo, FrameId &frameNo)
   {
+    hashBucket *tmpBuc = find(file, pageNo);
+    if (!tmpBuc)
+      return false;
 
-    int index = hash(file, pageNo);
-    hashBucket *tmpBuc = ht[index];
-    hashBucket *prevBuc = NULL;
+    frameNo = tmpBuc->frameNo; // return frameNo by reference
+    return true;
+  }
 
-    while (tmpBuc)
-    {
-      if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-      {
-        if (prevBuc)
-          prevBuc->next = tmpBuc->next;
-        else
-          ht[index] = tmpBuc->next;
+  void BufHashTbl::lookup(const File *file, const PageId pageNo, FrameId &frameNo)
+  {
+    if (!tryLookup(file, pageNo, frameNo))
+      throw HashNotFoundException(file->filename(), pageNo);
+  }
 
-        delete tmpBuc;
-        return;
-      }
-      else
+  void BufHashTbl::remove(const File *file, const PageId pageNo)
+  {
+    hashBucket *tmpBuc = find(file, pageNo);
+    if (!tmpBuc)
+      throw HashNotFoundException(file->filename(), pageNo);
+
+    // Backward-shift deletion: pull later entries of the probe run into the hole
+    // whenever the hole lies between their home slot and their current slot, so
+    // lookups never need tombstones.
+    const std::uint64_t hashValue = hash(file, pageNo);
+    hashBucket *partition = ht + (std::size_t)partitionOf(hashValue) * partitionSize;
+    const std::uint32_t mask = partitionSize - 1;
+    std::uint32_t hole = tmpBuc - partition;
+    // A full partition has no empty slot to end the run, so stop after one lap
+    for (std::uint32_t slot = (hole + 1) & mask, probes = 1;
+         probes < partitionSize && partition[slot].file != NULL;
+         slot = (slot + 1) & mask, probes++)
+    {
+      const std::uint32_t home = homeSlot(hash(partition[slot].file, partition[slot].pageNo));
+      // distance from home to the hole is at most the distance from home to slot
+      if (((hole - home) & mask) <= ((slot - home) & mask))
       {
-        prevBuc = tmpBuc;
-        tmpBuc = tmpBuc->next;
+        partition[hole] = partition[slot];
+        hole = slot;
       }
     }
-
-    throw HashNotFoundException(file->filename(), pageNo);
+    partition[hole].file = NULL;
+    epochOf(hashValue)++;
   }
 
 }
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <mutex>
+
 #include "file.h"
 
 namespace badgerdb
@@ -14,6 +17,9 @@ namespace badgerdb
 
 	/**
 	 * @brief Declarations for buffer pool hash table
+	 *
+	 * Entries are stored inline in the table, 16 bytes each. A slot whose file is
+	 * NULL is empty.
 	 */
 	struct hashBucket
 	{
@@ -31,50 +37,120 @@ namespace badgerdb
 		 * frame number of page in the buffer pool
 		 */
 		FrameId frameNo;
-
-		/**
-		 * Next node in the hash table
-		 */
-		hashBucket *next;
 	};
 
+	static_assert(sizeof(hashBucket) == 16 || sizeof(File *) != 8,
+				  "Hash table entries should pack into 16 bytes.");
+
 	/**
 	 * @brief Hash table class to keep track of pages in the buffer pool
 	 *
-	 * @warning This class is not threadsafe.
+	 * The table is split into NUM_PARTITIONS partitions. Each partition is a flat
+	 * open-addressing table with linear probing and backward-shift deletion, so the
+	 * table never allocates after construction and a lookup touches consecutive
+	 * slots only. The high bits of the hash select the partition and the low bits
+	 * the home slot within it.
+	 *
+	 * Each partition is guarded by its own latch. The table itself does not take
+	 * the latches: callers lock the latch returned by partitionLatch() around
+	 * insert(), lookup() and remove() so that a lookup and the pin that follows it
+	 * happen atomically.
 	 */
 	class BufHashTbl
 	{
+	public:
+		/**
+		 * Number of latch partitions the table is split into
+		 */
+		static const int NUM_PARTITIONS = 64;
+
 	private:
 		/**
-		 *	Size of Hash Table
+		 *	Number of slots in each partition (a power of two)
 		 */
-		int HTSIZE;
+		std::uint32_t partitionSize;
+
 		/**
-		 * Actual Hash table object
+		 * Actual Hash table object, NUM_PARTITIONS * partitionSize slots
 		 */
-		hashBucket **ht;
+		hashBucket *ht;
 
 		/**
-		 * returns hash value between 0 and HTSIZE-1 computed using file and pageNo
+		 * One latch per partition
+		 */
+		std::mutex latches[NUM_PARTITIONS];
+
+		/**
+		 * Number of eviction epochs per partition
+		 */
+		static const int EPOCHS_PER_PARTITION = 64;
+
+		/**
+		 * Eviction epochs: the number of entries removed so far, per group of pages of
+		 * a partition, guarded by the partition latch
+		 */
+		std::uint32_t epochs[NUM_PARTITIONS * EPOCHS_PER_PARTITION];
+
+		/**
+		 * Returns the eviction epoch counting removals of pages with this hash value.
+		 */
+		std::uint32_t &epochOf(const std::uint64_t hashValue)
+		{
+			return epochs[partitionOf(hashValue) * EPOCHS_PER_PARTITION + ((hashValue >> 32) & (EPOCHS_PER_PARTITION - 1))];
+		}
+
+		/**
+		 * returns a 64 bit hash computed using file and pageNo
 		 *
 		 * @param file   	File object
 		 * @param pageNo  Page number in the file
 		 * @return  			Hash value.
 		 */
-		int hash(const File *file, const PageId pageNo);
+		static std::uint64_t hash(const File *file, const PageId pageNo);
+
+		/**
+		 * Returns the partition a hash value belongs to.
+		 */
+		static int partitionOf(const std::uint64_t hashValue)
+		{
+			return hashValue >> 58;
+		}
+
+		/**
+		 * Returns the slot within a partition where the probe for a hash value starts.
+		 */
+		std::uint32_t homeSlot(const std::uint64_t hashValue) const
+		{
+			return hashValue & (partitionSize - 1);
+		}
+
+		/**
+		 * Returns the slot holding (file, pageNo), or NULL if there is none.
+		 */
+		hashBucket *find(const File *file, const PageId pageNo);
 
 	public:
 		/**
 		 * Constructor of BufHashTbl class
+		 *
+		 * @param maxEntries	Largest number of entries the table has to hold, i.e. the number of frames
 		 */
-		BufHashTbl(const int htSize); // constructor
+		BufHashTbl(const int maxEntries); // constructor
 
 		/**
 		 * Destructor of BufHashTbl class
 		 */
 		~BufHashTbl(); // destructor
 
+		/**
+		 * Returns the latch protecting the partition that (file, pageNo) hashes to.
+		 *
+		 * @param file   	File object
+		 * @param pageNo  Page number in the file
+		 * @return  			Latch of the partition holding the entry.
+		 */
+		std::mutex &partitionLatch(const File *file, const PageId pageNo);
+
 		/**
 		 * Insert entry into hash table mapping (file, pageNo) to frameNo.
 		 *
@@ -82,10 +158,22 @@ namespace badgerdb
 		 * @param pageNo 	Page number in the file
 		 * @param frameNo Frame number assigned to that page of the file
 		 * @throws  HashAlreadyPresentException	if the corresponding page already exists in the hash table
-		 * @throws  HashTableException (optional) if could not create a new bucket as running of memory
+		 * @throws  HashTableException if the partition the entry hashes to is full
 		 */
 		void insert(const File *file, const PageId pageNo, const FrameId frameNo);
 
+		/**
+		 * Check if (file, pageNo) is currently in the buffer pool (ie. in
+		 * the hash table). A miss is reported through the return value, so this is
+		 * the variant to use on hot paths.
+		 *
+		 * @param file  	File object
+		 * @param pageNo	Page number in the file
+		 * @param frameNo Frame number reference, only set if the entry is found
+		 * @return  			True if the page entry is present in the hash table
+		 */
+		bool tryLookup(const File *file, const PageId pageNo, FrameId &frameNo);
+
 		/**
 		 * Check if (file, pageNo) is currently in the buffer pool (ie. in
 		 * the hash table).
@@ -98,7 +186,23 @@ namespace badgerdb
 		void lookup(const File *file, const PageId pageNo, FrameId &frameNo);
 
 		/**
-		 * Delete entry (file,pageNo) from hash table.
+		 * Returns the eviction epoch of (file, pageNo): a count that changes whenever the
+		 * page, or another page sharing its count, is removed from the table. A reader that
+		 * missed the page and read it from disk publishes its copy only if the epoch did not
+		 * change meanwhile, since the page may have been written back in between. Call it
+		 * with the partition latch of the page held.
+		 *
+		 * @param file   	File object
+		 * @param pageNo  Page number in the file
+		 * @return  			Eviction epoch of the page.
+		 */
+		std::uint32_t epoch(const File *file, const PageId pageNo)
+		{
+			return epochOf(hash(file, pageNo));
+		}
+
+		/**
+		 * Delete entry (file,pageNo) from hash table, advancing its eviction epoch.
 		 *
 		 * @param file   	File object
 		 * @param pageNo  Page number in the file
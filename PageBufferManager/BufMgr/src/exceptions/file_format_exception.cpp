@@ -0,0 +1,24 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "file_format_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb
+{
+
+  FileFormatException::FileFormatException(const std::string &name)
+      : BadgerDbException(""), filename_(name)
+  {
+    std::stringstream ss;
+    ss << "File is not in a supported format: " << filename_;
+    message_.assign(ss.str());
+  }
+
+}
@@ -0,0 +1,43 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb
+{
+
+  /**
+   * @brief An exception that is thrown when a file being opened is not in the
+   *        on-disk format of File (or in a version of it that is not supported).
+   */
+  class FileFormatException : public BadgerDbException
+  {
+  public:
+    /**
+     * Constructs a file format exception for the given file.
+     *
+     * @param name  Name of file in the wrong format.
+     */
+    explicit FileFormatException(const std::string &name);
+
+    /**
+     * Returns the name of the file that caused this exception.
+     */
+    virtual const std::string &filename() const { return filename_; }
+
+  protected:
+    /**
+     * Name of file that caused this exception.
+     */
+    const std::string &filename_;
+  };
+
+}
@@ -0,0 +1,55 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb
+{
+
+  /**
+   * @brief An exception that is thrown when reading or writing a file fails or
+   *        moves fewer bytes than asked for.
+   */
+  class FileIOException : public BadgerDbException
+  {
+  public:
+    /**
+     * Constructs a file I/O exception for the given file.
+     *
+     * @param name    Name of file that could not be read or written.
+     * @param error   errno value of the failed system call; EIO for a short
+     *                transfer.
+     */
+    explicit FileIOException(const std::string &name, const int error);
+
+    /**
+     * Returns the name of the file that caused this exception.
+     */
+    virtual const std::string &filename() const { return filename_; }
+
+    /**
+     * Returns the errno value of the failed system call.
+     */
+    virtual int error() const { return error_; }
+
+  protected:
+    /**
+     * Name of file that caused this exception.
+     */
+    const std::string filename_;
+
+    /**
+     * errno value of the failed system call.
+     */
+    const int error_;
+  };
+
+}
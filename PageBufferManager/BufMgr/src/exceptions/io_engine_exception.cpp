@@ -0,0 +1,25 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "io_engine_exception.h"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace badgerdb
+{
+
+  IoEngineException::IoEngineException(const std::string &engine, const int error)
+      : BadgerDbException(""), error_(error)
+  {
+    std::stringstream ss;
+    ss << "I/O engine " << engine << " failed: " << std::strerror(error);
+    message_.assign(ss.str());
+  }
+
+}
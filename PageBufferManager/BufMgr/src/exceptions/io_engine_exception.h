@@ -0,0 +1,44 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb
+{
+
+  /**
+   * @brief An exception that is thrown when an asynchronous I/O engine cannot be
+   *        set up or refuses a request.
+   */
+  class IoEngineException : public BadgerDbException
+  {
+  public:
+    /**
+     * Constructs an I/O engine exception.
+     *
+     * @param engine  Name of the engine.
+     * @param error   errno value of the failed system call.
+     */
+    explicit IoEngineException(const std::string &engine, const int error);
+
+    /**
+     * Returns the errno value of the failed system call.
+     */
+    virtual int error() const { return error_; }
+
+  protected:
+    /**
+     * errno value of the failed system call.
+     */
+    const int error_;
+  };
+
+}
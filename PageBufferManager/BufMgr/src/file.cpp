@@ -7,14 +7,23 @@
 
 #include "file.h"
 
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <cstdio>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <numeric>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include "exceptions/file_exists_exception.h"
+#include "exceptions/file_format_exception.h"
+#include "exceptions/file_io_exception.h"
 #include "exceptions/file_not_found_exception.h"
 #include "exceptions/file_open_exception.h"
 #include "exceptions/invalid_page_exception.h"
@@ -24,8 +33,15 @@
 namespace badgerdb
 {
 
-  File::StreamMap File::open_streams_;
   File::CountMap File::open_counts_;
+  File::DescriptorMap File::open_fds_;
+  File::StateMap File::open_states_;
+
+  /**
+   * Maximum number of pages moved by one vectored call; a page written takes
+   * two iovecs (the merged header and the data).
+   */
+  static const std::size_t MAX_PAGES_PER_CALL = IOV_MAX / 2;
 
   File File::create(const std::string &filename)
   {
@@ -61,19 +77,171 @@ namespace badgerdb
 
   bool File::exists(const std::string &filename)
   {
-    std::fstream file(filename);
-    if (file)
+    return ::access(filename.c_str(), F_OK) == 0;
+  }
+
+  bool File::convert(const std::string &filename)
+  {
+    if (!exists(filename))
+    {
+      throw FileNotFoundException(filename);
+    }
+    if (isOpen(filename))
+    {
+      throw FileOpenException(filename);
+    }
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      throw FileNotFoundException(filename);
+    }
+    FileHeader header = {0, 0, 0, 0, 0, 0};
+    struct iovec iov[1];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    const ssize_t result = IoEngine::transfer(fd, iov, 1, 0 /* pos */, false);
+    if (result < 0)
+    {
+      ::close(fd);
+      throw FileIOException(filename, (int)-result);
+    }
+    if (header.magic == FileHeader::MAGIC && header.version == FileHeader::VERSION)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    // Version 1: the header without magic and version at the start of the file,
+    // then every page right after it, so the size of the file follows from the
+    // number of pages.  Its used pages are linked in page number order like in
+    // version 2; the free list is replaced by the maps.
+    const std::size_t former_header_size = 4 * sizeof(PageId);
+    const PageId num_pages = header.magic;
+    const PageId first_used_page = header.version;
+    const PageId num_free_pages = header.num_pages;
+    const off_t file_size = ::lseek(fd, 0, SEEK_END);
+    if (num_pages == 0 || first_used_page >= num_pages || num_free_pages >= num_pages ||
+        file_size != (off_t)former_header_size + (off_t)(num_pages - 1) * (off_t)Page::SIZE)
+    {
+      ::close(fd);
+      throw FileFormatException(filename);
+    }
+
+    const std::string converted_name = filename + ".converting";
+    const int out = ::open(converted_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out < 0)
+    {
+      ::close(fd);
+      throw FileNotFoundException(converted_name);
+    }
+    try
+    {
+      const FileHeader converted = {FileHeader::MAGIC, FileHeader::VERSION,
+                                    num_pages, Page::INVALID_NUMBER, 0,
+                                    Page::INVALID_NUMBER};
+      header = converted;
+      const std::size_t groups = (num_pages - 1 + PAGES_PER_MAP - 1) / PAGES_PER_MAP;
+      std::vector<std::uint64_t> used(groups * WORDS_PER_MAP, 0);
+      Page page;
+      PageId previous_page_number = Page::INVALID_NUMBER;
+      for (PageId page_number = 1; page_number < num_pages; ++page_number)
+      {
+        // Every page lies within the file, whose size was checked above.
+        iov[0].iov_base = page.memory_;
+        iov[0].iov_len = Page::SIZE;
+        transferAll(fd, iov, 1,
+                    former_header_size + (off_t)(page_number - 1) * Page::SIZE,
+                    false, filename);
+        if (page.page_number() != page_number)
+        {
+          // Free
+          page.initialize();
+          if (header.num_free_pages++ == 0)
+          {
+            header.first_free_page = page_number;
+          }
+        }
+        else
+        {
+          used[(page_number - 1) / 64] |= 1ull << ((page_number - 1) % 64);
+          page.set_next_page_number(Page::INVALID_NUMBER);
+          if (previous_page_number == Page::INVALID_NUMBER)
+          {
+            header.first_used_page = page_number;
+          }
+          else
+          {
+            PageId next = page_number;
+            struct iovec next_iov[1];
+            next_iov[0].iov_base = &next;
+            next_iov[0].iov_len = sizeof(next);
+            transferAll(out, next_iov, 1,
+                        pagePosition(previous_page_number) +
+                            offsetof(PageHeader, next_page_number),
+                        true, converted_name);
+          }
+          previous_page_number = page_number;
+        }
+        iov[0].iov_base = page.memory_;
+        iov[0].iov_len = Page::SIZE;
+        transferAll(out, iov, 1, pagePosition(page_number), true, converted_name);
+      }
+
+      for (std::size_t group = 0; group < groups; ++group)
+      {
+        iov[0].iov_base = &used[group * WORDS_PER_MAP];
+        iov[0].iov_len = Page::SIZE;
+        transferAll(out, iov, 1, mapPosition(group * PAGES_PER_MAP + 1), true,
+                    converted_name);
+      }
+      iov[0].iov_base = &header;
+      iov[0].iov_len = sizeof(header);
+      transferAll(out, iov, 1, 0 /* pos */, true, converted_name);
+      if (fsync(out) != 0)
+      {
+        throw FileIOException(converted_name, errno);
+      }
+    }
+    catch (...)
+    {
+      // Keep the original; the new file is incomplete.
+      ::close(fd);
+      ::close(out);
+      ::unlink(converted_name.c_str());
+      throw;
+    }
+    ::close(fd);
+    if (::close(out) != 0 || std::rename(converted_name.c_str(), filename.c_str()) != 0)
     {
-      file.close();
-      return true;
+      const int error = errno;
+      ::unlink(converted_name.c_str());
+      throw FileIOException(filename, error);
     }
 
-    return false;
+    // Make the rename itself durable.
+    const std::string::size_type slash = filename.rfind('/');
+    const std::string directory = slash == std::string::npos ? "."
+                                  : slash == 0               ? "/"
+                                                             : filename.substr(0, slash);
+    const int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir < 0)
+    {
+      throw FileIOException(directory, errno);
+    }
+    const int synced = fsync(dir);
+    const int error = errno;
+    ::close(dir);
+    if (synced != 0)
+    {
+      throw FileIOException(directory, error);
+    }
+    return true;
   }
 
   File::File(const File &other)
       : filename_(other.filename_),
-        stream_(open_streams_[filename_])
+        fd_(open_fds_[filename_]),
+        state_(&open_states_[filename_])
   {
     ++open_counts_[filename_];
   }
@@ -95,163 +263,317 @@ namespace badgerdb
 
   Page File::allocatePage()
   {
-    FileHeader header = readHeader();
     Page new_page;
-    Page existing_page;
+    allocatePageInto(new_page);
+    return new_page;
+  }
+
+  void File::allocatePageInto(Page &new_page)
+  {
+    FileHeader header = readHeader();
+    PageId page_number;
     if (header.num_free_pages > 0)
     {
-      new_page = readPage(header.first_free_page, true /* allow_free */);
-      new_page.set_page_number(header.first_free_page);
-      header.first_free_page = new_page.next_page_number();
+      // Reuse the lowest-numbered free page.
+      page_number = header.first_free_page;
       --header.num_free_pages;
+      header.first_free_page = header.num_free_pages > 0
+                                   ? nextFreePageNumber(page_number + 1)
+                                   : Page::INVALID_NUMBER;
+    }
+    else
+    {
+      page_number = header.num_pages;
+      ++header.num_pages;
+    }
+    assert((header.num_free_pages == 0) ==
+           (header.first_free_page == Page::INVALID_NUMBER));
+
+    // Insert the page into the used list between its used neighbours, which the
+    // allocation map gives without reading any page; the predecessor's pointer on
+    // disk is still updated for readers of that page (see writeNextPageNumber()).
+    const PageId previous_page_number = previousPageNumber(page_number);
+    new_page.initialize();
+    new_page.set_page_number(page_number);
+    new_page.set_next_page_number(nextPageNumber(page_number));
+    setUsed(page_number, true);
+    try
+    {
+      writePage(page_number, new_page);
+    }
+    catch (FileIOException &)
+    {
+      // Nothing refers to the page yet; leave it free.
+      setUsed(page_number, false);
+      throw;
+    }
+    writeMap(page_number, page_number);
+    if (previous_page_number == Page::INVALID_NUMBER)
+    {
+      header.first_used_page = page_number;
+    }
+    else
+    {
+      writeNextPageNumber(previous_page_number, page_number);
+    }
+    writeHeader(header);
+  }
 
-      if (header.first_used_page == Page::INVALID_NUMBER ||
-          header.first_used_page > new_page.page_number())
-      {
-        // Either have no pages used or the head of the used list is a page later
-        // than the one we just allocated, so add the new page to the head.
-        if (header.first_used_page > new_page.page_number())
-        {
-          new_page.set_next_page_number(header.first_used_page);
-        }
-        header.first_used_page = new_page.page_number();
-      }
-      else
-      {
-        // New page is reused from somewhere after the beginning, so we need to
-        // find where in the used list to insert it.
-        PageId next_page_number = Page::INVALID_NUMBER;
-        for (FileIterator iter = begin(); iter != end(); ++iter)
-        {
-          next_page_number = (*iter).next_page_number();
-          if (next_page_number > new_page.page_number() ||
-              next_page_number == Page::INVALID_NUMBER)
-          {
-            existing_page = *iter;
-            break;
-          }
-        }
-        existing_page.set_next_page_number(new_page.page_number());
-        new_page.set_next_page_number(next_page_number);
-      }
+  void File::allocatePages(const std::uint32_t count,
+                           std::vector<Page> &new_pages, const bool preallocate)
+  {
+    new_pages.resize(count);
+    std::vector<Page *> pages(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+      pages[i] = &new_pages[i];
+    }
+    allocatePagesInto(pages, preallocate);
+  }
 
-      assert((header.num_free_pages == 0) ==
-             (header.first_free_page == Page::INVALID_NUMBER));
+  void File::allocatePagesInto(const std::vector<Page *> &new_pages,
+                               const bool preallocate)
+  {
+    if (new_pages.empty())
+    {
+      return;
     }
-    else
+    FileHeader header = readHeader();
+    const PageId first_page_number = header.num_pages;
+    const PageId last_page_number = first_page_number + new_pages.size() - 1;
+    if (preallocate)
     {
-      new_page.set_page_number(header.num_pages);
-      if (header.first_used_page == Page::INVALID_NUMBER)
-      {
-        header.first_used_page = new_page.page_number();
-      }
-      else
+      // Reserve the whole extent, map blocks within it included.  Where the file
+      // system cannot, space is allocated as the pages are written below.
+      const off_t start = pagePosition(first_page_number);
+      ::fallocate(fd_, 0, start, pagePosition(last_page_number) + Page::SIZE - start);
+    }
+
+    // The pages follow each other in the used list; the last used page before
+    // the extent is the only other page to link.
+    const PageId previous_page_number = previousPageNumber(first_page_number);
+    std::vector<const Page *> pages(new_pages.begin(), new_pages.end());
+    std::vector<PageHeader> headers(new_pages.size());
+    for (std::size_t i = 0; i < new_pages.size(); ++i)
+    {
+      const PageId page_number = first_page_number + i;
+      Page &new_page = *new_pages[i];
+      new_page.initialize();
+      new_page.set_page_number(page_number);
+      new_page.set_next_page_number(page_number < last_page_number
+                                        ? page_number + 1
+                                        : Page::INVALID_NUMBER);
+      setUsed(page_number, true);
+      headers[i] = *new_page.header_;
+    }
+    try
+    {
+      writeRuns(pages, headers);
+    }
+    catch (FileIOException &)
+    {
+      // The header still ends the file before the extent.
+      for (PageId page_number = first_page_number; page_number <= last_page_number; ++page_number)
       {
-        // If we have pages allocated, we need to add the new page to the tail
-        // of the linked list.
-        for (FileIterator iter = begin(); iter != end(); ++iter)
-        {
-          if ((*iter).next_page_number() == Page::INVALID_NUMBER)
-          {
-            existing_page = *iter;
-            break;
-          }
-        }
-        assert(existing_page.isUsed());
-        existing_page.set_next_page_number(new_page.page_number());
+        setUsed(page_number, false);
       }
-      ++header.num_pages;
+      throw;
     }
-    writePage(new_page.page_number(), new_page);
-    if (existing_page.page_number() != Page::INVALID_NUMBER)
+    writeMap(first_page_number, last_page_number);
+    if (previous_page_number == Page::INVALID_NUMBER)
     {
-      // If we updated an existing page by inserting the new page into the
-      // used list, we need to write it out.
-      writePage(existing_page.page_number(), existing_page);
+      header.first_used_page = first_page_number;
     }
+    else
+    {
+      writeNextPageNumber(previous_page_number, first_page_number);
+    }
+    header.num_pages = last_page_number + 1;
     writeHeader(header);
-
-    return new_page;
   }
 
   Page File::readPage(const PageId page_number) const
   {
-    FileHeader header = readHeader();
-    if (page_number >= header.num_pages)
+    Page page;
+    readPageInto(page_number, page);
+    return page;
+  }
+
+  void File::readPageInto(const PageId page_number, Page &page) const
+  {
+    if (page_number >= state_->num_pages)
     {
       throw InvalidPageException(page_number, filename_);
     }
-    return readPage(page_number, false /* allow_free */);
+    readPageInto(page_number, page, false /* allow_free */);
   }
 
-  Page File::readPage(const PageId page_number, const bool allow_free) const
+  void File::readPageInto(const PageId page_number, Page &page,
+                          const bool allow_free) const
   {
-    Page page;
-    stream_->seekg(pagePosition(page_number), std::ios::beg);
-    stream_->read(reinterpret_cast<char *>(&page.header_), sizeof(page.header_));
-    stream_->read(reinterpret_cast<char *>(&page.data_[0]), Page::DATA_SIZE);
+    struct iovec iov[1];
+    iov[0].iov_base = page.memory_;
+    iov[0].iov_len = Page::SIZE;
+    const ssize_t result = IoEngine::transfer(fd_, iov, 1, pagePosition(page_number), false);
+    if (result == 0)
+    {
+      // Past the end of the file
+      page.initialize();
+    }
+    else if (result != (ssize_t)Page::SIZE)
+    {
+      // A failed read, or a page cut short, is not a free page
+      throw FileIOException(filename_, result < 0 ? (int)-result : EIO);
+    }
     if (!allow_free && !page.isUsed())
     {
       throw InvalidPageException(page_number, filename_);
     }
-
-    return page;
   }
 
   void File::writePage(const Page &new_page)
   {
-    PageHeader header = readPageHeader(new_page.page_number());
-    if (header.current_page_number == Page::INVALID_NUMBER)
+    const PageId page_number = new_page.page_number();
+    if (!isUsed(page_number))
     {
       // Page has been deleted since it was read.
-      throw InvalidPageException(new_page.page_number(), filename_);
+      throw InvalidPageException(page_number, filename_);
+    }
+    // Page may have had its next page pointer updated since it was read; we
+    // don't modify that, but we do keep all the other modifications to the page
+    // header.
+    PageHeader header = *new_page.header_;
+    header.next_page_number = nextPageNumber(page_number);
+    writePage(page_number, header, new_page);
+  }
+
+  void File::readPages(const std::vector<PageId> &page_numbers,
+                       std::vector<Page> &pages) const
+  {
+    const PageId num_pages = state_->num_pages;
+    for (std::size_t i = 0; i < page_numbers.size(); ++i)
+    {
+      if (page_numbers[i] >= num_pages)
+      {
+        throw InvalidPageException(page_numbers[i], filename_);
+      }
+    }
+    pages.resize(page_numbers.size());
+
+    // Visit the pages in page number order so that runs of consecutive pages
+    // can be read with one call.
+    std::vector<std::size_t> order(page_numbers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&page_numbers](std::size_t a, std::size_t b)
+              { return page_numbers[a] < page_numbers[b]; });
+    std::vector<struct iovec> iov;
+    for (std::size_t start = 0, end; start < order.size(); start = end)
+    {
+      end = start + 1;
+      while (end < order.size() && end - start < MAX_PAGES_PER_CALL &&
+             pagePosition(page_numbers[order[end]]) ==
+                 pagePosition(page_numbers[order[end - 1]]) + (off_t)Page::SIZE)
+      {
+        ++end;
+      }
+      iov.clear();
+      for (std::size_t k = start; k < end; ++k)
+      {
+        struct iovec page_iov = {pages[order[k]].memory_, Page::SIZE};
+        iov.push_back(page_iov);
+      }
+      transferAll(fd_, &iov[0], iov.size(), pagePosition(page_numbers[order[start]]), false,
+                  filename_);
+    }
+
+    for (std::size_t i = 0; i < pages.size(); ++i)
+    {
+      if (!pages[i].isUsed() || pages[i].page_number() != page_numbers[i])
+      {
+        throw InvalidPageException(page_numbers[i], filename_);
+      }
     }
-    // Page on disk may have had its next page pointer updated since it was read;
-    // we don't modify that, but we do keep all the other modifications to the
-    // page header.
-    const PageId next_page_number = header.next_page_number;
-    header = new_page.header_;
-    header.next_page_number = next_page_number;
-    writePage(new_page.page_number(), header, new_page);
+  }
+
+  void File::readPageAsync(IoEngine &engine, const PageId page_number,
+                           Page &page, std::function<void(bool)> done) const
+  {
+    if (page_number >= state_->num_pages)
+    {
+      throw InvalidPageException(page_number, filename_);
+    }
+    struct iovec iov[1];
+    iov[0].iov_base = page.memory_;
+    iov[0].iov_len = Page::SIZE;
+    engine.submit(fd_, iov, 1, pagePosition(page_number), false /* write */,
+                  [&page, done](ssize_t result)
+                  { done(result == (ssize_t)Page::SIZE && page.isUsed()); });
+  }
+
+  void File::writePages(const std::vector<const Page *> &pages)
+  {
+    std::vector<const Page *> sorted(pages);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Page *a, const Page *b)
+              { return a->page_number() < b->page_number(); });
+
+    // As in writePage(), keep the next page pointer in memory and refuse to
+    // write pages deleted since they were read.
+    std::vector<PageHeader> headers(sorted.size());
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+    {
+      const PageId page_number = sorted[i]->page_number();
+      if (!isUsed(page_number))
+      {
+        throw InvalidPageException(page_number, filename_);
+      }
+      headers[i] = *sorted[i]->header_;
+      headers[i].next_page_number = nextPageNumber(page_number);
+    }
+    writeRuns(sorted, headers);
   }
 
   void File::deletePage(const PageId page_number)
   {
     FileHeader header = readHeader();
-    Page existing_page = readPage(page_number);
-    Page previous_page;
-    // If this page is the head of the used list, update the header to point to
-    // the next page in line.
-    if (page_number == header.first_used_page)
+    if (!isUsed(page_number))
+    {
+      throw InvalidPageException(page_number, filename_);
+    }
+    // Unlink the page from the used list; only its predecessor changes.
+    const PageId previous_page_number = previousPageNumber(page_number);
+    const PageId next_page_number = nextPageNumber(page_number);
+    setUsed(page_number, false);
+    if (previous_page_number == Page::INVALID_NUMBER)
     {
-      header.first_used_page = existing_page.next_page_number();
+      header.first_used_page = next_page_number;
     }
     else
     {
-      // Walk the used list so we can update the page that points to this one.
-      for (FileIterator iter = begin(); iter != end(); ++iter)
-      {
-        previous_page = *iter;
-        if (previous_page.next_page_number() == existing_page.page_number())
-        {
-          previous_page.set_next_page_number(existing_page.next_page_number());
-          break;
-        }
-      }
+      writeNextPageNumber(previous_page_number, next_page_number);
     }
-    // Clear the page and add it to the head of the free list.
-    existing_page.initialize();
-    existing_page.set_next_page_number(header.first_free_page);
-    header.first_free_page = page_number;
-    ++header.num_free_pages;
-    if (previous_page.isUsed())
+    // Clear the page on disk, so that reads of it fail, and free it in the map.
+    const Page free_page;
+    writePage(page_number, free_page);
+    writeMap(page_number, page_number);
+    if (header.num_free_pages == 0 || page_number < header.first_free_page)
     {
-      writePage(previous_page.page_number(), previous_page);
+      header.first_free_page = page_number;
     }
-    writePage(page_number, existing_page);
+    ++header.num_free_pages;
     writeHeader(header);
   }
 
+  void File::sync()
+  {
+    flushHeader();
+    if (fsync(fd_) != 0)
+    {
+      throw FileIOException(filename_, errno);
+    }
+  }
+
   FileIterator File::begin()
   {
     const FileHeader &header = readHeader();
@@ -270,9 +592,19 @@ namespace badgerdb
     if (create_new)
     {
       // File starts with 1 page (the header).
-      FileHeader header = {1 /* num_pages */, 0 /* first_used_page */,
+      FileHeader header = {FileHeader::MAGIC, FileHeader::VERSION,
+                           1 /* num_pages */, 0 /* first_used_page */,
                            0 /* num_free_pages */, 0 /* first_free_page */};
       writeHeader(header);
+      try
+      {
+        flushHeader();
+      }
+      catch (FileIOException &)
+      {
+        close();
+        throw;
+      }
     }
   }
 
@@ -281,12 +613,12 @@ namespace badgerdb
     if (open_counts_.find(filename_) != open_counts_.end())
     { // exists an entry already
       ++open_counts_[filename_];
-      stream_ = open_streams_[filename_];
+      fd_ = open_fds_[filename_];
+      state_ = &open_states_[filename_];
     }
     else
     {
-      std::ios_base::openmode mode =
-          std::fstream::in | std::fstream::out | std::fstream::binary;
+      int flags = O_RDWR;
       const bool already_exists = exists(filename_);
       if (create_new)
       {
@@ -296,7 +628,7 @@ namespace badgerdb
           throw FileExistsException(filename_);
         }
         // New files have to be truncated on open.
-        mode = mode | std::fstream::trunc;
+        flags |= O_CREAT | O_TRUNC;
       }
       else
       {
@@ -306,61 +638,297 @@ namespace badgerdb
           throw FileNotFoundException(filename_);
         }
       }
-      stream_.reset(new std::fstream(filename_, mode));
-      open_streams_[filename_] = stream_;
+      const int fd = ::open(filename_.c_str(), flags, 0644);
+      if (fd < 0)
+      {
+        throw FileNotFoundException(filename_);
+      }
+      open_fds_[filename_] = fd;
       open_counts_[filename_] = 1;
+      fd_ = fd;
+      state_ = &open_states_[filename_];
+      // A new file has no pages yet; the constructor writes its header.
+      if (!create_new)
+      {
+        try
+        {
+          readState();
+        }
+        catch (BadgerDbException &)
+        {
+          ::close(fd);
+          open_counts_.erase(filename_);
+          open_fds_.erase(filename_);
+          open_states_.erase(filename_);
+          throw;
+        }
+      }
     }
   }
 
   void File::close()
   {
     --open_counts_[filename_];
-    stream_.reset();
     if (open_counts_[filename_] == 0)
     {
-      open_streams_.erase(filename_);
+      try
+      {
+        flushHeader();
+      }
+      catch (FileIOException &)
+      {
+        // Called from the destructor, which cannot report it; sync() does.
+      }
+      ::close(open_fds_[filename_]);
       open_counts_.erase(filename_);
+      open_fds_.erase(filename_);
+      open_states_.erase(filename_);
     }
+    fd_ = -1;
+    state_ = NULL;
   }
 
   void File::writePage(const PageId page_number, const Page &new_page)
   {
-    writePage(page_number, new_page.header_, new_page);
+    writePage(page_number, *new_page.header_, new_page);
   }
 
   void File::writePage(const PageId page_number, const PageHeader &header,
                        const Page &new_page)
   {
-    stream_->seekp(pagePosition(page_number), std::ios::beg);
-    stream_->write(reinterpret_cast<const char *>(&header), sizeof(header));
-    stream_->write(reinterpret_cast<const char *>(&new_page.data_[0]),
-                   Page::DATA_SIZE);
-    stream_->flush();
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<PageHeader *>(&header);
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = new_page.data_;
+    iov[1].iov_len = Page::DATA_SIZE;
+    transferAll(fd_, iov, 2, pagePosition(page_number), true, filename_);
   }
 
-  FileHeader File::readHeader() const
+  void File::writeHeader(const FileHeader &header)
   {
-    FileHeader header;
-    stream_->seekg(0 /* pos */, std::ios::beg);
-    stream_->read(reinterpret_cast<char *>(&header), sizeof(header));
+    state_->header = header;
+    state_->header_dirty = true;
+    state_->num_pages = header.num_pages;
+  }
 
-    return header;
+  void File::flushHeader()
+  {
+    if (!state_->header_dirty)
+    {
+      return;
+    }
+    struct iovec iov[1];
+    iov[0].iov_base = &state_->header;
+    iov[0].iov_len = sizeof(state_->header);
+    transferAll(fd_, iov, 1, 0 /* pos */, true, filename_);
+    state_->header_dirty = false;
   }
 
-  void File::writeHeader(const FileHeader &header)
+  void File::readState()
   {
-    stream_->seekp(0 /* pos */, std::ios::beg);
-    stream_->write(reinterpret_cast<const char *>(&header), sizeof(header));
-    stream_->flush();
+    FileHeader header = {0, 0, 0, 0, 0, 0};
+    struct iovec header_iov[1];
+    header_iov[0].iov_base = &header;
+    header_iov[0].iov_len = sizeof(header);
+    const ssize_t result = IoEngine::transfer(fd_, header_iov, 1, 0 /* pos */, false);
+    if (result < 0)
+    {
+      throw FileIOException(filename_, (int)-result);
+    }
+    if (header.magic != FileHeader::MAGIC ||
+        header.version != FileHeader::VERSION || header.num_pages == 0)
+    {
+      throw FileFormatException(filename_);
+    }
+    state_->header = header;
+    state_->header_dirty = false;
+    state_->num_pages = header.num_pages;
+
+    // One map per group holding any of the pages 1 .. num_pages - 1; parts of a
+    // map past the end of the file read as free, but a failed read must not, or
+    // the pages of the group would be handed out again.
+    const std::size_t groups = (header.num_pages - 1 + PAGES_PER_MAP - 1) / PAGES_PER_MAP;
+    state_->used.assign(groups * WORDS_PER_MAP, 0);
+    for (std::size_t group = 0; group < groups; ++group)
+    {
+      struct iovec iov[1];
+      iov[0].iov_base = &state_->used[group * WORDS_PER_MAP];
+      iov[0].iov_len = Page::SIZE;
+      const ssize_t read = IoEngine::transfer(fd_, iov, 1, mapPosition(group * PAGES_PER_MAP + 1), false);
+      if (read < 0)
+      {
+        throw FileIOException(filename_, (int)-read);
+      }
+    }
   }
 
-  PageHeader File::readPageHeader(PageId page_number) const
+  bool File::isUsed(const PageId page_number) const
   {
-    PageHeader header;
-    stream_->seekg(pagePosition(page_number), std::ios::beg);
-    stream_->read(reinterpret_cast<char *>(&header), sizeof(header));
+    const std::size_t index = page_number - 1;
+    return page_number != Page::INVALID_NUMBER &&
+           index / 64 < state_->used.size() &&
+           ((state_->used[index / 64] >> (index % 64)) & 1) != 0;
+  }
 
-    return header;
+  void File::setUsed(const PageId page_number, const bool used)
+  {
+    const std::size_t index = page_number - 1;
+    if (index / 64 >= state_->used.size())
+    {
+      // First page of a new group
+      state_->used.resize(state_->used.size() + WORDS_PER_MAP, 0);
+    }
+    if (used)
+    {
+      state_->used[index / 64] |= 1ull << (index % 64);
+    }
+    else
+    {
+      state_->used[index / 64] &= ~(1ull << (index % 64));
+    }
+  }
+
+  PageId File::nextPageNumber(const PageId page_number) const
+  {
+    // The bit of the page after page_number has index page_number.
+    const std::vector<std::uint64_t> &used = state_->used;
+    std::size_t word = page_number / 64;
+    if (word >= used.size())
+    {
+      return Page::INVALID_NUMBER;
+    }
+    std::uint64_t bits = used[word] & (~0ull << (page_number % 64));
+    while (bits == 0)
+    {
+      if (++word == used.size())
+      {
+        return Page::INVALID_NUMBER;
+      }
+      bits = used[word];
+    }
+    return word * 64 + __builtin_ctzll(bits) + 1;
+  }
+
+  PageId File::previousPageNumber(const PageId page_number) const
+  {
+    const std::vector<std::uint64_t> &used = state_->used;
+    if (page_number <= 1 || used.empty())
+    {
+      return Page::INVALID_NUMBER;
+    }
+    // The bit of the page before page_number has index page_number - 2.
+    const std::size_t index = page_number - 2;
+    std::size_t word = index / 64;
+    std::uint64_t bits;
+    if (word >= used.size())
+    {
+      word = used.size() - 1;
+      bits = used[word];
+    }
+    else
+    {
+      bits = used[word] & (~0ull >> (63 - index % 64));
+    }
+    while (bits == 0)
+    {
+      if (word == 0)
+      {
+        return Page::INVALID_NUMBER;
+      }
+      bits = used[--word];
+    }
+    return word * 64 + (63 - __builtin_clzll(bits)) + 1;
+  }
+
+  PageId File::nextFreePageNumber(const PageId page_number) const
+  {
+    // Pages past the maps in memory are free.
+    const std::vector<std::uint64_t> &used = state_->used;
+    const std::size_t index = page_number - 1;
+    std::size_t word = index / 64;
+    std::uint64_t bits = (word < used.size() ? ~used[word] : ~0ull) & (~0ull << (index % 64));
+    while (bits == 0)
+    {
+      ++word;
+      bits = word < used.size() ? ~used[word] : ~0ull;
+    }
+    const PageId free_page_number = word * 64 + __builtin_ctzll(bits) + 1;
+    return free_page_number < state_->header.num_pages ? free_page_number
+                                                       : Page::INVALID_NUMBER;
+  }
+
+  void File::writeMap(const PageId first_page_number,
+                      const PageId last_page_number)
+  {
+    // The words of one group are contiguous both in memory and on disk.
+    const std::size_t last_word = (last_page_number - 1) / 64;
+    for (std::size_t word = (first_page_number - 1) / 64, end; word <= last_word; word = end)
+    {
+      end = std::min(last_word + 1, (word / WORDS_PER_MAP + 1) * WORDS_PER_MAP);
+      struct iovec iov[1];
+      iov[0].iov_base = &state_->used[word];
+      iov[0].iov_len = (end - word) * sizeof(std::uint64_t);
+      transferAll(fd_, iov, 1,
+                  mapPosition(word * 64 + 1) + (word % WORDS_PER_MAP) * sizeof(std::uint64_t),
+                  true, filename_);
+    }
+  }
+
+  void File::writeRuns(const std::vector<const Page *> &sorted,
+                       const std::vector<PageHeader> &headers)
+  {
+    std::vector<struct iovec> iov;
+    for (std::size_t start = 0, end; start < sorted.size(); start = end)
+    {
+      // A run of pages stored one after the other, moved with one call
+      end = start + 1;
+      while (end < sorted.size() && end - start < MAX_PAGES_PER_CALL &&
+             pagePosition(sorted[end]->page_number()) ==
+                 pagePosition(sorted[end - 1]->page_number()) + (off_t)Page::SIZE)
+      {
+        ++end;
+      }
+      iov.clear();
+      for (std::size_t k = start; k < end; ++k)
+      {
+        struct iovec header_iov = {const_cast<PageHeader *>(&headers[k]), sizeof(headers[k])};
+        struct iovec data_iov = {sorted[k]->data_, Page::DATA_SIZE};
+        iov.push_back(header_iov);
+        iov.push_back(data_iov);
+      }
+      transferAll(fd_, &iov[0], iov.size(), pagePosition(sorted[start]->page_number()), true,
+                  filename_);
+    }
+  }
+
+  void File::writeNextPageNumber(const PageId page_number,
+                                 const PageId next_page_number)
+  {
+    PageId next = next_page_number;
+    struct iovec iov[1];
+    iov[0].iov_base = &next;
+    iov[0].iov_len = sizeof(next);
+    transferAll(fd_, iov, 1,
+                pagePosition(page_number) + offsetof(PageHeader, next_page_number),
+                true, filename_);
+  }
+
+  void File::transferAll(const int fd, struct iovec *iov, const int iovcnt,
+                         const off_t offset, const bool write,
+                         const std::string &filename)
+  {
+    ssize_t expected = 0;
+    for (int i = 0; i < iovcnt; ++i)
+    {
+      expected += iov[i].iov_len;
+    }
+    const ssize_t result = IoEngine::transfer(fd, iov, iovcnt, offset, write);
+    if (result != expected)
+    {
+      // A failed first call returns -errno; a short transfer stopped at an
+      // error or the end of the file.
+      throw FileIOException(filename, result < 0 ? (int)-result : EIO);
+    }
   }
 
 }
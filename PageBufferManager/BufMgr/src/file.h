@@ -7,11 +7,16 @@
 
 #pragma once
 
-#include <fstream>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
+#include <sys/types.h>
 
+#include "io_engine.h"
 #include "page.h"
 
 namespace badgerdb
@@ -25,7 +30,17 @@ namespace badgerdb
   struct FileHeader
   {
     /**
-     * Number of pages allocated in the file.
+     * Identifies a file in the format of File; always MAGIC.
+     */
+    std::uint32_t magic;
+
+    /**
+     * Version of the on-disk format of the file.
+     */
+    std::uint32_t version;
+
+    /**
+     * Number of pages allocated in the file, counting the header as page 0.
      */
     PageId num_pages;
 
@@ -40,10 +55,21 @@ namespace badgerdb
     PageId num_free_pages;
 
     /**
-     * Page number of the first free (allocated but unused) page in the file.
+     * Page number of the lowest-numbered free (allocated but unused) page in the
+     * file.
      */
     PageId first_free_page;
 
+    /**
+     * Value of magic in every file ("BDBF").
+     */
+    static const std::uint32_t MAGIC = 0x46424442;
+
+    /**
+     * Version of the format written by File.
+     */
+    static const std::uint32_t VERSION = 2;
+
     /**
      * Returns true if this file header is equal to the other.
      *
@@ -52,7 +78,9 @@ namespace badgerdb
      */
     bool operator==(const FileHeader &rhs) const
     {
-      return num_pages == rhs.num_pages &&
+      return magic == rhs.magic &&
+             version == rhs.version &&
+             num_pages == rhs.num_pages &&
              num_free_pages == rhs.num_free_pages &&
              first_used_page == rhs.first_used_page &&
              first_free_page == rhs.first_free_page;
@@ -63,15 +91,34 @@ namespace badgerdb
    * @brief Class which represents a file in the filesystem containing database
    *        pages.
    *
-   * The File class wraps a stream to an underlying file on disk.  Files contain
-   * fixed-sized pages, and they never deallocate space (though they do reuse
-   * deleted pages if possible).  If multiple File objects refer to the same
-   * underlying file, they will share the stream in memory.
+   * The File class wraps a file descriptor of an underlying file on disk.
+   * Files contain fixed-sized pages, and they never deallocate space (though
+   * they do reuse deleted pages if possible).  If multiple File objects refer to
+   * the same underlying file, they will share the file descriptor.
    * If a file that has already been opened (possibly by another query), then the File class
-   * detects this (by looking in the open_streams_ map) and just returns a file object with
-   * the already created stream for the file without actually opening the UNIX file again.
+   * detects this (by looking in the open_fds_ map) and just returns a file object with
+   * the already opened descriptor for the file without actually opening the UNIX file again.
+   * On disk, the file header takes the first Page::SIZE bytes and is followed by
+   * groups of pages, each starting with an allocation map: a block of Page::SIZE
+   * bytes with one bit per page of the group, set for used pages.  Allocating or
+   * deleting a page therefore writes a fixed number of blocks, however large the
+   * file.  Each used page also keeps the number of the next used page in its
+   * header, so the used pages form a list in page number order.
    *
-   * @warning This class is not threadsafe.
+   * The file header and the allocation maps are read once when the file is
+   * opened and then kept in memory, shared in the same way, so that reading or
+   * writing a page is a single I/O and finding the next used or free page needs
+   * none.  The header is written back by sync() and when the last File object
+   * for the file is closed.
+   *
+   * All page I/O is positional (pread/pwrite), so there is no shared file
+   * position: reads of pages may run concurrently from several threads, with
+   * each other and with writes of other pages.  writePages() calls on disjoint
+   * sets of pages may run concurrently too, since they update nothing else.
+   *
+   * @warning Everything else is not threadsafe: creating, opening, copying and
+   * closing File objects, and allocating, deleting or writing pages, which
+   * update the file header and the page lists.
    */
   class File
   {
@@ -81,18 +128,23 @@ namespace badgerdb
      *
      * @param filename  Name of the file.
      * @throws  FileExistsException     If the requested file already exists.
+     * @throws  FileIOException         If the file header could not be written.
      */
     static File create(const std::string &filename);
 
     /**
      * Opens the file named fileName and returns the corresponding File object.
-     * It first checks if the file is already open. If so, then the new File object created uses the same input-output stream to read to or write fom
+     * It first checks if the file is already open. If so, then the new File object created uses the same file descriptor to read to or write fom
      * that already open file. Reference count (open_counts_ static variable inside the File object) is incremented whenever an already open file is
-     * opened again. Otherwise the UNIX file is actually opened. The fileName and the stream associated with this File object are inserted into the
-     * open_streams_ map.
+     * opened again. Otherwise the UNIX file is actually opened. The fileName and the file descriptor associated with this File object are inserted into the
+     * open_fds_ map.
      *
      * @param filename  Name of the file.
      * @throws  FileNotFoundException   If the requested file doesn't exist.
+     * @throws  FileFormatException     If the file is not in the format of File;
+     *                                  files of version 1 need convert() first.
+     * @throws  FileIOException         If the header or the allocation maps
+     *                                  could not be read.
      */
     static File open(const std::string &filename);
 
@@ -119,6 +171,26 @@ namespace badgerdb
      */
     static bool exists(const std::string &filename);
 
+    /**
+     * Converts a file written in version 1 of the format, which had no
+     * allocation maps and kept the free pages in a list, to the current
+     * version.  The file is rewritten into a new file next to it, which is
+     * synced and then replaces it; the directory is synced after that.  Files
+     * already in the current version are left alone.  If anything fails before
+     * the new file replaces the old one, the new file is removed and the old
+     * one kept.
+     *
+     * @param filename  Name of the file, which must not be open.
+     * @return  True if the file was converted.
+     * @throws  FileNotFoundException   If the file doesn't exist.
+     * @throws  FileOpenException       If the file is currently open.
+     * @throws  FileFormatException     If the file is in neither version.
+     * @throws  FileIOException         If reading the file, writing or syncing
+     *                                  the new file, replacing the file or
+     *                                  syncing the directory failed.
+     */
+    static bool convert(const std::string &filename);
+
     /**
      * Copy constructor.
      *
@@ -145,9 +217,46 @@ namespace badgerdb
      * Allocates a new page in the file.
      *
      * @return The new page.
+     * @throws  FileIOException   If the page could not be written.
      */
     Page allocatePage();
 
+    /**
+     * Allocates a new page in the file into a page supplied by the caller,
+     * such as a buffer frame, instead of returning a new one.  If this throws,
+     * the contents of the page are unspecified.
+     *
+     * @param new_page  Page receiving the new page.
+     */
+    void allocatePageInto(Page &new_page);
+
+    /**
+     * Allocates several new pages at once, as an extent of consecutive page
+     * numbers at the end of the file.  The pages are written with a few
+     * vectored writes and the file header is updated once, so this costs far
+     * less than as many allocatePage() calls.  Free pages in the file are left
+     * for allocatePage().
+     *
+     * @param count         Number of pages to allocate.
+     * @param new_pages     Pages allocated, in page number order.
+     * @param preallocate   Whether to reserve the disk space of the whole
+     *                      extent first (fallocate), so the file system can
+     *                      keep it contiguous.
+     */
+    void allocatePages(const std::uint32_t count, std::vector<Page> &new_pages,
+                       const bool preallocate = false);
+
+    /**
+     * Like allocatePages(), but into pages supplied by the caller, such as
+     * buffer frames.  The pages get consecutive page numbers in the order
+     * given.
+     *
+     * @param new_pages     Pages receiving the new pages.
+     * @param preallocate   Whether to reserve the disk space of the extent first.
+     */
+    void allocatePagesInto(const std::vector<Page *> &new_pages,
+                           const bool preallocate = false);
+
     /**
      * Reads an existing page from the file.
      *
@@ -155,25 +264,96 @@ namespace badgerdb
      * @return  The page.
      * @throws  InvalidPageException  If the page doesn't exist in the file or is
      *                                not currently used.
+     * @throws  FileIOException       If the page could not be read.
      */
     Page readPage(const PageId page_number) const;
 
+    /**
+     * Reads an existing page from the file into a page supplied by the caller,
+     * such as a buffer frame, without allocating or copying a page.  If this
+     * throws, the contents of the page are unspecified.
+     *
+     * @param page_number   Number of page to read.
+     * @param page          Page read into.
+     * @throws  InvalidPageException  If the page doesn't exist in the file or is
+     *                                not currently used.
+     * @throws  FileIOException       If the page could not be read.
+     */
+    void readPageInto(const PageId page_number, Page &page) const;
+
     /**
      * Writes a page into the file, replacing any existing contents.  The page
      * must have been already allocated in this file by a call to allocatePage().
+     * Its next page number is taken from the allocation map in memory rather
+     * than from the page, so the write is a single I/O with no read before it.
      *
      * @see allocatePage()
      * @param new_page  Page to write.
+     * @throws  InvalidPageException  If the page has been deleted from the file.
+     * @throws  FileIOException       If the page could not be written.
      */
     void writePage(const Page &new_page);
 
+    /**
+     * Reads several existing pages from the file.  Pages with consecutive
+     * page numbers are read with a single vectored read.
+     *
+     * @param page_numbers  Numbers of pages to read, in any order.
+     * @param pages         Pages read, returned in the order of page_numbers.
+     * @throws  InvalidPageException  If any page doesn't exist in the file or is
+     *                                not currently used.
+     * @throws  FileIOException       If any page could not be read whole.
+     */
+    void readPages(const std::vector<PageId> &page_numbers,
+                   std::vector<Page> &pages) const;
+
+    /**
+     * Reads an existing page from the file asynchronously through an I/O engine.
+     * The page number is checked against the file size right away.
+     *
+     * @param engine        Engine running the read.
+     * @param page_number   Number of page to read.
+     * @param page          Page read into; must stay valid until done runs.
+     * @param done          Called on the engine's thread with true once the
+     *                      page is read, or false if the read failed or the page
+     *                      is not currently used.
+     * @throws  InvalidPageException  If the page doesn't exist in the file.
+     */
+    void readPageAsync(IoEngine &engine, const PageId page_number, Page &page,
+                       std::function<void(bool)> done) const;
+
+    /**
+     * Writes several pages into the file, like writePage() does for one page.
+     * Pages with consecutive page numbers are written with a single vectored
+     * write.  Nothing is written if any page has been deleted.
+     *
+     * @see writePage()
+     * @param pages   Pages to write, in any order.
+     * @throws  InvalidPageException  If any page has been deleted from the file.
+     * @throws  FileIOException       If any page could not be written; pages of
+     *                                other runs may have been.
+     */
+    void writePages(const std::vector<const Page *> &pages);
+
     /**
      * Deletes a page from the file.
      *
      * @param page_number   Number of page to delete.
+     * @throws  InvalidPageException  If the page doesn't exist in the file or is
+     *                                not currently used.
+     * @throws  FileIOException       If the page could not be cleared on disk.
      */
     void deletePage(const PageId page_number);
 
+    /**
+     * Writes the file header kept in memory to disk if it changed, then forces
+     * everything written to the file so far to stable storage (fsync).
+     *
+     * @throws  FileIOException   If the header could not be written or the
+     *                            fsync failed.
+     */
+    void sync();
+
     /**
      * Returns the name of the file this object represents.
      *
@@ -197,6 +377,28 @@ namespace badgerdb
     FileIterator end();
 
   private:
+    /**
+     * Number of pages in a group, which share one block of allocation map.
+     */
+    static const std::uint32_t PAGES_PER_MAP = Page::SIZE * 8;
+
+    /**
+     * Number of 64-bit words in the allocation map of a group.
+     */
+    static const std::uint32_t WORDS_PER_MAP = PAGES_PER_MAP / 64;
+
+    /**
+     * Returns the position of the allocation map of the group holding the page
+     * with the given number (as an offset from the beginning of the file).
+     *
+     * @param page_number   Number of page.
+     * @return  Position of the map in file.
+     */
+    static off_t mapPosition(const PageId page_number)
+    {
+      return (1 + (off_t)((page_number - 1) / PAGES_PER_MAP) * (PAGES_PER_MAP + 1)) * Page::SIZE;
+    }
+
     /**
      * Returns the position of the page with the given number in the file (as an
      * offset from the beginning of the file).
@@ -204,9 +406,9 @@ namespace badgerdb
      * @param page_number   Number of page.
      * @return  Position of page in file.
      */
-    static std::streampos pagePosition(const PageId page_number)
+    static off_t pagePosition(const PageId page_number)
     {
-      return sizeof(FileHeader) + ((page_number - 1) * Page::SIZE);
+      return mapPosition(page_number) + (1 + (page_number - 1) % PAGES_PER_MAP) * (off_t)Page::SIZE;
     }
 
     /**
@@ -222,24 +424,28 @@ namespace badgerdb
      *                                  create_new is true.
      * @throws  FileNotFoundException   If the underlying file doesn't exist and
      *                                  create_new is false.
+     * @throws  FileFormatException     If the underlying file is not in the
+     *                                  format of File.
      */
     File(const std::string &name, const bool create_new);
 
     /**
      * Opens the underlying file named in filename_.
      * This method only opens the file if no other File objects exist that access
-     * the same filesystem file; otherwise, it reuses the existing stream.
+     * the same filesystem file; otherwise, it reuses the existing descriptor.
      *
      * @param create_new  Whether to create a new file.
      * @throws  FileExistsException     If the underlying file exists and
      *                                  create_new is true.
      * @throws  FileNotFoundException   If the underlying file doesn't exist and
      *                                  create_new is false.
+     * @throws  FileFormatException     If the underlying file is not in the
+     *                                  format of File.
      */
     void openIfNeeded(const bool create_new);
 
     /**
-     * Closes the underlying file stream in <stream_>.
+     * Closes the underlying file descriptor in <fd_>.
      * This method only closes the file if no other File objects exist that access
      * the same file.
      */
@@ -249,20 +455,23 @@ namespace badgerdb
      * Reads a page from the file.  If <allow_free> is not set, an exception
      * will be thrown if the page read from disk is not currently in use.
      *
-     * No bounds checking is performed; the underlying file stream will throw
-     * an exception if the page is past the end of the file.
+     * No bounds checking is performed; a page wholly past the end of the file
+     * reads as a free page.
      *
      * @param page_number   Number of page to read.
+     * @param page          Page read into.
      * @param allow_free    Whether to allow reading a free (unused) page.
-     * @return  The page.
      * @throws  InvalidPageException  If the page is free (unused) and
      *                                allow_free is false.
+     * @throws  FileIOException       If the read failed or the page is cut
+     *                                short by the end of the file.
      */
-    Page readPage(const PageId page_number, const bool allow_free) const;
+    void readPageInto(const PageId page_number, Page &page,
+                      const bool allow_free) const;
 
     /**
      * Writes a page into the file at the given page number.  This does not
-     * update ensure that the number in the header equals the position on disk.
+     * ensure that the number in the header equals the position on disk.
      * No bounds checking is performed.
      *
      * @param page_number Number of page whose contents to replace.
@@ -283,55 +492,200 @@ namespace badgerdb
                    const Page &new_page);
 
     /**
-     * Reads the header for this file from disk.
+     * Returns the header for this file, as kept in memory.
      *
      * @return  The file header.
      */
-    FileHeader readHeader() const;
+    FileHeader readHeader() const { return state_->header; }
 
     /**
-     * Writes the given header to the disk as the header for this file.
+     * Sets the header for this file in memory.  It reaches the disk with the
+     * next flushHeader().
      *
      * @param header  File header to write.
      */
     void writeHeader(const FileHeader &header);
 
     /**
-     * Reads only the header of the given page from disk (not the record data
-     * or slot table).  No bounds checking is performed.
+     * Writes the header kept in memory to disk if it changed since it was last
+     * read or written.  The header stays dirty if the write fails.
+     *
+     * @throws  FileIOException   If the header could not be written.
+     */
+    void flushHeader();
+
+    /**
+     * Reads the file header and the allocation maps from disk into <state_>.
+     *
+     * @throws  FileFormatException   If the file is not in the format of File.
+     * @throws  FileIOException       If the header or a map could not be read.
+     */
+    void readState();
+
+    /**
+     * Returns true if the page with the given number is used, according to the
+     * allocation map kept in memory.
+     *
+     * @param page_number   Number of page.
+     */
+    bool isUsed(const PageId page_number) const;
+
+    /**
+     * Marks the page with the given number used or free in the allocation map
+     * kept in memory.  The map on disk is updated by writeMap().
+     *
+     * @param page_number   Number of page.
+     * @param used          Whether the page is used.
+     */
+    void setUsed(const PageId page_number, const bool used);
+
+    /**
+     * Returns the number of the first used page after the given one, or
+     * Page::INVALID_NUMBER if there is none.
+     *
+     * @param page_number   Number of page (0 to start from the first page).
+     * @return  Number of the next used page.
+     */
+    PageId nextPageNumber(const PageId page_number) const;
+
+    /**
+     * Returns the number of the last used page before the given one, or
+     * Page::INVALID_NUMBER if there is none.
+     *
+     * @param page_number   Number of page.
+     * @return  Number of the previous used page.
+     */
+    PageId previousPageNumber(const PageId page_number) const;
+
+    /**
+     * Returns the number of the first free page at or after the given one, or
+     * Page::INVALID_NUMBER if there is none.
+     *
+     * @param page_number   Number of page.
+     * @return  Number of the free page.
+     */
+    PageId nextFreePageNumber(const PageId page_number) const;
+
+    /**
+     * Writes the words of the allocation maps holding the bits of a range of
+     * pages from memory to disk, one call per group.
+     *
+     * @param first_page_number   Number of first page of the range.
+     * @param last_page_number    Number of last page of the range.
+     */
+    void writeMap(const PageId first_page_number, const PageId last_page_number);
+
+    /**
+     * Writes pages with the given headers in place of their own, a run of pages
+     * stored one after the other per vectored write.  No checking is performed.
+     *
+     * @param sorted    Pages to write, in page number order.
+     * @param headers   Headers to write, in the same order.
+     */
+    void writeRuns(const std::vector<const Page *> &sorted,
+                   const std::vector<PageHeader> &headers);
+
+    /**
+     * Replaces the next page number in the header of a page on disk, leaving
+     * the rest of the page alone.  No bounds checking is performed.
+     *
+     * The allocation map alone orders the used pages for File itself, but the
+     * pointer on disk is what Page::next_page_number() returns for a page read
+     * afterwards, and what a MappedFile view shows.  Reads do not take the
+     * latch the buffer manager holds around allocations, so they cannot fill
+     * the pointer in from the map; instead allocatePage() and deletePage() keep
+     * the chain on disk right with this one small write to the predecessor,
+     * which the page cache usually holds already.
+     *
+     * @param page_number       Number of page whose header to update.
+     * @param next_page_number  New number of the next used page.
+     */
+    void writeNextPageNumber(const PageId page_number, const PageId next_page_number);
+
+    /**
+     * Reads or writes all of the given buffers at the given offset of a file
+     * with IoEngine::transfer().
      *
-     * @param page_number   Number of page whose header is to be read.
-     * @return  Header of page.
+     * @param fd        File descriptor of the file.
+     * @param iov       Buffers to move; modified.
+     * @param iovcnt    Number of buffers.
+     * @param offset    Position in the file.
+     * @param write     Whether to write rather than read.
+     * @param filename  Name of the file, for the exception.
+     * @throws  FileIOException   If the transfer failed or moved fewer bytes
+     *                            than the buffers hold.
+     */
+    static void transferAll(const int fd, struct iovec *iov, const int iovcnt,
+                            const off_t offset, const bool write,
+                            const std::string &filename);
+
+    /**
+     * What is kept in memory about an opened file, shared by all File objects
+     * for it.
      */
-    PageHeader readPageHeader(const PageId page_number) const;
+    struct SharedState
+    {
+      /**
+       * Header of the file.
+       */
+      FileHeader header;
+
+      /**
+       * Whether the header differs from the one on disk.
+       */
+      bool header_dirty;
+
+      /**
+       * Number of pages of the header, for the bounds checks of page reads,
+       * which may run while a page is allocated.
+       */
+      std::atomic<PageId> num_pages;
+
+      /**
+       * Allocation maps of all groups, WORDS_PER_MAP words each; the bit of
+       * page n is bit (n - 1) % 64 of word (n - 1) / 64.
+       */
+      std::vector<std::uint64_t> used;
+    };
 
-    typedef std::map<std::string,
-                     std::shared_ptr<std::fstream>>
-        StreamMap;
     typedef std::map<std::string, int> CountMap;
+    typedef std::map<std::string, int> DescriptorMap;
+    typedef std::map<std::string, SharedState> StateMap;
 
     /**
-     * Streams for opened files.
+     * File descriptors for opened files.
      */
-    static StreamMap open_streams_;
+    static DescriptorMap open_fds_;
 
     /**
      * Counts for opened files.
      */
     static CountMap open_counts_;
 
+    /**
+     * Headers and allocation maps of opened files.
+     */
+    static StateMap open_states_;
+
     /**
      * Name of the file this object represents.
      */
     std::string filename_;
 
     /**
-     * Stream for underlying filesystem object.
+     * File descriptor for underlying filesystem object.
+     */
+    int fd_;
+
+    /**
+     * Header and allocation maps of the underlying file, shared by all File
+     * objects for it.
      */
-    std::shared_ptr<std::fstream> stream_;
+    SharedState *state_;
 
     friend class FileIterator;
     friend class FileTest;
+    friend class MappedFile;
   };
 
 }
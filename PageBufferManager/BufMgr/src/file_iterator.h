@@ -66,8 +66,7 @@ namespace badgerdb
     inline FileIterator &operator++()
     {
       assert(file_ != NULL);
-      const PageHeader &header = file_->readPageHeader(current_page_number_);
-      current_page_number_ = header.next_page_number;
+      current_page_number_ = file_->nextPageNumber(current_page_number_);
 
       return *this;
     }
@@ -78,8 +77,7 @@ namespace badgerdb
       FileIterator tmp = *this; // copy ourselves
 
       assert(file_ != NULL);
-      const PageHeader &header = file_->readPageHeader(current_page_number_);
-      current_page_number_ = header.next_page_number;
+      current_page_number_ = file_->nextPageNumber(current_page_number_);
 
       return tmp;
     }
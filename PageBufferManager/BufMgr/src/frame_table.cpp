@@ -0,0 +1,282 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <iostream>
+#include <new>
+#include <immintrin.h>
+
+#include "frame_table.h"
+
+namespace badgerdb
+{
+
+	const std::uint32_t FrameTable::WORD_BITS;
+	const FrameId FrameTable::NO_FRAME;
+
+	bool FrameTable::avx2 = __builtin_cpu_supports("avx2");
+
+	/**
+	 * Rounds a byte count up to whole cache lines, so that each array starts on its own line
+	 */
+	static std::size_t cacheLines(const std::size_t bytes)
+	{
+		return (bytes + 63) / 64 * 64;
+	}
+
+	FrameTable::FrameTable(std::uint32_t numBufs, const PoolMemoryConfig &config)
+		: numBufs(numBufs), numWords((numBufs + WORD_BITS - 1) / WORD_BITS)
+	{
+		const std::size_t bitmapBytes = cacheLines(numWords * sizeof(std::uint64_t));
+		const std::size_t countBytes = cacheLines(numBufs * sizeof(std::atomic<int>));
+		const std::size_t pageNoBytes = cacheLines(numBufs * sizeof(PageId));
+		const std::size_t fileBytes = cacheLines(numBufs * sizeof(File *));
+		const std::size_t nextFreeBytes = cacheLines(numBufs * sizeof(std::atomic<FrameId>));
+		const std::size_t linkBytes = cacheLines(numBufs * sizeof(FileLink));
+		memory = new PoolMemory(5 * bitmapBytes + countBytes + pageNoBytes + fileBytes + nextFreeBytes + linkBytes, config);
+
+		// The mapping is zero-filled: no frame is valid, pinned or holds a page
+		char *next = memory->data();
+		std::atomic<std::uint64_t> **bitmaps[] = {&pinned, &valid, &dirty, &referenced, &inRing};
+		for (int i = 0; i < 5; i++)
+		{
+			*bitmaps[i] = reinterpret_cast<std::atomic<std::uint64_t> *>(next);
+			for (std::uint32_t w = 0; w < numWords; w++)
+			{
+				new (&(*bitmaps[i])[w]) std::atomic<std::uint64_t>(0);
+			}
+			next += bitmapBytes;
+		}
+		pinCounts = reinterpret_cast<std::atomic<int> *>(next);
+		for (FrameId i = 0; i < numBufs; i++)
+		{
+			new (&pinCounts[i]) std::atomic<int>(0);
+		}
+		next += countBytes;
+		pageNos = reinterpret_cast<PageId *>(next);
+		next += pageNoBytes;
+		files = reinterpret_cast<File **>(next);
+		next += fileBytes;
+		nextFree = reinterpret_cast<std::atomic<FrameId> *>(next);
+		next += nextFreeBytes;
+		fileLinks = reinterpret_cast<FileLink *>(next);
+
+		// Hand out frames in increasing order
+		freeHead = NO_FRAME;
+		for (FrameId i = numBufs; i > 0; i--)
+		{
+			new (&nextFree[i - 1]) std::atomic<FrameId>(NO_FRAME);
+			pushFree(i - 1);
+		}
+
+		if (numBufs % WORD_BITS != 0)
+		{
+			pinned[numWords - 1] = ~0ull << (numBufs % WORD_BITS);
+		}
+	}
+
+	FrameTable::~FrameTable()
+	{
+		delete memory;
+	}
+
+	void FrameTable::set(const FrameId frame, File *filePtr, const PageId pageNum)
+	{
+		if (filePtr != NULL)
+		{
+			// Link the frame in first
+			std::unordered_map<const File *, FrameId>::iterator head = fileHeads.insert(std::make_pair(filePtr, NO_FRAME)).first;
+			fileLinks[frame].prev = NO_FRAME;
+			fileLinks[frame].next = head->second;
+			if (head->second != NO_FRAME)
+			{
+				fileLinks[head->second].prev = frame;
+			}
+			head->second = frame;
+		}
+		files[frame] = filePtr;
+		pageNos[frame] = pageNum;
+		pinCounts[frame] = 1;
+		pinned[wordOf(frame)].fetch_or(bitOf(frame));
+		setDirty(frame, false);
+		assign(valid, frame, true);
+		setReferenced(frame, true);
+	}
+
+	void FrameTable::clear(const FrameId frame)
+	{
+		pinCounts[frame] = 0;
+		pinned[wordOf(frame)].fetch_and(~bitOf(frame));
+		reset(frame);
+	}
+
+	void FrameTable::reserve(const FrameId frame)
+	{
+		// Pinned first, so that a sweep never sees the frame unpinned meanwhile
+		pinCounts[frame] = 1;
+		pinned[wordOf(frame)].fetch_or(bitOf(frame));
+		reset(frame);
+	}
+
+	void FrameTable::reset(const FrameId frame)
+	{
+		if (files[frame] != NULL)
+		{
+			const FileLink link = fileLinks[frame];
+			if (link.next != NO_FRAME)
+			{
+				fileLinks[link.next].prev = link.prev;
+			}
+			if (link.prev != NO_FRAME)
+			{
+				fileLinks[link.prev].next = link.next;
+			}
+			else if (link.next != NO_FRAME)
+			{
+				fileHeads[files[frame]] = link.next;
+			}
+			else
+			{
+				// Last page of the file
+				fileHeads.erase(files[frame]);
+			}
+		}
+		files[frame] = NULL;
+		pageNos[frame] = Page::INVALID_NUMBER;
+		setDirty(frame, false);
+		assign(valid, frame, false);
+		setReferenced(frame, false);
+		setInRing(frame, false);
+	}
+
+	void FrameTable::setVectorized(const bool enable)
+	{
+		avx2 = enable && __builtin_cpu_supports("avx2");
+	}
+
+	void FrameTable::framesOf(const File *file, std::vector<FrameId> &frames) const
+	{
+		std::unordered_map<const File *, FrameId>::const_iterator head = fileHeads.find(file);
+		for (FrameId frame = head == fileHeads.end() ? NO_FRAME : head->second; frame != NO_FRAME; frame = fileLinks[frame].next)
+		{
+			frames.push_back(frame);
+		}
+	}
+
+	void FrameTable::pushFree(const FrameId frame)
+	{
+		std::uint64_t head = freeHead.load(std::memory_order_relaxed);
+		std::uint64_t pushed;
+		do
+		{
+			nextFree[frame].store(static_cast<FrameId>(head), std::memory_order_relaxed);
+			pushed = ((head >> 32) + 1) << 32 | frame;
+		} while (!freeHead.compare_exchange_weak(head, pushed, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	bool FrameTable::popFree(FrameId &frame)
+	{
+		std::uint64_t head = freeHead.load(std::memory_order_acquire);
+		while (static_cast<FrameId>(head) != NO_FRAME)
+		{
+			// The counter makes the exchange fail if the frame was popped and pushed
+			// again in between, with a different successor
+			const FrameId top = static_cast<FrameId>(head);
+			const std::uint64_t popped = ((head >> 32) + 1) << 32 | nextFree[top].load(std::memory_order_relaxed);
+			if (freeHead.compare_exchange_weak(head, popped, std::memory_order_acquire, std::memory_order_acquire))
+			{
+				// Frames are cleared before they are pushed, so pinning is all that is
+				// left, and it needs no clockLatch
+				frame = top;
+				pin(frame);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::uint32_t FrameTable::secondChance(std::uint32_t first, const std::uint32_t last, bool &unpinnedSeen)
+	{
+		if (avx2)
+		{
+			first = secondChanceAvx2(first, last, unpinnedSeen);
+		}
+		for (std::uint32_t word = first; word < last; word++)
+		{
+			const std::uint64_t unpinned = validWord(word) & ~pinnedWord(word);
+			if (unpinned & ~referencedWord(word))
+			{
+				return word;
+			}
+			// Hits set reference bits at the same time under a partition latch only, so
+			// they are cleared with an atomic and. A hit landing between the check above
+			// and the clear loses its bit, as it could when frames were swept one at a
+			// time, and the frame only loses its second chance.
+			clearReferenced(word, unpinned);
+			unpinnedSeen |= unpinned != 0;
+		}
+		return last;
+	}
+
+	__attribute__((target("avx2"))) std::uint32_t FrameTable::secondChanceAvx2(std::uint32_t first, const std::uint32_t last, bool &unpinnedSeen)
+	{
+		// The bitmaps are arrays of lock-free 64-bit atomics, read four words at a time to
+		// find the first word holding a candidate. The reference bits passed over are
+		// cleared word by word as in the scalar sweep, never by a vector store.
+		const __m256i ones = _mm256_set1_epi64x(-1);
+		for (; first + 4 <= last; first += 4)
+		{
+			const __m256i *referencedBits = reinterpret_cast<const __m256i *>(&referenced[first]);
+			const __m256i pinnedBits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&pinned[first]));
+			const __m256i validBits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&valid[first]));
+			const __m256i referencedNow = _mm256_loadu_si256(referencedBits);
+			// A frame is passed over if it holds no page, is pinned or is referenced
+			const __m256i unpinned = _mm256_andnot_si256(pinnedBits, validBits);
+			if (!_mm256_testc_si256(referencedNow, unpinned))
+			{
+				return first;
+			}
+			unpinnedSeen |= !_mm256_testz_si256(unpinned, ones);
+			if (!_mm256_testz_si256(referencedNow, unpinned))
+			{
+				std::uint64_t masks[4];
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(masks), unpinned);
+				for (std::uint32_t k = 0; k < 4; k++)
+				{
+					clearReferenced(first + k, masks[k]);
+				}
+			}
+		}
+		return first;
+	}
+
+	std::uint32_t FrameTable::countDirty() const
+	{
+		std::uint32_t count = 0;
+		for (std::uint32_t w = 0; w < numWords; w++)
+		{
+			count += __builtin_popcountll(dirtyWord(w));
+		}
+		return count;
+	}
+
+	void FrameTable::print(const FrameId frame) const
+	{
+		if (files[frame])
+		{
+			std::cout << "file:" << files[frame]->filename() << " ";
+			std::cout << "pageNo:" << pageNos[frame] << " ";
+		}
+		else
+			std::cout << "file:NULL ";
+
+		std::cout << "valid:" << isValid(frame) << " ";
+		std::cout << "pinCnt:" << pinCount(frame) << " ";
+		std::cout << "dirty:" << isDirty(frame) << " ";
+		std::cout << "refbit:" << isReferenced(frame) << "\n";
+	}
+
+}
@@ -0,0 +1,307 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "file.h"
+#include "pool_memory.h"
+#include "types.h"
+
+namespace badgerdb
+{
+
+	/**
+	 * @brief Metadata of all frames of a buffer pool, stored as structure of arrays
+	 *
+	 * The page held by each frame is kept in a tag array (file and page number) and its
+	 * pin count in an array of counters. The valid, dirty, referenced, in-ring and
+	 * pinned flags are bitmaps of 64 frames per word, so that a sweep can test 64
+	 * frames with a few bit operations. The pinned bitmap mirrors pinCount() > 0; bits
+	 * past the last frame are permanently pinned so sweeps never pick them.
+	 *
+	 * Flags are set and cleared with atomic operations on their word, so frames sharing
+	 * a word may be updated by different threads. Pins and unpins of a frame must be
+	 * serialized by the caller (the hash partition latch of its page).
+	 *
+	 * Frames holding no page and not handed out are kept on a lock-free free list (a
+	 * Treiber stack whose head carries a counter against ABA), so that they can be
+	 * handed out in O(1) without sweeping. All frames start on it. A frame is cleared
+	 * before it is pushed, so popFree only pins the frame it takes and needs no latch:
+	 * a sweep sees the frame invalid throughout.
+	 *
+	 * The frames holding pages of each file are linked in a list per file, so that the
+	 * pages of a file are found without scanning the pool. set, clear and reserve
+	 * maintain these lists and must be serialized by the caller (the buffer manager's
+	 * clock latch). reserve pins the frame before it resets it.
+	 */
+	class FrameTable
+	{
+	public:
+		/**
+		 * Number of frames per bitmap word
+		 */
+		static const std::uint32_t WORD_BITS = 64;
+
+		/**
+		 * Creates the metadata of numBufs frames, all invalid and unpinned.
+		 *
+		 * @param numBufs   Number of frames in the buffer pool
+		 * @param memory   	Page size and NUMA node of the memory of the table
+		 */
+		FrameTable(std::uint32_t numBufs, const PoolMemoryConfig &memory);
+
+		~FrameTable();
+
+		FrameTable(const FrameTable &) = delete;
+		FrameTable &operator=(const FrameTable &) = delete;
+
+		/**
+		 * Number of bitmap words
+		 */
+		std::uint32_t words() const { return numWords; }
+
+		/**
+		 * Bitmap word holding the flags of a frame
+		 */
+		static std::uint32_t wordOf(const FrameId frame) { return frame / WORD_BITS; }
+
+		/**
+		 * Bit of a frame within its bitmap word
+		 */
+		static std::uint64_t bitOf(const FrameId frame) { return 1ull << (frame % WORD_BITS); }
+
+		/**
+		 * File of the page in a frame, NULL if the frame holds none
+		 */
+		File *file(const FrameId frame) const { return files[frame]; }
+
+		/**
+		 * Number of the page in a frame
+		 */
+		PageId pageNo(const FrameId frame) const { return pageNos[frame]; }
+
+		/**
+		 * Number of times the page in a frame is pinned; a frame handed out to be
+		 * filled counts as pinned once
+		 */
+		int pinCount(const FrameId frame) const { return pinCounts[frame]; }
+
+		bool isValid(const FrameId frame) const { return test(valid, frame); }
+		bool isDirty(const FrameId frame) const { return test(dirty, frame); }
+		bool isReferenced(const FrameId frame) const { return test(referenced, frame); }
+		bool isInRing(const FrameId frame) const { return test(inRing, frame); }
+
+		/**
+		 * Pins a frame once more
+		 */
+		void pin(const FrameId frame)
+		{
+			if (pinCounts[frame]++ == 0)
+			{
+				pinned[wordOf(frame)].fetch_or(bitOf(frame));
+			}
+		}
+
+		/**
+		 * Releases one pin of a frame
+		 */
+		void unpin(const FrameId frame)
+		{
+			if (--pinCounts[frame] == 0)
+			{
+				pinned[wordOf(frame)].fetch_and(~bitOf(frame));
+			}
+		}
+
+		void setDirty(const FrameId frame, const bool value) { assign(dirty, frame, value); }
+		void setReferenced(const FrameId frame, const bool value) { assign(referenced, frame, value); }
+		void setInRing(const FrameId frame, const bool value) { assign(inRing, frame, value); }
+
+		/**
+		 * Records that a frame now holds the given page, pinned once, clean and referenced
+		 */
+		void set(const FrameId frame, File *file, const PageId pageNo);
+
+		/**
+		 * Records that a frame holds no page and is not pinned
+		 */
+		void clear(const FrameId frame);
+
+		/**
+		 * Records that a frame holds no page and is handed out to be filled (pinned once)
+		 */
+		void reserve(const FrameId frame);
+
+		/**
+		 * Lists the frames holding pages of a file, in no particular order.
+		 *
+		 * @param file   	File object
+		 * @param frames  	Frames found, appended to this vector
+		 */
+		void framesOf(const File *file, std::vector<FrameId> &frames) const;
+
+		/**
+		 * Puts a cleared frame on the free list. It must not be on the list already.
+		 */
+		void pushFree(const FrameId frame);
+
+		/**
+		 * Takes a frame off the free list and pins it once, handing it out to be filled.
+		 *
+		 * @param frame   	Frame taken, returned via this variable
+		 * @return  		False if the free list is empty
+		 */
+		bool popFree(FrameId &frame);
+
+		/**
+		 * Bitmap words of 64 frames, for sweeps
+		 */
+		std::uint64_t pinnedWord(const std::uint32_t word) const { return pinned[word].load(std::memory_order_relaxed); }
+		std::uint64_t validWord(const std::uint32_t word) const { return valid[word].load(std::memory_order_relaxed); }
+		std::uint64_t dirtyWord(const std::uint32_t word) const { return dirty[word].load(std::memory_order_relaxed); }
+		std::uint64_t referencedWord(const std::uint32_t word) const { return referenced[word].load(std::memory_order_relaxed); }
+
+		/**
+		 * Clears the reference bits of the frames of a word selected by mask
+		 */
+		void clearReferenced(const std::uint32_t word, const std::uint64_t mask)
+		{
+			if (referenced[word].load(std::memory_order_relaxed) & mask)
+			{
+				referenced[word].fetch_and(~mask);
+			}
+		}
+
+		/**
+		 * Gives every unpinned page of the words [first, last) its second chance (clears
+		 * its reference bit), stopping at the first word holding an unpinned page that is
+		 * unreferenced. That word is left untouched. Frames holding no page are skipped;
+		 * they are on the free list. With AVX2 available and enabled, four words (256
+		 * frames) are tested per step.
+		 *
+		 * @param first   			First word to sweep
+		 * @param last   			Word after the last one to sweep
+		 * @param unpinnedSeen   	Set to true if any page swept is unpinned
+		 * @return  				Word holding a candidate victim, or last if none does
+		 */
+		std::uint32_t secondChance(std::uint32_t first, const std::uint32_t last, bool &unpinnedSeen);
+
+		/**
+		 * Enables or disables the AVX2 sweep; it is enabled by default when the CPU supports
+		 * it. Enabling it on a CPU without AVX2 has no effect.
+		 */
+		static void setVectorized(const bool enable);
+
+		/**
+		 * Whether secondChance uses AVX2
+		 */
+		static bool vectorized() { return avx2; }
+
+		/**
+		 * Number of dirty frames, counted without any latch
+		 */
+		std::uint32_t countDirty() const;
+
+		/**
+		 * Prints the metadata of a frame
+		 */
+		void print(const FrameId frame) const;
+
+	private:
+		/**
+		 * AVX2 part of secondChance: sweeps whole groups of four words and returns the
+		 * first word of the group holding a candidate, or the first word not swept
+		 */
+		std::uint32_t secondChanceAvx2(std::uint32_t first, const std::uint32_t last, bool &unpinnedSeen);
+
+		/**
+		 * Whether secondChance uses AVX2
+		 */
+		static bool avx2;
+
+		/**
+		 * Unlinks a frame from its file's list and resets everything but its pins
+		 */
+		void reset(const FrameId frame);
+
+		bool test(const std::atomic<std::uint64_t> *bitmap, const FrameId frame) const
+		{
+			return bitmap[wordOf(frame)].load(std::memory_order_relaxed) & bitOf(frame);
+		}
+
+		/**
+		 * Sets or clears a bit, skipping the atomic update if it already has the value
+		 */
+		void assign(std::atomic<std::uint64_t> *bitmap, const FrameId frame, const bool value)
+		{
+			std::atomic<std::uint64_t> &word = bitmap[wordOf(frame)];
+			const std::uint64_t bit = bitOf(frame);
+			if (((word.load(std::memory_order_relaxed) & bit) != 0) == value)
+			{
+				return;
+			}
+			if (value)
+				word.fetch_or(bit);
+			else
+				word.fetch_and(~bit);
+		}
+
+		std::uint32_t numBufs;
+		std::uint32_t numWords;
+		PoolMemory *memory;
+
+		std::atomic<std::uint64_t> *pinned;
+		std::atomic<std::uint64_t> *valid;
+		std::atomic<std::uint64_t> *dirty;
+		std::atomic<std::uint64_t> *referenced;
+		std::atomic<std::uint64_t> *inRing;
+		std::atomic<int> *pinCounts;
+		PageId *pageNos;
+		File **files;
+
+		/**
+		 * Frame after each frame on the free list
+		 */
+		std::atomic<FrameId> *nextFree;
+
+		/**
+		 * Top frame of the free list in the low half (NO_FRAME if empty), and a counter
+		 * bumped by every change in the high half
+		 */
+		std::atomic<std::uint64_t> freeHead;
+
+		/**
+		 * Neighbours of a frame in the list of frames of its file
+		 */
+		struct FileLink
+		{
+			FrameId prev;
+			FrameId next;
+		};
+
+		/**
+		 * Links of each frame holding a page of a file
+		 */
+		FileLink *fileLinks;
+
+		/**
+		 * First frame of the list of each file with pages in the pool
+		 */
+		std::unordered_map<const File *, FrameId> fileHeads;
+
+		/**
+		 * Marks the end of the free list and of file lists
+		 */
+		static const FrameId NO_FRAME = ~0u;
+	};
+
+}
@@ -0,0 +1,385 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "io_engine.h"
+#include "exceptions/io_engine_exception.h"
+
+namespace badgerdb
+{
+
+	const std::uint64_t UringIoEngine::WAKE_UP;
+
+	IoEngine *IoEngine::create(IoEngineType type, std::uint32_t queueDepth, std::uint32_t poolThreads)
+	{
+		if (type != IoEngineType::THREAD_POOL)
+		{
+			try
+			{
+				return new UringIoEngine(queueDepth);
+			}
+			catch (IoEngineException &)
+			{
+				if (type == IoEngineType::IO_URING)
+				{
+					throw;
+				}
+			}
+		}
+		return new ThreadPoolIoEngine(queueDepth, poolThreads);
+	}
+
+	ssize_t IoEngine::transfer(const int fd, struct iovec *iov, const int iovcnt, off_t offset, const bool write)
+	{
+		struct iovec *next = iov;
+		int remaining = iovcnt;
+		ssize_t total = 0;
+		while (remaining > 0)
+		{
+			const ssize_t done = write ? pwritev(fd, next, remaining, offset)
+									   : preadv(fd, next, remaining, offset);
+			if (done < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (done < 0)
+			{
+				return total > 0 ? total : -errno;
+			}
+			if (done == 0)
+			{
+				break;
+			}
+			offset += done;
+			total += done;
+			// Skip the buffers transferred completely and trim the first one left
+			std::size_t left = done;
+			while (remaining > 0 && left >= next->iov_len)
+			{
+				left -= next->iov_len;
+				++next;
+				--remaining;
+			}
+			if (remaining > 0)
+			{
+				next->iov_base = static_cast<char *>(next->iov_base) + left;
+				next->iov_len -= left;
+			}
+		}
+		return total;
+	}
+
+	UringIoEngine::UringIoEngine(std::uint32_t queueDepth)
+		: requests(queueDepth), stopping(false)
+	{
+		struct io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		ringFd = syscall(__NR_io_uring_setup, queueDepth, &params);
+		if (ringFd < 0)
+		{
+			throw IoEngineException(name(), errno);
+		}
+
+		// Map the submission ring, the completion ring (possibly the same mapping) and
+		// the submission queue entries
+		sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+		const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (singleMmap)
+		{
+			sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+		}
+		sqeAreaSize = params.sq_entries * sizeof(struct io_uring_sqe);
+		sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+		cqRing = singleMmap ? sqRing : mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		sqeArea = mmap(NULL, sqeAreaSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+		if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqeArea == MAP_FAILED)
+		{
+			const int error = errno;
+			if (sqRing != MAP_FAILED)
+				munmap(sqRing, sqRingSize);
+			if (!singleMmap && cqRing != MAP_FAILED)
+				munmap(cqRing, cqRingSize);
+			if (sqeArea != MAP_FAILED)
+				munmap(sqeArea, sqeAreaSize);
+			close(ringFd);
+			throw IoEngineException(name(), error);
+		}
+
+		char *sq = static_cast<char *>(sqRing);
+		char *cq = static_cast<char *>(cqRing);
+		sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+		sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+		sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+		sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+		cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+		cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+		cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+		cqes = cq + params.cq_off.cqes;
+
+		for (std::uint32_t i = queueDepth; i > 0; i--)
+		{
+			freeSlots.push_back(i - 1);
+		}
+		completionThread = std::thread(&UringIoEngine::reap, this);
+	}
+
+	UringIoEngine::~UringIoEngine()
+	{
+		{
+			std::unique_lock<std::mutex> guard(latch);
+			while (freeSlots.size() < requests.size())
+			{
+				slotFreed.wait(guard);
+			}
+			// Wake the completion thread with a no-op so that it exits
+			stopping = true;
+			pushSqe(IORING_OP_NOP, -1, NULL, 0, 0, WAKE_UP);
+		}
+		completionThread.join();
+		if (cqRing != sqRing)
+			munmap(cqRing, cqRingSize);
+		munmap(sqRing, sqRingSize);
+		munmap(sqeArea, sqeAreaSize);
+		close(ringFd);
+	}
+
+	void UringIoEngine::pushSqe(const std::uint8_t opcode, const int fd, const struct iovec *iov, const int iovcnt,
+								const off_t offset, const std::uint64_t userData)
+	{
+		// Only one thread fills the submission queue at a time (latch held), and the
+		// kernel consumes every entry in io_uring_enter below or it is withdrawn, so
+		// the queue never fills
+		const unsigned tail = *sqTail;
+		const unsigned index = tail & sqMask;
+		struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(sqeArea) + index;
+		std::memset(sqe, 0, sizeof(*sqe));
+		sqe->opcode = opcode;
+		sqe->fd = fd;
+		sqe->addr = reinterpret_cast<std::uint64_t>(iov);
+		sqe->len = iovcnt;
+		sqe->off = offset;
+		sqe->user_data = userData;
+		sqArray[index] = index;
+		__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+		while (syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, NULL, 0) < 0)
+		{
+			if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			{
+				const int error = errno;
+				if (__atomic_load_n(sqHead, __ATOMIC_ACQUIRE) != tail)
+				{
+					// Consumed all the same; its completion reports the outcome
+					return;
+				}
+				__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+				throw IoEngineException(name(), error);
+			}
+		}
+	}
+
+	void UringIoEngine::pushRequest(const std::uint32_t slot)
+	{
+		const Request &request = requests[slot];
+		pushSqe(request.write ? IORING_OP_WRITEV : IORING_OP_READV, request.fd, &request.iov[0],
+				request.iov.size(), request.offset, slot);
+	}
+
+	bool UringIoEngine::resume(const std::uint32_t slot, const int res)
+	{
+		Request &request = requests[slot];
+		if (res > 0)
+		{
+			request.offset += res;
+			request.transferred += res;
+			// Drop the buffers transferred completely and trim the first one left
+			std::size_t left = res;
+			std::vector<struct iovec>::iterator next = request.iov.begin();
+			while (next != request.iov.end() && left >= next->iov_len)
+			{
+				left -= next->iov_len;
+				++next;
+			}
+			request.iov.erase(request.iov.begin(), next);
+			if (request.iov.empty())
+			{
+				return false;
+			}
+			request.iov[0].iov_base = static_cast<char *>(request.iov[0].iov_base) + left;
+			request.iov[0].iov_len -= left;
+		}
+		else if (res != -EINTR && res != -EAGAIN)
+		{
+			// Failed, or at the end of the file
+			return false;
+		}
+		try
+		{
+			pushRequest(slot);
+		}
+		catch (IoEngineException &)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	void UringIoEngine::submit(const int fd, const struct iovec *iov, const int iovcnt, const off_t offset,
+							   const bool write, Completion done)
+	{
+		std::unique_lock<std::mutex> guard(latch);
+		while (freeSlots.empty())
+		{
+			slotFreed.wait(guard);
+		}
+		const std::uint32_t slot = freeSlots.back();
+		freeSlots.pop_back();
+		Request &request = requests[slot];
+		try
+		{
+			request.fd = fd;
+			request.iov.assign(iov, iov + iovcnt);
+			request.offset = offset;
+			request.write = write;
+			request.transferred = 0;
+			request.done = done;
+			pushRequest(slot);
+		}
+		catch (...)
+		{
+			// Nothing was submitted, so no completion will give the slot back
+			request.done = Completion();
+			freeSlots.push_back(slot);
+			slotFreed.notify_all();
+			throw;
+		}
+	}
+
+	void UringIoEngine::reap()
+	{
+		const struct io_uring_cqe *ring = static_cast<const struct io_uring_cqe *>(cqes);
+		while (true)
+		{
+			syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+			unsigned head = *cqHead;
+			const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+			bool exit = false;
+			for (; head != tail; head++)
+			{
+				const struct io_uring_cqe cqe = ring[head & cqMask];
+				__atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+				if (cqe.user_data == WAKE_UP)
+				{
+					exit = true;
+					continue;
+				}
+				Completion done;
+				ssize_t result;
+				{
+					std::lock_guard<std::mutex> guard(latch);
+					if (resume(cqe.user_data, cqe.res))
+					{
+						continue;
+					}
+					Request &request = requests[cqe.user_data];
+					// Like transfer(): the bytes moved, or the error if there were none
+					result = request.transferred > 0 ? request.transferred : cqe.res;
+					done.swap(request.done);
+				}
+				done(result);
+				{
+					std::lock_guard<std::mutex> guard(latch);
+					freeSlots.push_back(cqe.user_data);
+				}
+				slotFreed.notify_all();
+			}
+			if (exit)
+			{
+				return;
+			}
+		}
+	}
+
+	ThreadPoolIoEngine::ThreadPoolIoEngine(std::uint32_t queueDepth, std::uint32_t threads)
+		: queueDepth(queueDepth), inFlight(0), stopping(false)
+	{
+		for (std::uint32_t i = 0; i < std::max<std::uint32_t>(1, threads); i++)
+		{
+			workers.push_back(std::thread(&ThreadPoolIoEngine::worker, this));
+		}
+	}
+
+	ThreadPoolIoEngine::~ThreadPoolIoEngine()
+	{
+		{
+			std::unique_lock<std::mutex> guard(latch);
+			while (inFlight > 0)
+			{
+				finished.wait(guard);
+			}
+			stopping = true;
+		}
+		queued.notify_all();
+		for (std::size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+	}
+
+	void ThreadPoolIoEngine::submit(const int fd, const struct iovec *iov, const int iovcnt, const off_t offset,
+									const bool write, Completion done)
+	{
+		Request request;
+		request.fd = fd;
+		request.iov.assign(iov, iov + iovcnt);
+		request.offset = offset;
+		request.write = write;
+		request.done = done;
+		{
+			std::unique_lock<std::mutex> guard(latch);
+			while (inFlight >= queueDepth)
+			{
+				finished.wait(guard);
+			}
+			inFlight++;
+			queue.push_back(request);
+		}
+		queued.notify_one();
+	}
+
+	void ThreadPoolIoEngine::worker()
+	{
+		std::unique_lock<std::mutex> guard(latch);
+		while (true)
+		{
+			while (!stopping && queue.empty())
+			{
+				queued.wait(guard);
+			}
+			if (queue.empty())
+			{
+				return;
+			}
+			Request request = queue.front();
+			queue.pop_front();
+			guard.unlock();
+			request.done(transfer(request.fd, &request.iov[0], request.iov.size(), request.offset, request.write));
+			guard.lock();
+			inFlight--;
+			finished.notify_all();
+		}
+	}
+
+}
@@ -0,0 +1,220 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace badgerdb
+{
+
+	/**
+	 * @brief Kinds of asynchronous I/O engine
+	 */
+	enum class IoEngineType
+	{
+		/**
+		 * io_uring if the kernel allows it, otherwise a thread pool
+		 */
+		AUTO,
+		IO_URING,
+		THREAD_POOL
+	};
+
+	/**
+	 * @brief Runs vectored reads and writes asynchronously and reports their completion.
+	 *
+	 * Requests may be submitted from any thread. Completions run on a thread owned by
+	 * the engine, one at a time for io_uring and concurrently for the thread pool; they
+	 * must not throw, and must not submit further requests since a full queue would
+	 * wait for them. The destructor waits for every request submitted to complete.
+	 */
+	class IoEngine
+	{
+	public:
+		/**
+		 * Called with the number of bytes transferred, or -errno on failure
+		 */
+		typedef std::function<void(ssize_t)> Completion;
+
+		/**
+		 * Creates an engine.
+		 *
+		 * @param type   		Kind of engine; AUTO falls back to a thread pool if io_uring is unavailable
+		 * @param queueDepth	Maximum number of requests in flight; submit() waits beyond it
+		 * @param poolThreads	Number of threads of a thread pool engine
+		 * @return  			Newly allocated engine, owned by the caller.
+		 * @throws  IoEngineException If IO_URING is requested and the kernel refuses it
+		 */
+		static IoEngine *create(IoEngineType type = IoEngineType::AUTO, std::uint32_t queueDepth = 64, std::uint32_t poolThreads = 4);
+
+		/**
+		 * Reads or writes all of the given buffers at the given offset synchronously,
+		 * resuming after partial transfers and interrupted calls. The iovecs are
+		 * modified. Errors and end of file end the transfer; buffers not filled by a
+		 * read keep their contents.
+		 *
+		 * @return  Number of bytes transferred, or -errno if the first call failed
+		 */
+		static ssize_t transfer(const int fd, struct iovec *iov, const int iovcnt, off_t offset, const bool write);
+
+		virtual ~IoEngine() {}
+
+		/**
+		 * Name of the engine.
+		 */
+		virtual const char *name() const = 0;
+
+		/**
+		 * Queues a vectored read or write. The iovecs are copied; the buffers they
+		 * point to must stay valid until the completion runs. As with transfer(),
+		 * partial transfers are resumed, so done gets fewer bytes than asked for
+		 * only after an error or at the end of the file.
+		 *
+		 * @param fd   		File descriptor
+		 * @param iov   	Buffers
+		 * @param iovcnt   	Number of buffers
+		 * @param offset   	Position in the file
+		 * @param write   	True to write, false to read
+		 * @param done   	Called once the request completed
+		 * @throws  IoEngineException If the request could not be queued; done is
+		 * 			then never called
+		 */
+		virtual void submit(const int fd, const struct iovec *iov, const int iovcnt, const off_t offset,
+							const bool write, Completion done) = 0;
+	};
+
+	/**
+	 * @brief I/O engine using io_uring through raw system calls
+	 *
+	 * Requests go into the submission queue under a latch and are submitted right
+	 * away; a completion thread waits on the completion queue and runs completions.
+	 */
+	class UringIoEngine : public IoEngine
+	{
+	public:
+		/**
+		 * @throws  IoEngineException If the ring cannot be set up
+		 */
+		UringIoEngine(std::uint32_t queueDepth);
+		~UringIoEngine();
+		const char *name() const { return "io_uring"; }
+		void submit(const int fd, const struct iovec *iov, const int iovcnt, const off_t offset,
+					const bool write, Completion done);
+
+	private:
+		/**
+		 * Request in flight, kept until its completion ran. A short transfer is
+		 * resubmitted for the buffers left, from the same slot.
+		 */
+		struct Request
+		{
+			int fd;
+			std::vector<struct iovec> iov;
+			off_t offset;
+			bool write;
+			ssize_t transferred;
+			Completion done;
+		};
+
+		/**
+		 * user_data of the no-op that wakes the completion thread to exit
+		 */
+		static const std::uint64_t WAKE_UP = ~0ull;
+
+		/**
+		 * Queues an entry and submits it, latch held.
+		 *
+		 * @throws  IoEngineException If the kernel refused the entry, which is then
+		 * 			withdrawn so that no completion will come for it
+		 */
+		void pushSqe(const std::uint8_t opcode, const int fd, const struct iovec *iov, const int iovcnt,
+					 const off_t offset, const std::uint64_t userData);
+
+		/**
+		 * Submits what is left of the request in a slot, latch held.
+		 */
+		void pushRequest(const std::uint32_t slot);
+
+		/**
+		 * Accounts for a completion of the request in a slot, latch held, and
+		 * resubmits the request if it moved fewer bytes than asked for or was
+		 * interrupted.
+		 *
+		 * @return  True if the request was resubmitted
+		 */
+		bool resume(const std::uint32_t slot, const int res);
+
+		void reap();
+
+		int ringFd;
+		void *sqRing;
+		void *cqRing;
+		void *sqeArea;
+		std::size_t sqRingSize;
+		std::size_t cqRingSize;
+		std::size_t sqeAreaSize;
+		unsigned *sqHead;
+		unsigned *sqTail;
+		unsigned sqMask;
+		unsigned *sqArray;
+		unsigned *cqHead;
+		unsigned *cqTail;
+		unsigned cqMask;
+		void *cqes;
+
+		std::mutex latch;
+		std::condition_variable slotFreed;
+		std::vector<Request> requests;
+		std::vector<std::uint32_t> freeSlots;
+		bool stopping;
+		std::thread completionThread;
+	};
+
+	/**
+	 * @brief I/O engine running blocking preadv/pwritev calls on a pool of threads
+	 */
+	class ThreadPoolIoEngine : public IoEngine
+	{
+	public:
+		ThreadPoolIoEngine(std::uint32_t queueDepth, std::uint32_t threads);
+		~ThreadPoolIoEngine();
+		const char *name() const { return "thread pool"; }
+		void submit(const int fd, const struct iovec *iov, const int iovcnt, const off_t offset,
+					const bool write, Completion done);
+
+	private:
+		struct Request
+		{
+			int fd;
+			std::vector<struct iovec> iov;
+			off_t offset;
+			bool write;
+			Completion done;
+		};
+
+		void worker();
+
+		std::uint32_t queueDepth;
+		std::mutex latch;
+		std::condition_variable queued;
+		std::condition_variable finished;
+		std::deque<Request> queue;
+		std::uint32_t inFlight;
+		bool stopping;
+		std::vector<std::thread> workers;
+	};
+
+}
@@ -3,16 +3,33 @@
 // #include <stdio.h>
 #include <cstring>
 #include <memory>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include "page.h"
 #include "pagebuffer.h"
 #include "file_iterator.h"
+#include "mapped_file.h"
 #include "page_iterator.h"
+#include "bufHashTbl.h"
 #include "exceptions/file_not_found_exception.h"
+#include "exceptions/file_format_exception.h"
+#include "exceptions/file_io_exception.h"
 #include "exceptions/invalid_page_exception.h"
 #include "exceptions/page_not_pinned_exception.h"
 #include "exceptions/page_pinned_exception.h"
+#include "exceptions/read_only_file_exception.h"
 #include "exceptions/buffer_exceeded_exception.h"
 #include "exceptions/hash_not_found_exception.h"
+#include "exceptions/hash_table_exception.h"
 
 #define PRINT_ERROR(str)                                \
 	{                                                   \
@@ -30,7 +47,7 @@ Page *page, *page2, *page3, *page7, *page8, *page9, *page10, *page11, *page12;
 char tmpbuf[100];
 PageBufferManager *bufMgr;
 File *file1ptr, *file2ptr, *file3ptr, *file4ptr, *file5ptr, *file7ptr, *file8ptr,
-	*file9ptr, *file10ptr, *file11ptr, *file12ptr;
+	*file9ptr, *file10ptr, *file11ptr, *file12ptr, *file13ptr, *file14ptr, *file15ptr, *file16ptr, *file17ptr, *file18ptr, *file19ptr, *file20ptr, *file21ptr, *file22ptr, *file23ptr, *file24ptr, *file25ptr, *file26ptr, *file27ptr, *file28ptr, *file29ptr, *file30ptr, *file31ptr, *file32ptr, *file33ptr, *file34ptr, *file35ptr, *file36ptr, *file37ptr;
 
 void test1();
 void test2();
@@ -44,6 +61,31 @@ void test9();
 void test10();
 void test11();
 void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
+void test19();
+void test20();
+void test21();
+void test22();
+void test23();
+void test24();
+void test25();
+void test26();
+void test27();
+void test28();
+void test29();
+void test30();
+void test31();
+void test32();
+void test33();
+void test34();
+void test35();
+void test36();
+void test37();
 void testBufMgr();
 
 int main()
@@ -85,13 +127,15 @@ int main()
 			 iter != new_file.end();
 			 ++iter)
 		{
-			// Iterate through all records on the page.
-			for (PageIterator page_iter = (*iter).begin();
-				 page_iter != (*iter).end();
+			// Iterate through all records on the page. The page is held in a
+			// local so the record iterators do not outlive it.
+			Page current_page = *iter;
+			for (PageIterator page_iter = current_page.begin();
+				 page_iter != current_page.end();
 				 ++page_iter)
 			{
 				std::cout << "Found record: " << *page_iter
-						  << " on page " << (*iter).page_number() << "\n";
+						  << " on page " << current_page.page_number() << "\n";
 			}
 		}
 
@@ -130,6 +174,31 @@ void testBufMgr()
 	const std::string &filename10 = "test.10";
 	const std::string &filename11 = "test.11";
 	const std::string &filename12 = "test.12";
+	const std::string &filename13 = "test.13";
+	const std::string &filename14 = "test.14";
+	const std::string &filename15 = "test.15";
+	const std::string &filename16 = "test.16";
+	const std::string &filename17 = "test.17";
+	const std::string &filename18 = "test.18";
+	const std::string &filename19 = "test.19";
+	const std::string &filename20 = "test.20";
+	const std::string &filename21 = "test.21";
+	const std::string &filename22 = "test.22";
+	const std::string &filename23 = "test.23";
+	const std::string &filename24 = "test.24";
+	const std::string &filename25 = "test.25";
+	const std::string &filename26 = "test.26";
+	const std::string &filename27 = "test.27";
+	const std::string &filename28 = "test.28";
+	const std::string &filename29 = "test.29";
+	const std::string &filename30 = "test.30";
+	const std::string &filename31 = "test.31";
+	const std::string &filename32 = "test.32";
+	const std::string &filename33 = "test.33";
+	const std::string &filename34 = "test.34";
+	const std::string &filename35 = "test.35";
+	const std::string &filename36 = "test.36";
+	const std::string &filename37 = "test.37";
 
 	try
 	{
@@ -144,6 +213,31 @@ void testBufMgr()
 		File::remove(filename10);
 		File::remove(filename11);
 		File::remove(filename12);
+		File::remove(filename13);
+		File::remove(filename14);
+		File::remove(filename15);
+		File::remove(filename16);
+		File::remove(filename17);
+		File::remove(filename18);
+		File::remove(filename19);
+		File::remove(filename20);
+		File::remove(filename21);
+		File::remove(filename22);
+		File::remove(filename23);
+		File::remove(filename24);
+		File::remove(filename25);
+		File::remove(filename26);
+		File::remove(filename27);
+		File::remove(filename28);
+		File::remove(filename29);
+		File::remove(filename30);
+		File::remove(filename31);
+		File::remove(filename32);
+		File::remove(filename33);
+		File::remove(filename34);
+		File::remove(filename35);
+		File::remove(filename36);
+		File::remove(filename37);
 	}
 	catch (FileNotFoundException e)
 	{
@@ -160,6 +254,31 @@ void testBufMgr()
 	File file10 = File::create(filename10);
 	File file11 = File::create(filename11);
 	File file12 = File::create(filename12);
+	File file13 = File::create(filename13);
+	File file14 = File::create(filename14);
+	File file15 = File::create(filename15);
+	File file16 = File::create(filename16);
+	File file17 = File::create(filename17);
+	File file18 = File::create(filename18);
+	File file19 = File::create(filename19);
+	File file20 = File::create(filename20);
+	File file21 = File::create(filename21);
+	File file22 = File::create(filename22);
+	File file23 = File::create(filename23);
+	File file24 = File::create(filename24);
+	File file25 = File::create(filename25);
+	File file26 = File::create(filename26);
+	File file27 = File::create(filename27);
+	File file28 = File::create(filename28);
+	File file29 = File::create(filename29);
+	File file30 = File::create(filename30);
+	File file31 = File::create(filename31);
+	File file32 = File::create(filename32);
+	File file33 = File::create(filename33);
+	File file34 = File::create(filename34);
+	File file35 = File::create(filename35);
+	File file36 = File::create(filename36);
+	File file37 = File::create(filename37);
 
 	file1ptr = &file1;
 	file2ptr = &file2;
@@ -172,6 +291,31 @@ void testBufMgr()
 	file10ptr = &file10;
 	file11ptr = &file11;
 	file12ptr = &file12;
+	file13ptr = &file13;
+	file14ptr = &file14;
+	file15ptr = &file15;
+	file16ptr = &file16;
+	file17ptr = &file17;
+	file18ptr = &file18;
+	file19ptr = &file19;
+	file20ptr = &file20;
+	file21ptr = &file21;
+	file22ptr = &file22;
+	file23ptr = &file23;
+	file24ptr = &file24;
+	file25ptr = &file25;
+	file26ptr = &file26;
+	file27ptr = &file27;
+	file28ptr = &file28;
+	file29ptr = &file29;
+	file30ptr = &file30;
+	file31ptr = &file31;
+	file32ptr = &file32;
+	file33ptr = &file33;
+	file34ptr = &file34;
+	file35ptr = &file35;
+	file36ptr = &file36;
+	file37ptr = &file37;
 
 	// Test buffer manager
 	// Comment tests which you do not wish to run now. Tests are dependent on their preceding tests. So, they have to be run in the following order.
@@ -188,6 +332,31 @@ void testBufMgr()
 	test10();
 	test11();
 	test12();
+	test13();
+	test14();
+	test15();
+	test16();
+	test17();
+	test18();
+	test19();
+	test20();
+	test21();
+	test22();
+	test23();
+	test24();
+	test25();
+	test26();
+	test27();
+	test28();
+	test29();
+	test30();
+	test31();
+	test32();
+	test33();
+	test34();
+	test35();
+	test36();
+	test37();
 
 	// Close files before deleting them
 	file1.~File();
@@ -201,6 +370,31 @@ void testBufMgr()
 	file10.~File();
 	file11.~File();
 	file12.~File();
+	file13.~File();
+	file14.~File();
+	file15.~File();
+	file16.~File();
+	file17.~File();
+	file18.~File();
+	file19.~File();
+	file20.~File();
+	file21.~File();
+	file22.~File();
+	file23.~File();
+	file24.~File();
+	file25.~File();
+	file26.~File();
+	file27.~File();
+	file28.~File();
+	file29.~File();
+	file30.~File();
+	file31.~File();
+	file32.~File();
+	file33.~File();
+	file34.~File();
+	file35.~File();
+	file36.~File();
+	file37.~File();
 
 	// Delete files
 	File::remove(filename1);
@@ -214,6 +408,31 @@ void testBufMgr()
 	File::remove(filename10);
 	File::remove(filename11);
 	File::remove(filename12);
+	File::remove(filename13);
+	File::remove(filename14);
+	File::remove(filename15);
+	File::remove(filename16);
+	File::remove(filename17);
+	File::remove(filename18);
+	File::remove(filename19);
+	File::remove(filename20);
+	File::remove(filename21);
+	File::remove(filename22);
+	File::remove(filename23);
+	File::remove(filename24);
+	File::remove(filename25);
+	File::remove(filename26);
+	File::remove(filename27);
+	File::remove(filename28);
+	File::remove(filename29);
+	File::remove(filename30);
+	File::remove(filename31);
+	File::remove(filename32);
+	File::remove(filename33);
+	File::remove(filename34);
+	File::remove(filename35);
+	File::remove(filename36);
+	File::remove(filename37);
 
 	delete bufMgr;
 
@@ -544,4 +763,2006 @@ void test12()
 	bufMgr->flushFile(file12ptr);
 	std::cout << "Test 12 passed"
 			  << "\n";
-}
\ No newline at end of file
+}
+
+void test13()
+{
+	// 13. Test description: Several threads reading pages concurrently
+	// Allocating more pages than there are frames, so that readers also evict
+	const int n_pages = num + num / 2;
+	std::vector<PageId> pages13(n_pages);
+	std::vector<RecordId> rids13(n_pages);
+	for (int j = 0; j < n_pages; j++)
+	{
+		bufMgr->allocatePage(file13ptr, pages13[j], page);
+		sprintf((char *)tmpbuf, "test.13 Page %d %7.1f", pages13[j], (float)pages13[j]);
+		rids13[j] = page->insertRecord(tmpbuf);
+		bufMgr->unPinPage(file13ptr, pages13[j], true);
+	}
+	// Reading pages back from several threads...
+	std::atomic<int> mismatches(0);
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 4; t++)
+	{
+		readers.push_back(std::thread([t, n_pages, &pages13, &rids13, &mismatches]()
+									  {
+			char expected[100];
+			Page *readerPage;
+			for (int round = 0; round < 2000; round++)
+			{
+				const int j = (round * 7 + t * 13) % n_pages;
+				bufMgr->readPage(file13ptr, pages13[j], readerPage);
+				sprintf(expected, "test.13 Page %d %7.1f", pages13[j], (float)pages13[j]);
+				if (strncmp(readerPage->getRecord(rids13[j]).c_str(), expected, strlen(expected)) != 0)
+				{
+					mismatches++;
+				}
+				bufMgr->unPinPage(file13ptr, pages13[j], false);
+			} }));
+	}
+	for (std::size_t t = 0; t < readers.size(); t++)
+	{
+		readers[t].join();
+	}
+	if (mismatches != 0)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	bufMgr->flushFile(file13ptr);
+	std::cout << "Test 13 passed"
+			  << "\n";
+}
+
+void test14()
+{
+	// 14. Test description: Every replacement policy keeps page contents intact and
+	// reports an exhausted pool
+	const ReplacementPolicyType policies[] = {ReplacementPolicyType::CLOCK, ReplacementPolicyType::LRU_K,
+											  ReplacementPolicyType::TWO_Q, ReplacementPolicyType::ARC,
+											  ReplacementPolicyType::CLOCK_PRO};
+	const std::uint32_t frames = 10;
+	const int n_pages = 3 * frames;
+	std::vector<PageId> pages14(n_pages);
+	std::vector<RecordId> rids14(n_pages);
+	for (int p = 0; p < 5; p++)
+	{
+		PageBufferManager policyBufMgr(frames, policies[p]);
+		if (p == 0)
+		{
+			// Allocating pages in a file...
+			for (int j = 0; j < n_pages; j++)
+			{
+				policyBufMgr.allocatePage(file14ptr, pages14[j], page);
+				sprintf((char *)tmpbuf, "test.14 Page %d %7.1f", pages14[j], (float)pages14[j]);
+				rids14[j] = page->insertRecord(tmpbuf);
+				policyBufMgr.unPinPage(file14ptr, pages14[j], true);
+			}
+		}
+		// Reading pages back with a skewed pattern: a hot set mixed with a scan
+		for (int round = 0; round < 200; round++)
+		{
+			const int j = (round % 3 == 0) ? (round / 3) % n_pages : round % 4;
+			policyBufMgr.readPage(file14ptr, pages14[j], page);
+			sprintf((char *)&tmpbuf, "test.14 Page %d %7.1f", pages14[j], (float)pages14[j]);
+			if (strncmp(page->getRecord(rids14[j]).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			policyBufMgr.unPinPage(file14ptr, pages14[j], false);
+		}
+		// Pinning as many pages as there are frames leaves nothing to evict
+		for (std::uint32_t j = 0; j < frames; j++)
+		{
+			policyBufMgr.readPage(file14ptr, pages14[j], page);
+		}
+		try
+		{
+			policyBufMgr.readPage(file14ptr, pages14[frames], page);
+			PRINT_ERROR("ERROR :: No more frames left for allocation. Exception should have been thrown before execution reaches this point.");
+		}
+		catch (BufferExceededException &e)
+		{
+		}
+		for (std::uint32_t j = 0; j < frames; j++)
+		{
+			policyBufMgr.unPinPage(file14ptr, pages14[j], false);
+		}
+		policyBufMgr.flushFile(file14ptr);
+	}
+	std::cout << "Test 14 passed"
+			  << "\n";
+}
+
+void test15()
+{
+	// 15. Test description: Pages read with a scan or one-shot hint recycle a small ring
+	// of frames and leave the rest of the pool alone
+	const std::uint32_t frames = 40;
+	const int hot_pages = 10;
+	const int n_pages = 100;
+	std::vector<PageId> pages15(n_pages);
+	std::vector<RecordId> rids15(n_pages);
+	PageBufferManager scanBufMgr(frames);
+	// Allocating pages in a file...
+	for (int j = 0; j < n_pages; j++)
+	{
+		scanBufMgr.allocatePage(file15ptr, pages15[j], page);
+		sprintf((char *)tmpbuf, "test.15 Page %d %7.1f", pages15[j], (float)pages15[j]);
+		rids15[j] = page->insertRecord(tmpbuf);
+		scanBufMgr.unPinPage(file15ptr, pages15[j], true);
+	}
+	scanBufMgr.flushFile(file15ptr);
+
+	// Loading the hot set normally
+	for (int j = 0; j < hot_pages; j++)
+	{
+		scanBufMgr.readPage(file15ptr, pages15[j], page);
+		scanBufMgr.unPinPage(file15ptr, pages15[j], false);
+	}
+	// Scanning the whole file twice, then reading every page once more as one-shot reads
+	const AccessHint hints[] = {AccessHint::SEQUENTIAL_SCAN, AccessHint::SEQUENTIAL_SCAN, AccessHint::ONE_SHOT};
+	for (int pass = 0; pass < 3; pass++)
+	{
+		for (int j = 0; j < n_pages; j++)
+		{
+			scanBufMgr.readPage(file15ptr, pages15[j], page, hints[pass]);
+			sprintf((char *)&tmpbuf, "test.15 Page %d %7.1f", pages15[j], (float)pages15[j]);
+			if (strncmp(page->getRecord(rids15[j]).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			scanBufMgr.unPinPage(file15ptr, pages15[j], false);
+		}
+	}
+	// The hot set must still be resident
+	scanBufMgr.clearBufStats();
+	for (int j = 0; j < hot_pages; j++)
+	{
+		scanBufMgr.readPage(file15ptr, pages15[j], page);
+		scanBufMgr.unPinPage(file15ptr, pages15[j], false);
+	}
+	if (scanBufMgr.getBufStats().diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: Scan evicted pages of the hot set");
+	}
+
+	// A page pinned by a scan is not recycled; a ring holding only pinned pages falls back
+	// to the replacement policy
+	for (int j = hot_pages; j < 2 * hot_pages; j++)
+	{
+		scanBufMgr.readPage(file15ptr, pages15[j], page, AccessHint::ONE_SHOT);
+	}
+	for (int j = hot_pages; j < 2 * hot_pages; j++)
+	{
+		scanBufMgr.unPinPage(file15ptr, pages15[j], false);
+	}
+	scanBufMgr.flushFile(file15ptr);
+	std::cout << "Test 15 passed"
+			  << "\n";
+}
+
+void test16()
+{
+	// 16. Test description: Pages prefetched explicitly or read ahead of a sequential
+	// reader are buffered before they are read
+	const std::uint32_t frames = 40;
+	const int n_pages = 30;
+	std::vector<PageId> pages16(n_pages);
+	std::vector<RecordId> rids16(n_pages);
+	PageBufferManager prefetchBufMgr(frames);
+	// Allocating pages in a file...
+	for (int j = 0; j < n_pages; j++)
+	{
+		prefetchBufMgr.allocatePage(file16ptr, pages16[j], page);
+		sprintf((char *)tmpbuf, "test.16 Page %d %7.1f", pages16[j], (float)pages16[j]);
+		rids16[j] = page->insertRecord(tmpbuf);
+		prefetchBufMgr.unPinPage(file16ptr, pages16[j], true);
+	}
+	prefetchBufMgr.flushFile(file16ptr);
+
+	// Prefetching the first ten pages, plus page numbers past the end of the file which
+	// are ignored
+	prefetchBufMgr.clearBufStats();
+	prefetchBufMgr.prefetch(file16ptr, pages16[0], 10);
+	prefetchBufMgr.prefetch(file16ptr, pages16[n_pages - 1] + 1, 5);
+	for (int wait = 0; wait < 5000 && prefetchBufMgr.getBufStats().prefetches < 10; wait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	prefetchBufMgr.clearBufStats();
+	for (int j = 0; j < 10; j++)
+	{
+		prefetchBufMgr.readPage(file16ptr, pages16[j], page);
+		sprintf((char *)&tmpbuf, "test.16 Page %d %7.1f", pages16[j], (float)pages16[j]);
+		if (strncmp(page->getRecord(rids16[j]).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		prefetchBufMgr.unPinPage(file16ptr, pages16[j], false);
+	}
+	if (prefetchBufMgr.getBufStats().diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: Prefetched pages were read again");
+	}
+
+	// Reading two consecutive pages starts read-ahead of the following ones
+	prefetchBufMgr.setReadAhead(8);
+	prefetchBufMgr.clearBufStats();
+	prefetchBufMgr.readPage(file16ptr, pages16[10], page);
+	prefetchBufMgr.unPinPage(file16ptr, pages16[10], false);
+	prefetchBufMgr.readPage(file16ptr, pages16[11], page);
+	prefetchBufMgr.unPinPage(file16ptr, pages16[11], false);
+	for (int wait = 0; wait < 5000 && prefetchBufMgr.getBufStats().prefetches < 8; wait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	// Disabling read-ahead so that the reads below queue no more pages
+	prefetchBufMgr.setReadAhead(0);
+	prefetchBufMgr.clearBufStats();
+	for (int j = 12; j < 20; j++)
+	{
+		prefetchBufMgr.readPage(file16ptr, pages16[j], page);
+		prefetchBufMgr.unPinPage(file16ptr, pages16[j], false);
+	}
+	if (prefetchBufMgr.getBufStats().diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: Sequential reads were not read ahead");
+	}
+
+	// Flushing cancels read-ahead still queued for the file
+	prefetchBufMgr.prefetch(file16ptr, pages16[0], n_pages);
+	prefetchBufMgr.flushFile(file16ptr);
+	std::cout << "Test 16 passed"
+			  << "\n";
+}
+
+void test17()
+{
+	// 17. Test description: The background writer cleans pages before they are evicted,
+	// with every replacement policy
+	const ReplacementPolicyType policies[] = {ReplacementPolicyType::CLOCK, ReplacementPolicyType::LRU_K,
+											  ReplacementPolicyType::TWO_Q, ReplacementPolicyType::ARC,
+											  ReplacementPolicyType::CLOCK_PRO};
+	const std::uint32_t frames = 20;
+	std::vector<PageId> pages17(2 * frames);
+	std::vector<RecordId> rids17(frames);
+	for (int p = 0; p < 5; p++)
+	{
+		PageBufferManager writerBufMgr(frames, policies[p]);
+		// Filling the pool with dirty pages
+		for (std::uint32_t j = 0; j < frames; j++)
+		{
+			writerBufMgr.allocatePage(file17ptr, pages17[j], page);
+			sprintf((char *)tmpbuf, "test.17 Page %d %7.1f", pages17[j], (float)pages17[j]);
+			rids17[j] = page->insertRecord(tmpbuf);
+			writerBufMgr.unPinPage(file17ptr, pages17[j], true);
+		}
+		writerBufMgr.clearBufStats();
+		BackgroundWriterConfig config;
+		config.maxDirtyFraction = 0;
+		config.pagesPerRound = 4;
+		config.intervalMs = 1;
+		writerBufMgr.startBackgroundWriter(config);
+		for (int wait = 0; wait < 5000 && writerBufMgr.countDirtyPages() > 0; wait++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		writerBufMgr.stopBackgroundWriter();
+		if (writerBufMgr.countDirtyPages() != 0 || writerBufMgr.getBufStats().backgroundwrites != (int)frames)
+		{
+			PRINT_ERROR("ERROR :: Background writer did not write every dirty page once");
+		}
+
+		// Evicting the cleaned pages needs no writes
+		for (std::uint32_t j = frames; j < 2 * frames; j++)
+		{
+			writerBufMgr.allocatePage(file17ptr, pages17[j], page);
+			writerBufMgr.unPinPage(file17ptr, pages17[j], false);
+		}
+		if (writerBufMgr.getBufStats().foregroundwrites != 0)
+		{
+			PRINT_ERROR("ERROR :: Eviction wrote pages the background writer had cleaned");
+		}
+
+		// The pages written in the background are intact on disk
+		writerBufMgr.flushFile(file17ptr);
+		for (std::uint32_t j = 0; j < frames; j++)
+		{
+			writerBufMgr.readPage(file17ptr, pages17[j], page);
+			sprintf((char *)&tmpbuf, "test.17 Page %d %7.1f", pages17[j], (float)pages17[j]);
+			if (strncmp(page->getRecord(rids17[j]).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			writerBufMgr.unPinPage(file17ptr, pages17[j], false);
+		}
+		writerBufMgr.flushFile(file17ptr);
+	}
+	std::cout << "Test 17 passed"
+			  << "\n";
+}
+
+void test18()
+{
+	// 18. Test description: Reading and writing several pages of a file at once, including
+	// runs of consecutive pages, pages out of order and repeated pages
+	const int n_pages = 12;
+	std::vector<PageId> pages18(n_pages);
+	std::vector<RecordId> rids18(n_pages);
+	std::vector<Page> written18(n_pages);
+	std::vector<const Page *> toWrite;
+	for (int j = 0; j < n_pages; j++)
+	{
+		written18[j] = file18ptr->allocatePage();
+		pages18[j] = written18[j].page_number();
+	}
+	// Writing all pages but the fifth, last pages first
+	for (int j = n_pages - 1; j >= 0; j--)
+	{
+		sprintf((char *)tmpbuf, "test.18 Page %d %7.1f", pages18[j], (float)pages18[j]);
+		rids18[j] = written18[j].insertRecord(tmpbuf);
+		if (j != 4)
+		{
+			toWrite.push_back(&written18[j]);
+		}
+	}
+	file18ptr->writePages(toWrite);
+	file18ptr->writePage(written18[4]);
+
+	std::vector<PageId> toRead;
+	for (int j = 0; j < n_pages; j++)
+	{
+		toRead.push_back(pages18[(j * 5) % n_pages]);
+	}
+	toRead.push_back(pages18[3]);
+	std::vector<Page> read18;
+	file18ptr->readPages(toRead, read18);
+	if (read18.size() != toRead.size())
+	{
+		PRINT_ERROR("ERROR :: Wrong number of pages read");
+	}
+	for (std::size_t i = 0; i < toRead.size(); i++)
+	{
+		const int j = std::find(pages18.begin(), pages18.end(), toRead[i]) - pages18.begin();
+		sprintf((char *)&tmpbuf, "test.18 Page %d %7.1f", pages18[j], (float)pages18[j]);
+		if (read18[i].page_number() != toRead[i] ||
+			strncmp(read18[i].getRecord(rids18[j]).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	// The used page list is left intact by writes of stale page copies
+	int used = 0;
+	for (FileIterator iter = file18ptr->begin(); iter != file18ptr->end(); ++iter)
+	{
+		used++;
+	}
+	if (used != n_pages)
+	{
+		PRINT_ERROR("ERROR :: Page list damaged by writePages");
+	}
+
+	// Pages past the end of the file or deleted cannot be read, and deleted pages not written
+	try
+	{
+		toRead.push_back(pages18[n_pages - 1] + 1);
+		file18ptr->readPages(toRead, read18);
+		PRINT_ERROR("ERROR :: Page is invalid. Exception should have been thrown before execution reaches this point.");
+	}
+	catch (InvalidPageException &e)
+	{
+	}
+	file18ptr->deletePage(pages18[7]);
+	try
+	{
+		// read18 still holds the pages read before, the deleted one among them
+		toRead.assign(1, pages18[7]);
+		file18ptr->readPages(toRead, read18);
+		PRINT_ERROR("ERROR :: Page is deleted. Exception should have been thrown before execution reaches this point.");
+	}
+	catch (InvalidPageException &e)
+	{
+	}
+	try
+	{
+		file18ptr->writePages(toWrite);
+		PRINT_ERROR("ERROR :: Page is deleted. Exception should have been thrown before execution reaches this point.");
+	}
+	catch (InvalidPageException &e)
+	{
+	}
+	std::cout << "Test 18 passed"
+			  << "\n";
+}
+
+void test19()
+{
+	// 19. Test description: Several threads read different pages of the same file at once
+	const int n_pages = 64;
+	const int n_threads = 4;
+	std::vector<PageId> pages19(n_pages);
+	std::vector<RecordId> rids19(n_pages);
+	for (int j = 0; j < n_pages; j++)
+	{
+		Page new_page = file19ptr->allocatePage();
+		pages19[j] = new_page.page_number();
+		sprintf((char *)tmpbuf, "test.19 Page %d %7.1f", pages19[j], (float)pages19[j]);
+		rids19[j] = new_page.insertRecord(tmpbuf);
+		file19ptr->writePage(new_page);
+	}
+	std::atomic<int> mismatches(0);
+	std::vector<std::thread> readers;
+	for (int t = 0; t < n_threads; t++)
+	{
+		readers.push_back(std::thread([&, t]()
+									  {
+			char expected[100];
+			for (int round = 0; round < 50; round++)
+			{
+				for (int j = t; j < n_pages; j += n_threads)
+				{
+					Page read_page = file19ptr->readPage(pages19[j]);
+					sprintf(expected, "test.19 Page %d %7.1f", pages19[j], (float)pages19[j]);
+					if (read_page.page_number() != pages19[j] ||
+						strncmp(read_page.getRecord(rids19[j]).c_str(), expected, strlen(expected)) != 0)
+					{
+						mismatches++;
+					}
+				}
+			} }));
+	}
+	for (int t = 0; t < n_threads; t++)
+	{
+		readers[t].join();
+	}
+	if (mismatches != 0)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	std::cout << "Test 19 passed"
+			  << "\n";
+}
+
+void test20()
+{
+	// 20. Test description: Many reads in flight at once, on both I/O engines and through the buffer pool
+	const int n_pages = 48;
+	std::vector<PageId> pages20(n_pages);
+	std::vector<RecordId> rids20(n_pages);
+	char expected[100];
+	for (int j = 0; j < n_pages; j++)
+	{
+		Page new_page = file20ptr->allocatePage();
+		pages20[j] = new_page.page_number();
+		sprintf((char *)tmpbuf, "test.20 Page %d %7.1f", pages20[j], (float)pages20[j]);
+		rids20[j] = new_page.insertRecord(tmpbuf);
+		file20ptr->writePage(new_page);
+	}
+
+	const IoEngineType types[] = {IoEngineType::AUTO, IoEngineType::THREAD_POOL};
+	for (int e = 0; e < 2; e++)
+	{
+		std::unique_ptr<IoEngine> engine(IoEngine::create(types[e], 8));
+		std::vector<Page> read20(n_pages);
+		std::atomic<int> completed(0), failed(0);
+		for (int j = 0; j < n_pages; j++)
+		{
+			file20ptr->readPageAsync(*engine, pages20[j], read20[j], [&](bool read)
+									 {
+				if (!read)
+				{
+					failed++;
+				}
+				completed++; });
+		}
+		// A read across the end of the file reports the bytes up to it; the rest comes back
+		// short, not as a failure
+		struct stat info;
+		stat("test.20", &info);
+		const int fd = open("test.20", O_RDONLY);
+		char tail[2][100];
+		struct iovec iov[2] = {{tail[0], sizeof(tail[0])}, {tail[1], sizeof(tail[1])}};
+		std::atomic<ssize_t> tailRead(-1);
+		engine->submit(fd, iov, 2, info.st_size - 150, false, [&](ssize_t result)
+					   { tailRead = result; });
+		// Waits for every read still in flight
+		engine.reset();
+		close(fd);
+		if (completed != n_pages || failed != 0)
+		{
+			PRINT_ERROR("ERROR :: ASYNCHRONOUS READS DID NOT ALL COMPLETE");
+		}
+		if (tailRead != 150)
+		{
+			PRINT_ERROR("ERROR :: READ ACROSS THE END OF THE FILE NOT REPORTED");
+		}
+		for (int j = 0; j < n_pages; j++)
+		{
+			sprintf(expected, "test.20 Page %d %7.1f", pages20[j], (float)pages20[j]);
+			if (read20[j].page_number() != pages20[j] ||
+				strncmp(read20[j].getRecord(rids20[j]).c_str(), expected, strlen(expected)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+		}
+	}
+
+	// Misses through the buffer pool; the futures hand back pinned pages
+	std::vector<std::future<Page *>> futures;
+	for (int j = 0; j < n_pages; j++)
+	{
+		futures.push_back(bufMgr->readPageAsync(file20ptr, pages20[j]));
+	}
+	for (int j = 0; j < n_pages; j++)
+	{
+		Page *page = futures[j].get();
+		sprintf(expected, "test.20 Page %d %7.1f", pages20[j], (float)pages20[j]);
+		if (strncmp(page->getRecord(rids20[j]).c_str(), expected, strlen(expected)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+
+	// A hit is ready right away and pins the page a second time
+	std::future<Page *> hit = bufMgr->readPageAsync(file20ptr, pages20[0]);
+	if (hit.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		PRINT_ERROR("ERROR :: BUFFER HIT WAS NOT READY IMMEDIATELY");
+	}
+	hit.get();
+	bufMgr->unPinPage(file20ptr, pages20[0], false);
+	for (int j = 0; j < n_pages; j++)
+	{
+		bufMgr->unPinPage(file20ptr, pages20[j], false);
+	}
+
+	// Reading a deleted page fails through the future
+	file20ptr->deletePage(pages20[n_pages - 1]);
+	bufMgr->flushFile(file20ptr);
+	try
+	{
+		bufMgr->readPageAsync(file20ptr, pages20[n_pages - 1]).get();
+		PRINT_ERROR("ERROR :: Reading a deleted page should have thrown InvalidPageException.");
+	}
+	catch (const InvalidPageException &e)
+	{
+	}
+
+	std::cout << "Test 20 passed"
+			  << "\n";
+}
+
+void test21()
+{
+	// 21. Test description: Allocate and read pages into memory supplied by the caller
+	std::vector<char> memory(Page::SIZE);
+	Page frame(&memory[0]);
+	file21ptr->allocatePageInto(frame);
+	const PageId pageNo = frame.page_number();
+	sprintf((char *)tmpbuf, "test.21 Page %d %7.1f", pageNo, (float)pageNo);
+	const RecordId rid = frame.insertRecord(tmpbuf);
+	file21ptr->writePage(frame);
+
+	// The page read replaces whatever the frame held before, in the caller's memory
+	Page other = file21ptr->allocatePage();
+	file21ptr->writePage(other);
+	file21ptr->readPageInto(other.page_number(), frame);
+	if (frame.page_number() != other.page_number())
+	{
+		PRINT_ERROR("ERROR :: WRONG PAGE READ");
+	}
+	file21ptr->readPageInto(pageNo, frame);
+	if (frame.page_number() != pageNo ||
+		strncmp(frame.getRecord(rid).c_str(), tmpbuf, strlen(tmpbuf)) != 0 ||
+		reinterpret_cast<PageHeader *>(&memory[0])->current_page_number != pageNo)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+
+	// A freed page is allocated again into the frame, and pages past the end are refused
+	file21ptr->deletePage(other.page_number());
+	file21ptr->allocatePageInto(frame);
+	if (frame.page_number() != other.page_number() || frame.getFreeSpace() != Page::DATA_SIZE)
+	{
+		PRINT_ERROR("ERROR :: FREED PAGE NOT REUSED");
+	}
+	try
+	{
+		file21ptr->readPageInto(frame.page_number() + 1, frame);
+		PRINT_ERROR("ERROR :: Reading past the end of the file should have thrown InvalidPageException.");
+	}
+	catch (const InvalidPageException &e)
+	{
+	}
+
+	std::cout << "Test 21 passed"
+			  << "\n";
+}
+
+void test22()
+{
+	// 22. Test description: Buffer pools backed by each page size, falling back when huge pages are missing
+	const PoolPageSize sizes[] = {PoolPageSize::NORMAL, PoolPageSize::TRANSPARENT_HUGE, PoolPageSize::EXPLICIT_HUGE};
+	std::vector<PageId> pages22;
+	for (int s = 0; s < 3; s++)
+	{
+		PoolMemoryConfig config;
+		config.pageSize = sizes[s];
+		config.numaNode = 0;
+		PageBufferManager pool(num, ReplacementPolicyType::CLOCK, config);
+		// Nothing larger than asked for, and always something
+		if (pool.poolPageSize() > sizes[s])
+		{
+			PRINT_ERROR("ERROR :: POOL PAGE SIZE LARGER THAN ASKED FOR");
+		}
+		for (PageId i = 0; i < num; i++)
+		{
+			Page *page;
+			PageId pageNo;
+			if (s == 0)
+			{
+				pool.allocatePage(file22ptr, pageNo, page);
+				sprintf((char *)tmpbuf, "test.22 Page %d %7.1f", pageNo, (float)pageNo);
+				page->insertRecord(tmpbuf);
+				pool.unPinPage(file22ptr, pageNo, true);
+				pages22.push_back(pageNo);
+			}
+			else
+			{
+				pageNo = pages22[i];
+				pool.readPage(file22ptr, pageNo, page);
+				sprintf((char *)tmpbuf, "test.22 Page %d %7.1f", pageNo, (float)pageNo);
+				if (strncmp(page->getRecord({pageNo, 1}).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				pool.unPinPage(file22ptr, pageNo, false);
+			}
+		}
+		pool.flushFile(file22ptr);
+	}
+
+	// Binding to a node that does not exist leaves placement to the kernel
+	PoolMemoryConfig config;
+	config.numaNode = 1000;
+	PoolMemory memory(Page::SIZE, config);
+	if (memory.numaBound() || reinterpret_cast<std::uintptr_t>(memory.data()) % Page::ALIGNMENT != 0)
+	{
+		PRINT_ERROR("ERROR :: BAD POOL MEMORY");
+	}
+	memory.data()[Page::SIZE - 1] = 1;
+
+	std::cout << "Test 22 passed"
+			  << "\n";
+}
+
+void test23()
+{
+	// 23. Test description: The clock sweeps frame bitmaps a word at a time like a frame-at-a-time clock,
+	// with and without AVX2
+	const std::uint32_t frames = 300; // last word only partly used
+	for (int vectorized = 0; vectorized < 2; vectorized++)
+	{
+		FrameTable::setVectorized(vectorized);
+		FrameTable table(frames, PoolMemoryConfig());
+		std::unique_ptr<ReplacementPolicy> clock(ReplacementPolicy::create(ReplacementPolicyType::CLOCK, frames, &table));
+		// Frames holding no page are never victims; fill every frame from the free
+		// list, then unpin all of them
+		FrameId frame;
+		if (clock->pickVictim(frame))
+		{
+			PRINT_ERROR("ERROR :: VICTIM PICKED FROM AN EMPTY POOL");
+		}
+		for (std::uint32_t i = 0; i < frames; i++)
+		{
+			if (!table.popFree(frame) || frame != i)
+			{
+				PRINT_ERROR("ERROR :: FREE FRAMES NOT HANDED OUT IN ORDER");
+			}
+			table.set(frame, file23ptr, i + 1);
+			clock->recordInsert(frame, file23ptr, i + 1);
+		}
+		for (FrameId i = 0; i < frames; i++)
+		{
+			table.unpin(i);
+		}
+		if (table.countDirty() != 0 || table.popFree(frame))
+		{
+			PRINT_ERROR("ERROR :: DIRTY OR FREE FRAMES AFTER FILLING");
+		}
+
+		// Everything is referenced: one sweep clears all reference bits and comes back
+		// to where it started, while pinned frames keep theirs
+		table.pin(140);
+		FrameId victim;
+		clock->pickVictim(victim);
+		const FrameId first = victim;
+		for (FrameId i = 0; i < frames; i++)
+		{
+			if (table.isReferenced(i) != (i == 140))
+			{
+				PRINT_ERROR("ERROR :: SECOND CHANCE NOT GIVEN");
+			}
+		}
+
+		// The next victim is the first unreferenced unpinned frame at or after the hand,
+		// skipping referenced ones across words and wrapping around
+		table.reserve(first);
+		table.set(first, file23ptr, 1);
+		for (FrameId i = 0; i < frames; i++)
+		{
+			table.setReferenced(i, true);
+		}
+		const FrameId expected = (first + 270) % frames;
+		table.setReferenced(expected, false);
+		table.unpin(first);
+		clock->pickVictim(victim);
+		if (victim != expected || table.isReferenced((first + 269) % frames) || !table.isReferenced((first + 271) % frames))
+		{
+			PRINT_ERROR("ERROR :: WRONG VICTIM");
+		}
+
+		// With every frame pinned there is no victim
+		for (FrameId i = 0; i < frames; i++)
+		{
+			if (table.pinCount(i) == 0)
+				table.pin(i);
+		}
+		if (clock->pickVictim(victim))
+		{
+			PRINT_ERROR("ERROR :: VICTIM PICKED WHILE ALL FRAMES ARE PINNED");
+		}
+	}
+	FrameTable::setVectorized(true);
+
+	std::cout << "Test 23 passed"
+			  << "\n";
+}
+
+void test24()
+{
+	// 24. Test description: Frames freed by flushFile and disposePage are reused through the free
+	// list before any resident page is evicted, also with several threads
+	const std::string &otherName = "test.24b";
+	try
+	{
+		File::remove(otherName);
+	}
+	catch (FileNotFoundException &e)
+	{
+	}
+	{
+		File other = File::create(otherName);
+		PageBufferManager pool(num, ReplacementPolicyType::CLOCK);
+		Page *page;
+		PageId pageNo;
+		std::vector<PageId> kept;
+		for (PageId i = 0; i < num; i++)
+		{
+			File *file = i % 2 == 0 ? file24ptr : &other;
+			pool.allocatePage(file, pageNo, page);
+			pool.unPinPage(file, pageNo, true);
+			if (file == &other)
+				kept.push_back(pageNo);
+		}
+		pool.flushFile(file24ptr);
+
+		// Half of the pool is free again: new pages go there, and every page kept stays
+		pool.clearBufStats();
+		for (PageId i = 0; i < num / 2; i++)
+		{
+			pool.allocatePage(&other, pageNo, page);
+			pool.unPinPage(&other, pageNo, true);
+		}
+		const int written = pool.getBufStats().diskwrites;
+		pool.clearBufStats();
+		for (std::size_t i = 0; i < kept.size(); i++)
+		{
+			pool.readPage(&other, kept[i], page);
+			pool.unPinPage(&other, kept[i], false);
+		}
+		if (written != 0 || pool.getBufStats().diskreads != 0)
+		{
+			PRINT_ERROR("ERROR :: PAGE EVICTED WHILE FRAMES WERE FREE");
+		}
+
+		// A disposed page's frame is taken before a dirty page is evicted
+		pool.disposePage(&other, kept[0]);
+		pool.allocatePage(&other, pageNo, page);
+		pool.unPinPage(&other, pageNo, true);
+		if (pool.getBufStats().diskwrites != 0)
+		{
+			PRINT_ERROR("ERROR :: DISPOSED FRAME NOT REUSED");
+		}
+		pool.flushFile(&other);
+
+		// Threads taking and giving back frames concurrently lose none of them
+		std::vector<std::thread> workers;
+		for (int t = 0; t < 4; t++)
+		{
+			workers.push_back(std::thread([&pool]()
+										  {
+				for (int round = 0; round < 200; round++)
+				{
+					Page *taken;
+					PageId takenNo;
+					pool.allocatePage(file24ptr, takenNo, taken);
+					pool.unPinPage(file24ptr, takenNo, false);
+					pool.disposePage(file24ptr, takenNo);
+				} }));
+		}
+		for (std::size_t t = 0; t < workers.size(); t++)
+		{
+			workers[t].join();
+		}
+		pool.clearBufStats();
+		std::vector<PageId> pinned;
+		for (PageId i = 0; i < num; i++)
+		{
+			pool.allocatePage(&other, pageNo, page);
+			pinned.push_back(pageNo);
+		}
+		if (pool.getBufStats().diskwrites != 0)
+		{
+			PRINT_ERROR("ERROR :: FREE FRAMES LOST");
+		}
+		for (std::size_t i = 0; i < pinned.size(); i++)
+		{
+			pool.unPinPage(&other, pinned[i], false);
+		}
+		pool.flushFile(&other);
+	}
+	File::remove(otherName);
+
+	std::cout << "Test 24 passed"
+			  << "\n";
+}
+
+void test25()
+{
+	// 25. Test description: evictFile drops the pages of one file, dirty ones unwritten, and leaves
+	// the pages of other files alone
+	PageBufferManager pool(num, ReplacementPolicyType::CLOCK);
+	Page *page;
+	std::vector<PageId> pages25, pages24;
+	for (PageId i = 0; i < 10; i++)
+	{
+		PageId pageNo;
+		pool.allocatePage(file25ptr, pageNo, page);
+		page->insertRecord("test.25 first record");
+		pool.unPinPage(file25ptr, pageNo, true);
+		pages25.push_back(pageNo);
+		pool.allocatePage(file24ptr, pageNo, page);
+		pool.unPinPage(file24ptr, pageNo, true);
+		pages24.push_back(pageNo);
+	}
+	pool.flushFile(file25ptr);
+
+	// Changes since the flush are dropped
+	for (std::size_t i = 0; i < pages25.size(); i++)
+	{
+		pool.readPage(file25ptr, pages25[i], page);
+		page->insertRecord("test.25 second record");
+		pool.unPinPage(file25ptr, pages25[i], true);
+	}
+	pool.readPage(file25ptr, pages25[3], page);
+	try
+	{
+		pool.evictFile(file25ptr);
+		PRINT_ERROR("ERROR :: Page pinned for file being evicted. Exception should have been thrown before execution reaches this point.");
+	}
+	catch (PagePinnedException &e)
+	{
+	}
+	pool.unPinPage(file25ptr, pages25[3], false);
+	pool.clearBufStats();
+	pool.evictFile(file25ptr);
+	if (pool.getBufStats().diskwrites != 0)
+	{
+		PRINT_ERROR("ERROR :: DIRTY PAGES WRITTEN BY EVICTFILE");
+	}
+	for (std::size_t i = 0; i < pages25.size(); i++)
+	{
+		pool.readPage(file25ptr, pages25[i], page);
+		int records = 0;
+		for (PageIterator it = page->begin(); it != page->end(); ++it)
+		{
+			records++;
+		}
+		if (records != 1)
+		{
+			PRINT_ERROR("ERROR :: EVICTED CHANGES WERE KEPT");
+		}
+		pool.unPinPage(file25ptr, pages25[i], false);
+	}
+
+	// The other file's pages stayed in the pool
+	pool.clearBufStats();
+	for (std::size_t i = 0; i < pages24.size(); i++)
+	{
+		pool.readPage(file24ptr, pages24[i], page);
+		pool.unPinPage(file24ptr, pages24[i], false);
+	}
+	if (pool.getBufStats().diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: PAGES OF ANOTHER FILE EVICTED");
+	}
+	pool.flushFile(file24ptr);
+	pool.evictFile(file25ptr);
+	pool.evictFile(file25ptr);
+
+	std::cout << "Test 25 passed"
+			  << "\n";
+}
+
+void test26()
+{
+	// 26. Test description: Checkpoints write dirty pages and keep them, skipping or waiting for
+	// pinned ones, while other threads keep changing pages
+	PageBufferManager pool(num, ReplacementPolicyType::CLOCK);
+	Page *page;
+	std::vector<PageId> pages26;
+	for (PageId i = 0; i < 20; i++)
+	{
+		PageId pageNo;
+		pool.allocatePage(file26ptr, pageNo, page);
+		page->insertRecord("test.26 record");
+		pool.unPinPage(file26ptr, pageNo, true);
+		pages26.push_back(pageNo);
+	}
+
+	FlushOptions checkpoint;
+	checkpoint.mode = FlushMode::CHECKPOINT;
+	checkpoint.pinned = PinnedPageAction::SKIP;
+	pool.readPage(file26ptr, pages26[5], page);
+	FlushSummary summary = pool.flushFile(file26ptr, checkpoint);
+	if (summary.pagesWritten != 19 || summary.pagesSkipped != 1 || summary.bytesWritten != 19 * Page::SIZE ||
+		pool.countDirtyPages() != 1)
+	{
+		PRINT_ERROR("ERROR :: WRONG CHECKPOINT SUMMARY");
+	}
+	if (file26ptr->readPage(pages26[0]).begin() == file26ptr->readPage(pages26[0]).end())
+	{
+		PRINT_ERROR("ERROR :: CHECKPOINTED PAGE NOT ON DISK");
+	}
+
+	// The pages stayed in the pool
+	pool.clearBufStats();
+	for (std::size_t i = 0; i < pages26.size(); i++)
+	{
+		Page *again;
+		pool.readPage(file26ptr, pages26[i], again);
+		pool.unPinPage(file26ptr, pages26[i], false);
+	}
+	if (pool.getBufStats().diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: CHECKPOINT EVICTED PAGES");
+	}
+
+	checkpoint.pinned = PinnedPageAction::THROW;
+	try
+	{
+		pool.flushFile(file26ptr, checkpoint);
+		PRINT_ERROR("ERROR :: Page pinned for file being checkpointed. Exception should have been thrown before execution reaches this point.");
+	}
+	catch (PagePinnedException &e)
+	{
+	}
+
+	// Waiting for the pinned page to be released
+	checkpoint.pinned = PinnedPageAction::WAIT;
+	std::thread unpinner([&pool, &pages26]()
+						 {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		pool.unPinPage(file26ptr, pages26[5], false); });
+	summary = pool.flushFile(file26ptr, checkpoint);
+	unpinner.join();
+	if (summary.pagesWritten != 1 || summary.pagesSkipped != 0 || pool.countDirtyPages() != 0)
+	{
+		PRINT_ERROR("ERROR :: PINNED PAGE NOT WAITED FOR");
+	}
+
+	// A page the caller pinned itself is given up on after the timeout
+	checkpoint.waitTimeoutMs = 20;
+	pool.readPage(file26ptr, pages26[5], page);
+	try
+	{
+		pool.flushFile(file26ptr, checkpoint);
+		PRINT_ERROR("ERROR :: Page pinned by the caller. Exception should have been thrown before execution reaches this point.");
+	}
+	catch (PagePinnedException &e)
+	{
+	}
+	pool.unPinPage(file26ptr, pages26[5], false);
+
+	// Without a timeout, WAIT skips the pinned pages at once
+	checkpoint.waitTimeoutMs = 0;
+	pool.readPage(file26ptr, pages26[5], page);
+	pool.unPinPage(file26ptr, pages26[5], true);
+	pool.readPage(file26ptr, pages26[5], page);
+	summary = pool.flushFile(file26ptr, checkpoint);
+	if (summary.pagesWritten != 0 || summary.pagesSkipped != 1 || pool.countDirtyPages() != 1)
+	{
+		PRINT_ERROR("ERROR :: PINNED PAGE WAITED FOR WITHOUT A TIMEOUT");
+	}
+	pool.unPinPage(file26ptr, pages26[5], false);
+	checkpoint.waitTimeoutMs = 1000;
+	pool.flushFile(file26ptr, checkpoint);
+
+	// Checkpoints while another thread adds records lose none of them
+	std::thread writer([&pool, &pages26]()
+					   {
+		for (int round = 0; round < 10; round++)
+		{
+			for (std::size_t i = 0; i < pages26.size(); i++)
+			{
+				Page *changed;
+				pool.readPage(file26ptr, pages26[i], changed);
+				changed->insertRecord("test.26 later record");
+				pool.unPinPage(file26ptr, pages26[i], true);
+			}
+		} });
+	for (int round = 0; round < 20; round++)
+	{
+		pool.flushFile(file26ptr, checkpoint);
+	}
+	writer.join();
+	pool.flushFile(file26ptr, checkpoint);
+
+	// Evicting around a pinned page, then everything
+	FlushOptions evict;
+	evict.pinned = PinnedPageAction::SKIP;
+	pool.readPage(file26ptr, pages26[3], page);
+	summary = pool.flushFile(file26ptr, evict);
+	if (summary.pagesSkipped != 1 || pool.countDirtyPages() != 0)
+	{
+		PRINT_ERROR("ERROR :: PINNED PAGE NOT SKIPPED");
+	}
+	pool.unPinPage(file26ptr, pages26[3], false);
+	pool.flushFile(file26ptr);
+	for (std::size_t i = 0; i < pages26.size(); i++)
+	{
+		Page onDisk = file26ptr->readPage(pages26[i]);
+		int records = 0;
+		for (PageIterator it = onDisk.begin(); it != onDisk.end(); ++it)
+		{
+			records++;
+		}
+		if (records != 11)
+		{
+			PRINT_ERROR("ERROR :: RECORDS LOST BY CHECKPOINTS");
+		}
+	}
+
+	std::cout << "Test 26 passed"
+			  << "\n";
+}
+
+void test27()
+{
+	// 27. Test description: Dirty pages of several files interleaved in the pool are all written when
+	// the buffer manager is destroyed
+	File *files27[3] = {file27ptr, file26ptr, file25ptr};
+	std::vector<PageId> pages27[3];
+	{
+		PageBufferManager pool(num, ReplacementPolicyType::CLOCK);
+		for (PageId i = 0; i < 30; i++)
+		{
+			for (int f = 0; f < 3; f++)
+			{
+				Page *page;
+				PageId pageNo;
+				pool.allocatePage(files27[f], pageNo, page);
+				sprintf((char *)tmpbuf, "test.27 file %d page %d", f, pageNo);
+				page->insertRecord(tmpbuf);
+				pool.unPinPage(files27[f], pageNo, true);
+				pages27[f].push_back(pageNo);
+			}
+		}
+	}
+	for (int f = 0; f < 3; f++)
+	{
+		for (std::size_t i = 0; i < pages27[f].size(); i++)
+		{
+			Page onDisk = files27[f]->readPage(pages27[f][i]);
+			sprintf((char *)tmpbuf, "test.27 file %d page %d", f, pages27[f][i]);
+			if (onDisk.begin() == onDisk.end() || *onDisk.begin() != tmpbuf)
+			{
+				PRINT_ERROR("ERROR :: PAGE NOT WRITTEN AT SHUTDOWN");
+			}
+		}
+	}
+
+	std::cout << "Test 27 passed"
+			  << "\n";
+}
+
+void test28()
+{
+	// 28. Test description: Writing dirty pages back reads nothing, and the page lists stay linked
+	// when stale copies of pages are written
+	std::vector<PageId> pages28;
+	{
+		PageBufferManager pool(num, ReplacementPolicyType::CLOCK);
+		for (PageId i = 0; i < 20; i++)
+		{
+			Page *page;
+			PageId pageNo;
+			pool.allocatePage(file28ptr, pageNo, page);
+			pool.unPinPage(file28ptr, pageNo, true);
+			pages28.push_back(pageNo);
+		}
+		pool.flushFile(file28ptr);
+		pool.clearBufStats();
+		for (std::size_t i = 0; i < pages28.size(); i++)
+		{
+			Page *page;
+			pool.readPage(file28ptr, pages28[i], page);
+			sprintf((char *)tmpbuf, "test.28 page %d", pages28[i]);
+			page->insertRecord(tmpbuf);
+			pool.unPinPage(file28ptr, pages28[i], true);
+		}
+		const int reads = pool.getBufStats().diskreads;
+		pool.flushFile(file28ptr);
+		if (reads != (int)pages28.size() || pool.getBufStats().diskreads != reads ||
+			pool.getBufStats().diskwrites != (int)pages28.size())
+		{
+			PRINT_ERROR("ERROR :: FLUSH READ PAGES OR DID NOT WRITE EACH DIRTY PAGE ONCE");
+		}
+	}
+
+	// The tail page gets a successor on disk after its stale copy was read
+	Page staleTail = file28ptr->readPage(pages28.back());
+	file28ptr->allocatePage();
+	file28ptr->writePage(staleTail);
+	std::size_t linked = 0;
+	for (FileIterator iter = file28ptr->begin(); iter != file28ptr->end(); ++iter)
+	{
+		linked++;
+	}
+	if (linked != pages28.size() + 1)
+	{
+		PRINT_ERROR("ERROR :: STALE PAGE WRITE BROKE THE USED LIST");
+	}
+
+	// A page deleted through another File object for the same file cannot be written
+	Page deleted = file28ptr->readPage(pages28[3]);
+	{
+		File other(*file28ptr);
+		other.deletePage(pages28[3]);
+	}
+	try
+	{
+		file28ptr->writePage(deleted);
+		PRINT_ERROR("ERROR :: DELETED PAGE WRITTEN");
+	}
+	catch (InvalidPageException &e)
+	{
+	}
+
+	// The linkage read when a file is opened again matches what was kept in memory
+	const std::string reopened = "test.28.reopened";
+	std::vector<PageId> before, after;
+	{
+		File file = File::create(reopened);
+		for (int i = 0; i < 10; i++)
+		{
+			file.allocatePage();
+		}
+		file.deletePage(4);
+		file.deletePage(7);
+		file.allocatePage();
+		for (FileIterator iter = file.begin(); iter != file.end(); ++iter)
+		{
+			before.push_back((*iter).page_number());
+		}
+	}
+	{
+		File file = File::open(reopened);
+		for (FileIterator iter = file.begin(); iter != file.end(); ++iter)
+		{
+			after.push_back((*iter).page_number());
+		}
+		Page page = file.readPage(before.back());
+		file.writePage(page);
+	}
+	File::remove(reopened);
+	if (before != after || after.size() != 9)
+	{
+		PRINT_ERROR("ERROR :: PAGE LINKAGE READ ON OPEN DIFFERS");
+	}
+
+	std::cout << "Test 28 passed"
+			  << "\n";
+}
+
+/**
+ * Reads the file header as stored on disk, bypassing File
+ */
+static FileHeader headerOnDisk(const std::string &filename)
+{
+	FileHeader header = {0, 0, 0, 0};
+	std::ifstream stream(filename.c_str(), std::ifstream::binary);
+	stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+	return header;
+}
+
+void test29()
+{
+	// 29. Test description: The file header is kept in memory: page reads do not consult the header
+	// on disk, and changes reach the disk on sync
+	std::vector<PageId> pages29;
+	PageBufferManager pool(num, ReplacementPolicyType::CLOCK);
+	for (int i = 0; i < 5; i++)
+	{
+		Page *page;
+		PageId pageNo;
+		pool.allocatePage(file29ptr, pageNo, page);
+		pool.unPinPage(file29ptr, pageNo, true);
+		pages29.push_back(pageNo);
+	}
+	pool.flushFile(file29ptr);
+	file29ptr->sync();
+	if (headerOnDisk(file29ptr->filename()).num_pages != pages29.back() + 1)
+	{
+		PRINT_ERROR("ERROR :: FILE HEADER NOT WRITTEN ON SYNC");
+	}
+
+	// Zero the header on disk; the pages can still be read and allocated
+	{
+		const FileHeader zero = {0, 0, 0, 0};
+		std::fstream stream(file29ptr->filename().c_str(), std::fstream::in | std::fstream::out | std::fstream::binary);
+		stream.write(reinterpret_cast<const char *>(&zero), sizeof(zero));
+	}
+	pool.clearBufStats();
+	for (std::size_t i = 0; i < pages29.size(); i++)
+	{
+		Page *page;
+		pool.readPage(file29ptr, pages29[i], page);
+		pool.unPinPage(file29ptr, pages29[i], false);
+	}
+	if (pool.getBufStats().diskreads != (int)pages29.size())
+	{
+		PRINT_ERROR("ERROR :: WRONG NUMBER OF DISK READS");
+	}
+	Page *page;
+	PageId pageNo;
+	pool.allocatePage(file29ptr, pageNo, page);
+	pool.unPinPage(file29ptr, pageNo, true);
+	if (pageNo != pages29.back() + 1)
+	{
+		PRINT_ERROR("ERROR :: PAGE ALLOCATED FROM THE HEADER ON DISK");
+	}
+	pool.flushFile(file29ptr);
+	file29ptr->sync();
+	const FileHeader header = headerOnDisk(file29ptr->filename());
+	if (header.num_pages != pageNo + 1 || header.first_used_page != pages29.front())
+	{
+		PRINT_ERROR("ERROR :: FILE HEADER NOT WRITTEN BACK");
+	}
+
+	std::cout << "Test 29 passed"
+			  << "\n";
+}
+
+/**
+ * Returns true if the used pages of the file, in iteration order, are exactly the given ones and
+ * each one's next page number on disk names the one after it
+ */
+static bool usedListIs(File *file, const std::vector<PageId> &expected)
+{
+	std::vector<PageId> listed;
+	for (FileIterator iter = file->begin(); iter != file->end(); ++iter)
+	{
+		listed.push_back((*iter).page_number());
+	}
+	if (listed != expected)
+	{
+		return false;
+	}
+	for (std::size_t i = 0; i < listed.size(); i++)
+	{
+		const PageId next = i + 1 < listed.size() ? listed[i + 1] : Page::INVALID_NUMBER;
+		if (file->readPage(listed[i]).next_page_number() != next)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void test30()
+{
+	// 30. Test description: Pages are allocated from the allocation map, lowest free page first, and
+	// the used list on disk stays in page number order through deletions and reuse
+	std::vector<PageId> used30;
+	for (int i = 0; i < 10; i++)
+	{
+		used30.push_back(file30ptr->allocatePage().page_number());
+	}
+	file30ptr->deletePage(used30[6]);
+	file30ptr->deletePage(used30[2]);
+	file30ptr->deletePage(used30[0]);
+	file30ptr->deletePage(used30[4]);
+	const PageId deleted[4] = {used30[0], used30[2], used30[4], used30[6]};
+	const std::vector<PageId> remaining = {used30[1], used30[3], used30[5], used30[7], used30[8], used30[9]};
+	if (!usedListIs(file30ptr, remaining))
+	{
+		PRINT_ERROR("ERROR :: USED LIST WRONG AFTER DELETIONS");
+	}
+	try
+	{
+		file30ptr->deletePage(used30[2]);
+		PRINT_ERROR("ERROR :: FREE PAGE DELETED");
+	}
+	catch (InvalidPageException &e)
+	{
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (file30ptr->allocatePage().page_number() != deleted[i])
+		{
+			PRINT_ERROR("ERROR :: LOWEST FREE PAGE NOT REUSED");
+		}
+	}
+	used30.push_back(file30ptr->allocatePage().page_number());
+	if (used30.back() != used30[9] + 1 || !usedListIs(file30ptr, used30))
+	{
+		PRINT_ERROR("ERROR :: USED LIST WRONG AFTER REUSE");
+	}
+
+	// A file not in the format of File is refused, and is left closed
+	const std::string foreign = "test.30.foreign";
+	{
+		File::create(foreign);
+	}
+	{
+		const std::uint32_t formerHeader[4] = {3, 1, 0, 0};
+		std::fstream stream(foreign.c_str(), std::fstream::in | std::fstream::out | std::fstream::binary);
+		stream.write(reinterpret_cast<const char *>(formerHeader), sizeof(formerHeader));
+	}
+	try
+	{
+		File::open(foreign);
+		PRINT_ERROR("ERROR :: FILE IN ANOTHER FORMAT OPENED");
+	}
+	catch (FileFormatException &e)
+	{
+	}
+	if (File::isOpen(foreign))
+	{
+		PRINT_ERROR("ERROR :: FILE LEFT OPEN");
+	}
+	File::remove(foreign);
+
+	std::cout << "Test 30 passed"
+			  << "\n";
+}
+
+void test31()
+{
+	// 31. Test description: A file in version 1 of the format is refused until it is converted, and
+	// keeps its pages, used list and free pages through the conversion
+	std::vector<PageId> used31;
+	for (int i = 0; i < 5; i++)
+	{
+		Page page = file31ptr->allocatePage();
+		sprintf((char *)tmpbuf, "test.31 page %d", page.page_number());
+		page.insertRecord(tmpbuf);
+		file31ptr->writePage(page);
+		used31.push_back(page.page_number());
+	}
+	const PageId freed = used31[2];
+	file31ptr->deletePage(freed);
+	used31.erase(used31.begin() + 2);
+	file31ptr->sync();
+
+	// Lay the same pages out as version 1 did: a 16 byte header, then every page. The pages
+	// of a file this small are stored right after the allocation map block.
+	const std::string former = "test.31.former";
+	{
+		const std::uint32_t numPages = used31.back() + 1;
+		const std::uint32_t formerHeader[4] = {numPages, used31.front(), 1, freed};
+		std::ifstream in(file31ptr->filename().c_str(), std::ifstream::binary);
+		std::ofstream out(former.c_str(), std::ofstream::binary | std::ofstream::trunc);
+		out.write(reinterpret_cast<const char *>(formerHeader), sizeof(formerHeader));
+		std::vector<char> block(Page::SIZE);
+		for (PageId pageNo = 1; pageNo < numPages; pageNo++)
+		{
+			in.seekg((std::streamoff)(pageNo + 1) * Page::SIZE);
+			in.read(&block[0], block.size());
+			out.write(&block[0], block.size());
+		}
+	}
+
+	try
+	{
+		File::open(former);
+		PRINT_ERROR("ERROR :: VERSION 1 FILE OPENED WITHOUT CONVERSION");
+	}
+	catch (FileFormatException &e)
+	{
+	}
+	// A conversion that cannot write the new file keeps the original
+	struct rlimit limit;
+	getrlimit(RLIMIT_FSIZE, &limit);
+	const rlim_t unlimited = limit.rlim_cur;
+	limit.rlim_cur = Page::SIZE;
+	std::signal(SIGXFSZ, SIG_IGN);
+	setrlimit(RLIMIT_FSIZE, &limit);
+	bool thrown = false;
+	try
+	{
+		File::convert(former);
+	}
+	catch (FileIOException &e)
+	{
+		thrown = true;
+	}
+	limit.rlim_cur = unlimited;
+	setrlimit(RLIMIT_FSIZE, &limit);
+	std::signal(SIGXFSZ, SIG_DFL);
+	if (!thrown || File::exists(former + ".converting"))
+	{
+		PRINT_ERROR("ERROR :: FAILED CONVERSION NOT REPORTED OR NOT CLEANED UP");
+	}
+	if (!File::convert(former) || File::convert(former))
+	{
+		PRINT_ERROR("ERROR :: FILE NOT CONVERTED EXACTLY ONCE");
+	}
+	{
+		File converted = File::open(former);
+		std::vector<PageId> listed;
+		for (FileIterator iter = converted.begin(); iter != converted.end(); ++iter)
+		{
+			Page page = *iter;
+			sprintf((char *)tmpbuf, "test.31 page %d", page.page_number());
+			if (page.begin() == page.end() || *page.begin() != tmpbuf)
+			{
+				PRINT_ERROR("ERROR :: PAGE CONTENTS LOST IN CONVERSION");
+			}
+			listed.push_back(page.page_number());
+		}
+		if (listed != used31)
+		{
+			PRINT_ERROR("ERROR :: USED LIST LOST IN CONVERSION");
+		}
+		if (converted.allocatePage().page_number() != freed)
+		{
+			PRINT_ERROR("ERROR :: FREE PAGE LOST IN CONVERSION");
+		}
+	}
+	File::remove(former);
+
+	// Something that is neither version is refused
+	{
+		std::ofstream out(former.c_str(), std::ofstream::binary | std::ofstream::trunc);
+		out << "not a database file";
+	}
+	try
+	{
+		File::convert(former);
+		PRINT_ERROR("ERROR :: FOREIGN FILE CONVERTED");
+	}
+	catch (FileFormatException &e)
+	{
+	}
+	File::remove(former);
+
+	std::cout << "Test 31 passed"
+			  << "\n";
+}
+
+void test32()
+{
+	// 32. Test description: Pages allocated as an extent get consecutive numbers at the end of the file
+	// and join the used list, through File and through the buffer manager, which pins them all or none
+	const PageId kept = file32ptr->allocatePage().page_number();
+	const PageId freed = file32ptr->allocatePage().page_number();
+	file32ptr->deletePage(freed);
+	std::vector<Page> extent;
+	file32ptr->allocatePages(10, extent);
+	std::vector<PageId> used32(1, kept);
+	for (std::size_t i = 0; i < extent.size(); i++)
+	{
+		if (extent[i].page_number() != freed + 1 + i)
+		{
+			PRINT_ERROR("ERROR :: EXTENT NOT CONSECUTIVE AT THE END OF THE FILE");
+		}
+		used32.push_back(extent[i].page_number());
+	}
+	file32ptr->allocatePages(5, extent, true /* preallocate */);
+	for (std::size_t i = 0; i < extent.size(); i++)
+	{
+		used32.push_back(extent[i].page_number());
+	}
+	if (!usedListIs(file32ptr, used32))
+	{
+		PRINT_ERROR("ERROR :: EXTENT NOT IN USED LIST");
+	}
+	if (file32ptr->allocatePage().page_number() != freed)
+	{
+		PRINT_ERROR("ERROR :: FREE PAGE NOT LEFT FOR ALLOCATEPAGE");
+	}
+
+	{
+		PageBufferManager pool(num, ReplacementPolicyType::CLOCK);
+		std::vector<PageId> pageNumbers;
+		std::vector<Page *> pages;
+		pool.allocatePages(file32ptr, 20, pageNumbers, pages);
+		for (std::size_t i = 0; i < pages.size(); i++)
+		{
+			if (pageNumbers[i] != used32.back() + 1 + i || pages[i]->page_number() != pageNumbers[i])
+			{
+				PRINT_ERROR("ERROR :: WRONG PAGES ALLOCATED THROUGH THE POOL");
+			}
+			sprintf((char *)tmpbuf, "test.32 page %d", pageNumbers[i]);
+			pages[i]->insertRecord(tmpbuf);
+		}
+		// Every frame but the 20 pinned ones is free, so the next extent cannot fit
+		std::vector<PageId> moreNumbers;
+		std::vector<Page *> morePages;
+		try
+		{
+			pool.allocatePages(file32ptr, num, moreNumbers, morePages);
+			PRINT_ERROR("ERROR :: MORE PAGES PINNED THAN FRAMES");
+		}
+		catch (BufferExceededException &e)
+		{
+		}
+		for (std::size_t i = 0; i < pageNumbers.size(); i++)
+		{
+			pool.unPinPage(file32ptr, pageNumbers[i], true);
+		}
+		pool.flushFile(file32ptr);
+		pool.allocatePages(file32ptr, 1, moreNumbers, morePages);
+		if (moreNumbers.size() != 1 || moreNumbers[0] != pageNumbers.back() + 1)
+		{
+			PRINT_ERROR("ERROR :: FAILED EXTENT ALLOCATED PAGES");
+		}
+		pool.unPinPage(file32ptr, moreNumbers[0], false);
+		for (std::size_t i = 0; i < pageNumbers.size(); i++)
+		{
+			Page onDisk = file32ptr->readPage(pageNumbers[i]);
+			sprintf((char *)tmpbuf, "test.32 page %d", pageNumbers[i]);
+			if (onDisk.begin() == onDisk.end() || *onDisk.begin() != tmpbuf)
+			{
+				PRINT_ERROR("ERROR :: PAGE OF EXTENT NOT WRITTEN");
+			}
+		}
+	}
+
+	std::cout << "Test 32 passed"
+			  << "\n";
+}
+
+static int recordCount(Page page)
+{
+	int count = 0;
+	for (PageIterator iter = page.begin(); iter != page.end(); ++iter)
+	{
+		count++;
+	}
+	return count;
+}
+
+void test33()
+{
+	// 33. Test description: A mapped file reads pages as views of its mapping, in which changes
+	// written through the file show up, and a pool it is registered with serves them from there,
+	// synchronously or not, and refuses to change them
+	std::vector<Page> pages33;
+	file33ptr->allocatePages(10, pages33);
+	for (std::size_t i = 0; i < pages33.size(); i++)
+	{
+		sprintf((char *)tmpbuf, "test.33 page %d", pages33[i].page_number());
+		pages33[i].insertRecord(tmpbuf);
+		file33ptr->writePage(pages33[i]);
+	}
+	file33ptr->deletePage(pages33[9].page_number());
+
+	MappedFile mapped(*file33ptr);
+	Page view = mapped.readPage(pages33[3].page_number());
+	Page changed = file33ptr->readPage(pages33[3].page_number());
+	changed.insertRecord("test.33 second record");
+	file33ptr->writePage(changed);
+	if (recordCount(view) != 2)
+	{
+		PRINT_ERROR("ERROR :: MAPPED PAGE IS NOT A VIEW OF THE FILE");
+	}
+	try
+	{
+		mapped.readPage(pages33[9].page_number());
+		PRINT_ERROR("ERROR :: DELETED PAGE READ FROM MAPPING");
+	}
+	catch (InvalidPageException &e)
+	{
+	}
+
+	// Pages allocated after mapping are read from the file
+	Page late = file33ptr->allocatePage();
+	late.insertRecord("test.33 late page");
+	file33ptr->writePage(late);
+	if (*mapped.readPage(late.page_number()).begin() != "test.33 late page")
+	{
+		PRINT_ERROR("ERROR :: PAGE PAST THE MAPPING NOT READ");
+	}
+
+	std::size_t scanned = 0;
+	for (MappedFileIterator iter = mapped.begin(); iter != mapped.end(); ++iter)
+	{
+		Page page = *iter;
+		sprintf((char *)tmpbuf, "test.33 page %d", page.page_number());
+		if (page.page_number() != late.page_number() && *page.begin() != tmpbuf)
+		{
+			PRINT_ERROR("ERROR :: WRONG PAGE IN MAPPED SCAN");
+		}
+		scanned++;
+	}
+	if (scanned != 10)
+	{
+		PRINT_ERROR("ERROR :: MAPPED SCAN MISSED PAGES");
+	}
+
+	{
+		PageBufferManager pool(3, ReplacementPolicyType::CLOCK);
+		pool.registerMappedFile(&mapped);
+		Page *page;
+		pool.readPage(&mapped, pages33[0].page_number(), page);
+		if (pool.getBufStats().diskreads != 0)
+		{
+			PRINT_ERROR("ERROR :: MAPPED PAGE COPIED INTO THE POOL");
+		}
+		std::future<Page *> again = pool.readPageAsync(&mapped, pages33[0].page_number());
+		std::future<Page *> other = pool.readPageAsync(&mapped, pages33[1].page_number());
+		if (again.get() != page || pool.getBufStats().diskreads != 0)
+		{
+			PRINT_ERROR("ERROR :: ASYNC READ DID NOT USE THE MAPPING");
+		}
+		other.get();
+		if (pool.getBufStats().diskreads != 0)
+		{
+			PRINT_ERROR("ERROR :: MAPPED PAGE COPIED INTO THE POOL BY AN ASYNC READ");
+		}
+		pool.unPinPage(&mapped, pages33[1].page_number(), false);
+		Page first = file33ptr->readPage(pages33[0].page_number());
+		first.insertRecord("test.33 second record");
+		file33ptr->writePage(first);
+		if (recordCount(*page) != 2)
+		{
+			PRINT_ERROR("ERROR :: PINNED PAGE DOES NOT POINT INTO THE MAPPING");
+		}
+
+		// The pool only reads a registered file
+		try
+		{
+			pool.unPinPage(&mapped, pages33[0].page_number(), true);
+			PRINT_ERROR("ERROR :: MAPPED PAGE MARKED DIRTY");
+		}
+		catch (ReadOnlyFileException &e)
+		{
+		}
+		pool.unPinPage(&mapped, pages33[0].page_number(), false);
+		try
+		{
+			pool.unPinPage(&mapped, pages33[0].page_number(), false);
+			PRINT_ERROR("ERROR :: REJECTED UNPIN LEFT THE PAGE PINNED");
+		}
+		catch (PageNotPinnedException &e)
+		{
+		}
+		if (pool.countDirtyPages() != 0)
+		{
+			PRINT_ERROR("ERROR :: MAPPED PAGE MARKED DIRTY");
+		}
+		PageId pageNo;
+		try
+		{
+			pool.allocatePage(&mapped, pageNo, page);
+			PRINT_ERROR("ERROR :: PAGE ALLOCATED IN A REGISTERED FILE");
+		}
+		catch (ReadOnlyFileException &e)
+		{
+		}
+		try
+		{
+			pool.disposePage(&mapped, pages33[1].page_number());
+			PRINT_ERROR("ERROR :: PAGE DISPOSED IN A REGISTERED FILE");
+		}
+		catch (ReadOnlyFileException &e)
+		{
+		}
+		// Reuse every frame for pages read from the file, which must not land in the mapping
+		for (int i = 4; i < 8; i++)
+		{
+			pool.readPage(file33ptr, pages33[i].page_number(), page);
+			pool.unPinPage(file33ptr, pages33[i].page_number(), false);
+		}
+		pool.flushFile(file33ptr);
+		for (int i = 0; i < 9; i++)
+		{
+			Page onDisk = file33ptr->readPage(pages33[i].page_number());
+			sprintf((char *)tmpbuf, "test.33 page %d", pages33[i].page_number());
+			if (*onDisk.begin() != tmpbuf || recordCount(onDisk) != (i == 0 || i == 3 ? 2 : 1))
+			{
+				PRINT_ERROR("ERROR :: PAGE CHANGED WRONGLY");
+			}
+		}
+		pool.unregisterMappedFile(&mapped);
+	}
+
+	std::cout << "Test 33 passed"
+			  << "\n";
+}
+
+void test34()
+{
+	// 34. Test description: A page updated by one thread while others keep reading pages into a
+	// pool too small to hold them all loses no update: a copy read while the page was written
+	// back and evicted is never published
+	const int n_updates = 5000;
+	const int n_pages = 8;
+	std::vector<PageId> pages34;
+	RecordId counter34;
+	for (int j = 0; j < n_pages; j++)
+	{
+		Page new_page = file34ptr->allocatePage();
+		pages34.push_back(new_page.page_number());
+		sprintf((char *)tmpbuf, "%08d", 0);
+		const RecordId rid = new_page.insertRecord(tmpbuf);
+		if (j == 0)
+		{
+			counter34 = rid;
+		}
+		file34ptr->writePage(new_page);
+	}
+	{
+		// One frame per thread, so every read evicts a page
+		PageBufferManager pool(4, ReplacementPolicyType::CLOCK);
+		std::atomic<bool> done(false);
+		std::atomic<int> failures(0);
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 3; t++)
+		{
+			readers.push_back(std::thread([&, t]()
+										  {
+				for (int j = t; !done; j++)
+				{
+					const PageId pageNo = pages34[j % n_pages];
+					try
+					{
+						Page *page;
+						pool.readPage(file34ptr, pageNo, page);
+						pool.unPinPage(file34ptr, pageNo, false);
+					}
+					catch (BadgerDbException &)
+					{
+						failures++;
+					}
+				} }));
+		}
+		for (int i = 0; i < n_updates; i++)
+		{
+			Page *page;
+			pool.readPage(file34ptr, pages34[0], page);
+			const int value = atoi(page->getRecord(counter34).c_str());
+			sprintf((char *)tmpbuf, "%08d", value + 1);
+			page->updateRecord(counter34, tmpbuf);
+			pool.unPinPage(file34ptr, pages34[0], true);
+			// Let the readers run in between, even on a single processor
+			std::this_thread::yield();
+		}
+		done = true;
+		for (std::size_t t = 0; t < readers.size(); t++)
+		{
+			readers[t].join();
+		}
+		if (failures != 0)
+		{
+			PRINT_ERROR("ERROR :: CONCURRENT READ FAILED");
+		}
+		pool.flushFile(file34ptr);
+	}
+	if (atoi(file34ptr->readPage(pages34[0]).getRecord(counter34).c_str()) != n_updates)
+	{
+		PRINT_ERROR("ERROR :: UPDATE LOST WHILE THE PAGE WAS EVICTED");
+	}
+
+	std::cout << "Test 34 passed"
+			  << "\n";
+}
+
+void test35()
+{
+	// 35. Test description: A write that fails throws FileIOException and leaves the file as it was; the
+	// file size limit makes writes past the end of the file fail
+	for (int i = 0; i < 2; i++)
+	{
+		Page new_page = file35ptr->allocatePage();
+		new_page.insertRecord("test.35 record");
+		file35ptr->writePage(new_page);
+	}
+	file35ptr->sync();
+	struct stat info;
+	struct rlimit limit;
+	if (stat("test.35", &info) != 0 || getrlimit(RLIMIT_FSIZE, &limit) != 0)
+	{
+		PRINT_ERROR("ERROR :: CANNOT SET UP TEST 35");
+	}
+	const rlim_t unlimited = limit.rlim_cur;
+	limit.rlim_cur = info.st_size;
+	std::signal(SIGXFSZ, SIG_IGN);
+	setrlimit(RLIMIT_FSIZE, &limit);
+
+	bool thrown = false;
+	try
+	{
+		file35ptr->allocatePage();
+	}
+	catch (FileIOException &e)
+	{
+		thrown = true;
+	}
+	if (!thrown)
+	{
+		PRINT_ERROR("ERROR :: FAILED PAGE WRITE NOT REPORTED");
+	}
+	thrown = false;
+	try
+	{
+		std::vector<Page> extent;
+		file35ptr->allocatePages(4, extent);
+	}
+	catch (FileIOException &e)
+	{
+		thrown = true;
+	}
+	if (!thrown)
+	{
+		PRINT_ERROR("ERROR :: FAILED EXTENT WRITE NOT REPORTED");
+	}
+	thrown = false;
+	{
+		PageBufferManager pool(4);
+		try
+		{
+			PageId pageNo;
+			pool.allocatePage(file35ptr, pageNo, page);
+		}
+		catch (FileIOException &e)
+		{
+			thrown = true;
+		}
+		if (!thrown || pool.countDirtyPages() != 0)
+		{
+			PRINT_ERROR("ERROR :: FAILED ALLOCATION THROUGH THE POOL NOT REPORTED");
+		}
+	}
+
+	limit.rlim_cur = unlimited;
+	setrlimit(RLIMIT_FSIZE, &limit);
+	std::signal(SIGXFSZ, SIG_DFL);
+	if (file35ptr->allocatePage().page_number() != 3)
+	{
+		PRINT_ERROR("ERROR :: FAILED ALLOCATIONS LEFT PAGES USED");
+	}
+	file35ptr->sync();
+	int pages = 0;
+	for (FileIterator iter = file35ptr->begin(); iter != file35ptr->end(); ++iter)
+	{
+		pages++;
+	}
+	if (pages != 3)
+	{
+		PRINT_ERROR("ERROR :: FAILED ALLOCATIONS CHANGED THE FILE");
+	}
+
+	// A page cut short by the end of the file is an error, not a free page
+	stat("test.35", &info);
+	if (truncate("test.35", info.st_size - Page::SIZE / 2) != 0)
+	{
+		PRINT_ERROR("ERROR :: CANNOT TRUNCATE TEST 35");
+	}
+	thrown = false;
+	try
+	{
+		file35ptr->readPage(3);
+	}
+	catch (FileIOException &e)
+	{
+		thrown = true;
+	}
+	if (!thrown)
+	{
+		PRINT_ERROR("ERROR :: PAGE CUT SHORT NOT REPORTED");
+	}
+
+	std::cout << "Test 35 passed"
+			  << "\n";
+}
+
+void test36()
+{
+	// 36. Test description: Pages moved from can be assigned to and swapped, and moving a page over
+	// memory it does not own gives a page over the same memory
+	Page first, second;
+	first.insertRecord("test.36 first");
+	second.insertRecord("test.36 second");
+	std::swap(first, second);
+	if (*first.begin() != "test.36 second" || *second.begin() != "test.36 first")
+	{
+		PRINT_ERROR("ERROR :: PAGES NOT SWAPPED");
+	}
+	Page moved(std::move(first));
+	first = second;
+	second = std::move(moved);
+	moved = first;
+	if (*first.begin() != "test.36 first" || *second.begin() != "test.36 second" ||
+		*moved.begin() != "test.36 first")
+	{
+		PRINT_ERROR("ERROR :: PAGE MOVED FROM NOT ASSIGNED");
+	}
+
+	std::vector<char> block(Page::SIZE);
+	const PageHeader *header = reinterpret_cast<const PageHeader *>(&block[0]);
+	Page view(&block[0]);
+	view.insertRecord("test.36 view");
+	Page viewMoved(std::move(view));
+	Page viewCopy(viewMoved);
+	viewMoved.insertRecord("test.36 more");
+	if (header->num_slots != 2 || viewCopy.getFreeSpace() == viewMoved.getFreeSpace() ||
+		*view.begin() != "test.36 view")
+	{
+		PRINT_ERROR("ERROR :: PAGE OVER CALLER'S MEMORY NOT MOVED AS A VIEW");
+	}
+	// Swapping with a view copies through the view's memory
+	std::swap(view, viewCopy);
+	if (header->num_slots != 1 || viewCopy.getFreeSpace() != view.getFreeSpace())
+	{
+		PRINT_ERROR("ERROR :: PAGE OVER CALLER'S MEMORY NOT SWAPPED");
+	}
+
+	std::cout << "Test 36 passed"
+			  << "\n";
+}
+
+void test37()
+{
+	// 37. Test description: A hash table partition filled to the last slot still removes entries
+	// and finds the rest
+	BufHashTbl table(1);
+	std::mutex &latch = table.partitionLatch(file37ptr, 1);
+	std::vector<PageId> inserted;
+	for (PageId pageNo = 1;; pageNo++)
+	{
+		if (&table.partitionLatch(file37ptr, pageNo) != &latch)
+		{
+			continue;
+		}
+		try
+		{
+			table.insert(file37ptr, pageNo, (FrameId)inserted.size());
+		}
+		catch (HashTableException &e)
+		{
+			break;
+		}
+		inserted.push_back(pageNo);
+	}
+	for (std::size_t i = 0; i < inserted.size(); i += 2)
+	{
+		table.remove(file37ptr, inserted[i]);
+	}
+	for (std::size_t i = 0; i < inserted.size(); i++)
+	{
+		FrameId frameNo;
+		if (table.tryLookup(file37ptr, inserted[i], frameNo) != (i % 2 == 1) || (i % 2 == 1 && frameNo != i))
+		{
+			PRINT_ERROR("ERROR :: WRONG ENTRIES AFTER REMOVING FROM A FULL PARTITION");
+		}
+	}
+
+	std::cout << "Test 37 passed"
+			  << "\n";
+}
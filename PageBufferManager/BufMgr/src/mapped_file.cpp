@@ -0,0 +1,147 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "exceptions/invalid_page_exception.h"
+
+namespace badgerdb
+{
+
+  const PageId MappedFile::SCAN_WINDOW;
+
+  MappedFile::Mapping::~Mapping()
+  {
+    if (data != NULL)
+    {
+      ::munmap(data, size);
+    }
+  }
+
+  MappedFile MappedFile::open(const std::string &filename)
+  {
+    return MappedFile(File::open(filename));
+  }
+
+  MappedFile::MappedFile(const File &file)
+      : File(file),
+        mapping_(new Mapping())
+  {
+    // A file without pages has nothing worth mapping
+    struct stat info;
+    if (::fstat(fd_, &info) != 0 ||
+        info.st_size < pagePosition(1) + (off_t)Page::SIZE)
+    {
+      return;
+    }
+    void *data = ::mmap(NULL, info.st_size, PROT_READ, MAP_SHARED,
+                        fd_, 0);
+    if (data != MAP_FAILED)
+    {
+      mapping_->data = static_cast<char *>(data);
+      mapping_->size = info.st_size;
+    }
+  }
+
+  Page MappedFile::readPage(const PageId page_number) const
+  {
+    char *memory = pageMemory(page_number);
+    if (memory == NULL)
+    {
+      return File::readPage(page_number);
+    }
+    return Page(memory, false /* initialize */);
+  }
+
+  char *MappedFile::pageMemory(const PageId page_number) const
+  {
+    if (page_number == Page::INVALID_NUMBER ||
+        page_number >= state_->num_pages)
+    {
+      throw InvalidPageException(page_number, filename());
+    }
+    const off_t position = pagePosition(page_number);
+    if (mapping_->data == NULL ||
+        (std::size_t)position + Page::SIZE > mapping_->size)
+    {
+      return NULL;
+    }
+    char *memory = mapping_->data + position;
+    if (reinterpret_cast<const PageHeader *>(memory)->current_page_number ==
+        Page::INVALID_NUMBER)
+    {
+      throw InvalidPageException(page_number, filename());
+    }
+    return memory;
+  }
+
+  MappedFileIterator MappedFile::begin()
+  {
+    const PageId first_page_number = readHeader().first_used_page;
+    adviseScan(Page::INVALID_NUMBER, first_page_number);
+    return MappedFileIterator(this, first_page_number);
+  }
+
+  MappedFileIterator MappedFile::end()
+  {
+    return MappedFileIterator(this, Page::INVALID_NUMBER);
+  }
+
+  void MappedFile::advise(const PageId first_page_number,
+                          const PageId last_page_number,
+                          const int advice) const
+  {
+    const std::size_t start = pagePosition(first_page_number);
+    const std::size_t stop = std::min<std::size_t>(
+        pagePosition(last_page_number) + Page::SIZE, mapping_->size);
+    if (start < stop)
+    {
+      ::madvise(mapping_->data + start, stop - start, advice);
+    }
+  }
+
+  void MappedFile::adviseScan(const PageId previous_page_number,
+                              const PageId page_number) const
+  {
+    if (mapping_->data == NULL)
+    {
+      return;
+    }
+    if (previous_page_number == Page::INVALID_NUMBER)
+    {
+      if (page_number != Page::INVALID_NUMBER)
+      {
+        const PageId window = (page_number - 1) / SCAN_WINDOW;
+        ::madvise(mapping_->data, mapping_->size, MADV_SEQUENTIAL);
+        advise(page_number, (window + 2) * SCAN_WINDOW, MADV_WILLNEED);
+      }
+      return;
+    }
+    const PageId previous_window = (previous_page_number - 1) / SCAN_WINDOW;
+    if (page_number == Page::INVALID_NUMBER)
+    {
+      advise(previous_window * SCAN_WINDOW + 1, previous_page_number,
+             MADV_DONTNEED);
+      ::madvise(mapping_->data, mapping_->size, MADV_NORMAL);
+      return;
+    }
+    const PageId window = (page_number - 1) / SCAN_WINDOW;
+    if (window != previous_window)
+    {
+      // The window after this one was not asked for yet
+      advise((window + 1) * SCAN_WINDOW + 1, (window + 2) * SCAN_WINDOW,
+             MADV_WILLNEED);
+      advise(previous_window * SCAN_WINDOW + 1, window * SCAN_WINDOW,
+             MADV_DONTNEED);
+    }
+  }
+
+}
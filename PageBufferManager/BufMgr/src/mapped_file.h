@@ -0,0 +1,221 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "file.h"
+#include "file_iterator.h"
+
+namespace badgerdb
+{
+
+  class MappedFileIterator;
+
+  /**
+   * @brief A file whose pages are read straight from a memory mapping of it.
+   *
+   * Meant for files that are mostly read, such as the tables of an analytical
+   * query.  The file is mapped shared when the object is made, and readPage()
+   * returns a page viewing its bytes in the mapping instead of a copy.  Pages
+   * allocated after that lie past the mapped part and are read as by File.
+   *
+   * Everything else works as for File, which this is: pages are allocated,
+   * written and deleted with positional writes, which a shared mapping sees at
+   * once.  The mapping is read-only, so a page viewed in it must not be changed:
+   * change a copy read with File::readPage() and write that back instead.
+   *
+   * Iterating over the file with begin() and end() tells the kernel about the
+   * scan: the mapping is advised sequential, the pages ahead of the iterator
+   * are asked for (WILLNEED) a window at a time, and those behind it are
+   * dropped from the mapping (DONTNEED), which leaves them in the page cache.
+   *
+   * A PageBufferManager serves the pages of a MappedFile registered with it
+   * from the mapping as well (PageBufferManager::registerMappedFile()).
+   *
+   * @warning Copies of a MappedFile share its mapping, which lives until the
+   * last of them is destroyed.  Like File, this class is not threadsafe, except
+   * for reading pages.
+   */
+  class MappedFile : public File
+  {
+  public:
+    /**
+     * Opens the file named filename and maps it.
+     *
+     * @param filename  Name of the file.
+     * @throws  FileNotFoundException   If the requested file doesn't exist.
+     * @throws  FileFormatException     If the file is not in the format of File.
+     */
+    static MappedFile open(const std::string &filename);
+
+    /**
+     * Maps a file opened already.  If the file cannot be mapped, all of its
+     * pages are read as by File.
+     *
+     * @param file  File to map.
+     */
+    explicit MappedFile(const File &file);
+
+    /**
+     * Returns a page of the file viewing it in the mapping, or a copy of it if
+     * it lies past the mapped part.  The view is valid while this object or a
+     * copy of it exists and is read-only; copying the returned page copies the
+     * page.
+     *
+     * @param page_number   Number of page to read.
+     * @return  The page.
+     * @throws  InvalidPageException  If the page doesn't exist in the file or is
+     *                                not currently used.
+     */
+    Page readPage(const PageId page_number) const;
+
+    /**
+     * Returns the memory of a page in the mapping, Page::SIZE read-only bytes
+     * laid out as on disk.
+     *
+     * @param page_number   Number of page.
+     * @return  Start of the page, or NULL if the page lies past the mapped part
+     *          of the file.
+     * @throws  InvalidPageException  If the page doesn't exist in the file or is
+     *                                not currently used.
+     */
+    char *pageMemory(const PageId page_number) const;
+
+    /**
+     * Returns an iterator at the first page in the file, and starts advising
+     * the kernel of a sequential scan.
+     *
+     * @return  Iterator at first page of file.
+     */
+    MappedFileIterator begin();
+
+    /**
+     * Returns an iterator representing the page after the last page in the file.
+     *
+     * @return  Iterator representing page after the last page in the file.
+     */
+    MappedFileIterator end();
+
+  private:
+    /**
+     * Number of pages advised at a time during a scan (1MB).
+     */
+    static const PageId SCAN_WINDOW = 128;
+
+    /**
+     * Mapping of the file, unmapped when the last MappedFile using it goes.
+     */
+    struct Mapping
+    {
+      /**
+       * Start of the mapping, or NULL if the file is not mapped.
+       */
+      char *data;
+
+      /**
+       * Length of the mapping in bytes.
+       */
+      std::size_t size;
+
+      Mapping() : data(NULL), size(0) {}
+
+      ~Mapping();
+    };
+
+    /**
+     * Advises the kernel of the part of a range of pages that is mapped.
+     *
+     * @param first_page_number   Number of first page of the range.
+     * @param last_page_number    Number of last page of the range.
+     * @param advice              MADV_* advice.
+     */
+    void advise(const PageId first_page_number, const PageId last_page_number,
+                const int advice) const;
+
+    /**
+     * Advises the kernel of a scan that moved from one page to another: when it
+     * enters a new window the next one is asked for and the pages passed are
+     * dropped.  A scan that starts (from Page::INVALID_NUMBER) advises the
+     * mapping sequential, and one that ends (at Page::INVALID_NUMBER) normal
+     * again.
+     *
+     * @param previous_page_number  Number of page the scan was at.
+     * @param page_number           Number of page the scan is at now.
+     */
+    void adviseScan(const PageId previous_page_number,
+                    const PageId page_number) const;
+
+    /**
+     * Mapping shared by the copies of this object.
+     */
+    std::shared_ptr<Mapping> mapping_;
+
+    friend class MappedFileIterator;
+  };
+
+  /**
+   * @brief Iterator over the pages of a MappedFile which returns views of the
+   *        pages and advises the kernel of the scan as it goes.
+   */
+  class MappedFileIterator : public FileIterator
+  {
+  public:
+    /**
+     * Constructs an iterator over the pages of a mapped file, starting at the
+     * given page number.
+     *
+     * @param file        File to iterate over.
+     * @param page_number Number of page to start iterator at.
+     */
+    MappedFileIterator(MappedFile *file, PageId page_number)
+        : FileIterator(file, page_number),
+          mapped_file_(file)
+    {
+    }
+
+    /**
+     * Advances the iterator to the next page in the file.
+     */
+    inline MappedFileIterator &operator++()
+    {
+      const PageId previous_page_number = current_page_number_;
+      FileIterator::operator++();
+      mapped_file_->adviseScan(previous_page_number, current_page_number_);
+      return *this;
+    }
+
+    // postfix
+    inline MappedFileIterator operator++(int)
+    {
+      MappedFileIterator tmp = *this; // copy ourselves
+      ++*this;
+      return tmp;
+    }
+
+    /**
+     * Dereferences the iterator, returning a view of the current page in the
+     * mapping.
+     *
+     * @return  Page in file.
+     */
+    inline Page operator*() const
+    {
+      return mapped_file_->readPage(current_page_number_);
+    }
+
+  private:
+    /**
+     * File we're iterating over.
+     */
+    const MappedFile *mapped_file_;
+  };
+
+}
@@ -6,6 +6,10 @@
  */
 
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
 
 #include "exceptions/insufficient_space_exception.h"
 #include "exceptions/invalid_record_exception.h"
@@ -17,20 +21,157 @@
 namespace badgerdb
 {
 
+  /**
+   * Allocates SIZE bytes aligned to ALIGNMENT for a page of its own.
+   */
+  static char *allocatePageMemory()
+  {
+    void *memory;
+    if (posix_memalign(&memory, Page::ALIGNMENT, Page::SIZE) != 0)
+    {
+      throw std::bad_alloc();
+    }
+    return static_cast<char *>(memory);
+  }
+
   Page::Page()
+      : memory_(allocatePageMemory()),
+        owns_memory_(true),
+        header_(reinterpret_cast<PageHeader *>(memory_)),
+        data_(memory_ + sizeof(PageHeader))
   {
     initialize();
   }
 
+  Page::Page(char *memory)
+      : memory_(memory),
+        owns_memory_(false),
+        header_(reinterpret_cast<PageHeader *>(memory_)),
+        data_(memory_ + sizeof(PageHeader))
+  {
+    initialize();
+  }
+
+  Page::Page(char *memory, const bool initialize_memory)
+      : memory_(memory),
+        owns_memory_(false),
+        header_(reinterpret_cast<PageHeader *>(memory_)),
+        data_(memory_ + sizeof(PageHeader))
+  {
+    if (initialize_memory)
+    {
+      initialize();
+    }
+  }
+
+  Page::Page(const Page &other)
+      : memory_(allocatePageMemory()),
+        owns_memory_(true),
+        header_(reinterpret_cast<PageHeader *>(memory_)),
+        data_(memory_ + sizeof(PageHeader))
+  {
+    if (other.memory_ == NULL)
+    {
+      initialize();
+      return;
+    }
+    std::memcpy(memory_, other.memory_, SIZE);
+  }
+
+  Page::Page(Page &&other) noexcept
+      : memory_(other.memory_),
+        owns_memory_(other.owns_memory_),
+        header_(other.header_),
+        data_(other.data_)
+  {
+    // A page over memory it does not own leaves a page viewing the same memory
+    if (owns_memory_)
+    {
+      other.memory_ = NULL;
+      other.owns_memory_ = false;
+      other.header_ = NULL;
+      other.data_ = NULL;
+    }
+  }
+
+  Page &Page::operator=(const Page &other)
+  {
+    if (this == &other || other.memory_ == NULL)
+    {
+      return *this;
+    }
+    if (memory_ == NULL)
+    {
+      // Moved from
+      memory_ = allocatePageMemory();
+      owns_memory_ = true;
+      header_ = reinterpret_cast<PageHeader *>(memory_);
+      data_ = memory_ + sizeof(PageHeader);
+    }
+    std::memcpy(memory_, other.memory_, SIZE);
+    return *this;
+  }
+
+  Page &Page::operator=(Page &&other) noexcept
+  {
+    if (this == &other)
+    {
+      return *this;
+    }
+    const bool is_view = memory_ != NULL && !owns_memory_;
+    const bool other_is_view = other.memory_ != NULL && !other.owns_memory_;
+    if (!is_view && !other_is_view)
+    {
+      // Owned or moved from, both: nothing else refers to the memory
+      std::swap(memory_, other.memory_);
+      std::swap(owns_memory_, other.owns_memory_);
+      std::swap(header_, other.header_);
+      std::swap(data_, other.data_);
+    }
+    else if (memory_ == NULL)
+    {
+      // As when moving into a new page, view the same memory
+      memory_ = other.memory_;
+      owns_memory_ = false;
+      header_ = other.header_;
+      data_ = other.data_;
+    }
+    else if (other.memory_ != NULL)
+    {
+      std::memcpy(memory_, other.memory_, SIZE);
+    }
+    return *this;
+  }
+
+  Page::~Page()
+  {
+    if (owns_memory_)
+    {
+      free(memory_);
+    }
+  }
+
+  void Page::view(char *memory)
+  {
+    if (owns_memory_)
+    {
+      free(memory_);
+    }
+    memory_ = memory;
+    owns_memory_ = false;
+    header_ = reinterpret_cast<PageHeader *>(memory_);
+    data_ = memory_ + sizeof(PageHeader);
+  }
+
   void Page::initialize()
   {
-    header_.free_space_lower_bound = 0;
-    header_.free_space_upper_bound = DATA_SIZE;
-    header_.num_slots = 0;
-    header_.num_free_slots = 0;
-    header_.current_page_number = INVALID_NUMBER;
-    header_.next_page_number = INVALID_NUMBER;
-    data_.assign(DATA_SIZE, char());
+    header_->free_space_lower_bound = 0;
+    header_->free_space_upper_bound = DATA_SIZE;
+    header_->num_slots = 0;
+    header_->num_free_slots = 0;
+    header_->current_page_number = INVALID_NUMBER;
+    header_->next_page_number = INVALID_NUMBER;
+    std::memset(data_, 0, DATA_SIZE);
   }
 
   RecordId Page::insertRecord(const std::string &record_data)
@@ -49,7 +190,7 @@ namespace badgerdb
   {
     validateRecordId(record_id);
     const PageSlot &slot = getSlot(record_id.slot_number);
-    return data_.substr(slot.item_offset, slot.item_length);
+    return std::string(data_ + slot.item_offset, slot.item_length);
   }
 
   void Page::updateRecord(const RecordId &record_id,
@@ -81,12 +222,12 @@ namespace badgerdb
   {
     validateRecordId(record_id);
     PageSlot *slot = getSlot(record_id.slot_number);
-    data_.replace(slot->item_offset, slot->item_length, slot->item_length, '\0');
+    std::memset(data_ + slot->item_offset, 0, slot->item_length);
 
     // Compact the data by removing the hole left by this record (if necessary).
     std::uint16_t move_offset = slot->item_offset;
     std::size_t move_bytes = 0;
-    for (SlotId i = 1; i <= header_.num_slots; ++i)
+    for (SlotId i = 1; i <= header_->num_slots; ++i)
     {
       PageSlot *other_slot = getSlot(i);
       if (other_slot->used && other_slot->item_offset < slot->item_offset)
@@ -104,26 +245,26 @@ namespace badgerdb
     // If we have data to move, shift it to the right.
     if (move_bytes > 0)
     {
-      const std::string &data_to_move = data_.substr(move_offset, move_bytes);
-      data_.replace(move_offset + slot->item_length, move_bytes, data_to_move);
+      std::memmove(data_ + move_offset + slot->item_length, data_ + move_offset,
+                   move_bytes);
     }
-    header_.free_space_upper_bound += slot->item_length;
+    header_->free_space_upper_bound += slot->item_length;
 
     // Mark slot as unused.
     slot->used = false;
     slot->item_offset = 0;
     slot->item_length = 0;
-    ++header_.num_free_slots;
+    ++header_->num_free_slots;
 
-    if (allow_slot_compaction && record_id.slot_number == header_.num_slots)
+    if (allow_slot_compaction && record_id.slot_number == header_->num_slots)
     {
       // Last slot in the list, so we need to free any unused slots that are at
       // the end of the slot list.
       int num_slots_to_delete = 1;
-      for (SlotId i = 1; i < header_.num_slots; ++i)
+      for (SlotId i = 1; i < header_->num_slots; ++i)
       {
         // Traverse list backwards, looking for unused slots.
-        const PageSlot *other_slot = getSlot(header_.num_slots - i);
+        const PageSlot *other_slot = getSlot(header_->num_slots - i);
         if (!other_slot->used)
         {
           ++num_slots_to_delete;
@@ -135,16 +276,16 @@ namespace badgerdb
           break;
         }
       }
-      header_.num_slots -= num_slots_to_delete;
-      header_.num_free_slots -= num_slots_to_delete;
-      header_.free_space_lower_bound -= sizeof(PageSlot) * num_slots_to_delete;
+      header_->num_slots -= num_slots_to_delete;
+      header_->num_free_slots -= num_slots_to_delete;
+      header_->free_space_lower_bound -= sizeof(PageSlot) * num_slots_to_delete;
     }
   }
 
   bool Page::hasSpaceForRecord(const std::string &record_data) const
   {
     std::size_t record_size = record_data.length();
-    if (header_.num_free_slots == 0)
+    if (header_->num_free_slots == 0)
     {
       record_size += sizeof(PageSlot);
     }
@@ -166,10 +307,10 @@ namespace badgerdb
   SlotId Page::getAvailableSlot()
   {
     SlotId slot_number = INVALID_SLOT;
-    if (header_.num_free_slots > 0)
+    if (header_->num_free_slots > 0)
     {
       // Have an allocated but unused slot that we can reuse.
-      for (SlotId i = 1; i <= header_.num_slots; ++i)
+      for (SlotId i = 1; i <= header_->num_slots; ++i)
       {
         const PageSlot *slot = getSlot(i);
         if (!slot->used)
@@ -184,10 +325,10 @@ namespace badgerdb
     else
     {
       // Have to allocate a new slot.
-      slot_number = header_.num_slots + 1;
-      ++header_.num_slots;
-      ++header_.num_free_slots;
-      header_.free_space_lower_bound = sizeof(PageSlot) * header_.num_slots;
+      slot_number = header_->num_slots + 1;
+      ++header_->num_slots;
+      ++header_->num_free_slots;
+      header_->free_space_lower_bound = sizeof(PageSlot) * header_->num_slots;
     }
     assert(slot_number != INVALID_SLOT);
     return static_cast<SlotId>(slot_number);
@@ -196,7 +337,7 @@ namespace badgerdb
   void Page::insertRecordInSlot(const SlotId slot_number,
                                 const std::string &record_data)
   {
-    if (slot_number > header_.num_slots ||
+    if (slot_number > header_->num_slots ||
         slot_number == INVALID_SLOT)
     {
       throw InvalidSlotException(page_number(), slot_number);
@@ -209,10 +350,10 @@ namespace badgerdb
     const int record_length = record_data.length();
     slot->used = true;
     slot->item_length = record_length;
-    slot->item_offset = header_.free_space_upper_bound - record_length;
-    header_.free_space_upper_bound = slot->item_offset;
-    --header_.num_free_slots;
-    data_.replace(slot->item_offset, slot->item_length, record_data);
+    slot->item_offset = header_->free_space_upper_bound - record_length;
+    header_->free_space_upper_bound = slot->item_offset;
+    --header_->num_free_slots;
+    std::memcpy(data_ + slot->item_offset, record_data.data(), record_length);
   }
 
   void Page::validateRecordId(const RecordId &record_id) const
@@ -108,6 +108,11 @@ namespace badgerdb
    * slots and identified by a RecordId.  Although a record's actual contents may
    * be moved on the page, accessing a record by its slot is consistent.
    *
+   * A page is a view over SIZE bytes laid out exactly as on disk: the header
+   * followed by the data.  A page made with the default constructor owns an
+   * ALIGNMENT-aligned block of its own; a page made over a block of the buffer
+   * pool only views it, so assigning to it fills the frame in place.
+   *
    * @warning This class is not threadsafe.
    */
   class Page
@@ -134,11 +139,51 @@ namespace badgerdb
      */
     static const SlotId INVALID_SLOT = 0;
 
+    /**
+     * Alignment of the memory of a page in bytes, enough for O_DIRECT I/O.
+     */
+    static const std::size_t ALIGNMENT = 4096;
+
     /**
      * Constructs a new, uninitialized page.
      */
     Page();
 
+    /**
+     * Constructs a new, uninitialized page over memory owned by the caller,
+     * which must hold SIZE bytes and outlive the page.
+     *
+     * @param memory  SIZE bytes, preferably aligned to ALIGNMENT.
+     */
+    explicit Page(char *memory);
+
+    /**
+     * Copies a page into memory of its own.
+     */
+    Page(const Page &other);
+
+    /**
+     * Takes over the memory of a page that owns it, leaving that page without
+     * memory, so that it must only be destroyed or assigned to afterwards.  A
+     * page over memory owned by someone else gives a page over the same memory.
+     */
+    Page(Page &&other) noexcept;
+
+    /**
+     * Copies the contents of a page into this page's memory, allocating memory
+     * first if this page was moved from.
+     */
+    Page &operator=(const Page &other);
+
+    /**
+     * Swaps memory with a page when neither is over memory owned by someone
+     * else, which includes pages moved from, and copies otherwise.  A page
+     * moved from takes the other page's memory as the move constructor does.
+     */
+    Page &operator=(Page &&other) noexcept;
+
+    ~Page();
+
     /**
      * Inserts a new record into the page.
      *
@@ -189,22 +234,22 @@ namespace badgerdb
      *
      * @return  Free space in bytes.
      */
-    std::uint16_t getFreeSpace() const { return header_.free_space_upper_bound -
-                                                header_.free_space_lower_bound; }
+    std::uint16_t getFreeSpace() const { return header_->free_space_upper_bound -
+                                                header_->free_space_lower_bound; }
 
     /**
      * Returns this page's number in its file.
      *
      * @return  Page number.
      */
-    PageId page_number() const { return header_.current_page_number; }
+    PageId page_number() const { return header_->current_page_number; }
 
     /**
      * Returns the number of the next used page this page in its file.
      *
      * @return  Page number of next used page in file.
      */
-    PageId next_page_number() const { return header_.next_page_number; }
+    PageId next_page_number() const { return header_->next_page_number; }
 
     /**
      * Returns an iterator at the first record in the page.
@@ -222,6 +267,23 @@ namespace badgerdb
     PageIterator end();
 
   private:
+    /**
+     * Constructs a page over memory owned by the caller which already holds a
+     * page, such as a page of a mapped file, leaving it as it is.
+     *
+     * @param memory      SIZE bytes holding a page.
+     * @param initialize  Whether to initialize it as a new page instead.
+     */
+    Page(char *memory, const bool initialize);
+
+    /**
+     * Makes this page view other memory which already holds a page, leaving it
+     * as it is.  Memory this page owned is freed.
+     *
+     * @param memory  SIZE bytes holding a page, which must outlive the page.
+     */
+    void view(char *memory);
+
     /**
      * Initializes this page as a new page with no header information or data.
      */
@@ -234,7 +296,7 @@ namespace badgerdb
      */
     void set_page_number(const PageId new_page_number)
     {
-      header_.current_page_number = new_page_number;
+      header_->current_page_number = new_page_number;
     }
 
     /**
@@ -244,7 +306,7 @@ namespace badgerdb
      */
     void set_next_page_number(const PageId new_next_page_number)
     {
-      header_.next_page_number = new_next_page_number;
+      header_->next_page_number = new_next_page_number;
     }
 
     /**
@@ -298,7 +360,7 @@ namespace badgerdb
 
     /**
      * Inserts record data into the given slot.  The slot should not be currently
-     * in use.  <slot_number> must be less than <header_.num_slots>.
+     * in use.  <slot_number> must be less than <header_->num_slots>.
      *
      * Callers are responsible for making sure there is enough space to hold the
      * record before calling this method.
@@ -330,18 +392,29 @@ namespace badgerdb
     bool isUsed() const { return page_number() != INVALID_NUMBER; }
 
     /**
-     * Header metadata.
+     * Start of the SIZE bytes of the page, as stored on disk.
+     */
+    char *memory_;
+
+    /**
+     * Whether memory_ was allocated by this page and is freed with it.
      */
-    PageHeader header_;
+    bool owns_memory_;
 
     /**
-     * Data stored on the page.  Includes bookkeeping information about slots as
-     * well as actual content.
+     * Header metadata, at the start of memory_.
      */
+    PageHeader *header_;
 
-    std::string data_;
+    /**
+     * Data stored on the page, after the header.  Includes bookkeeping
+     * information about slots as well as actual content.
+     */
+    char *data_;
 
     friend class File;
+    friend class MappedFile;
+    friend class PageBufferManager;
     friend class PageIterator;
     friend class PageTest;
     friend class BufferTest;
@@ -2,254 +2,1252 @@
  * @author Ajinkya Bokade (A59019743) and Shanay Shah (A59010837)
  **/
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <new>
 
 #include "pagebuffer.h"
 #include "file_iterator.h"
+#include "mapped_file.h"
 #include "exceptions_header.h"
+#include "exceptions/invalid_page_exception.h"
+#include "exceptions/read_only_file_exception.h"
 
 namespace badgerdb
 {
 
-	PageBufferManager::PageBufferManager(std::uint32_t buffers)
-		: numBufs(buffers)
+	const FrameId PageBufferManager::NO_FRAME;
+	const std::uint32_t PageBufferManager::WRITE_BACK_THREADS;
+
+	PageBufferManager::PageBufferManager(std::uint32_t buffers, ReplacementPolicyType policyType,
+										 const PoolMemoryConfig &memory)
+		: numBufs(buffers), mappedFileCount(0), flushesInProgress(0), unpinSignals(0), unpinWaiters(0)
 	{
-		bufferStatTable = new BufferStatus[buffers];
+		bufferStatTable = new FrameTable(buffers, memory);
 
+		// One mapping holds every frame; the pages are views over its slices
+		poolMemory = new PoolMemory((std::size_t)buffers * Page::SIZE, memory);
+		pageBufferPool = static_cast<Page *>(::operator new(sizeof(Page) * buffers));
 		for (FrameId i = 0; i < buffers; i++)
 		{
-			bufferStatTable[i].frameNo = i;
-			bufferStatTable[i].valid = false;
+			new (&pageBufferPool[i]) Page(poolMemory->data() + (std::size_t)i * Page::SIZE);
 		}
 
-		pageBufferPool = new Page[buffers];
+		hashTable = new BufHashTbl(buffers); // allocate the buffer hash table
+
+		policy = ReplacementPolicy::create(policyType, buffers, bufferStatTable);
 
-		int htsize = ((((int)(buffers * 1.2)) * 2) / 2) + 1;
-		hashTable = new BufHashTbl(htsize); // allocate the buffer hash table
+		ioEngine = IoEngine::create();
 
-		clockHand = buffers - 1;
+		// Scans cycle through a ring of at most 32 frames (256KB), one-shot reads through one
+		scanRing.frames.assign(std::max<std::uint32_t>(1, std::min<std::uint32_t>(32, buffers / 8)), NO_FRAME);
+		scanRing.next = 0;
+		oneShotRing.frames.assign(1, NO_FRAME);
+		oneShotRing.next = 0;
+
+		readAhead = 0;
+		prefetchActive = NULL;
+		prefetchStop = false;
+		prefetchThread = std::thread(&PageBufferManager::prefetchWorker, this);
+		writerStop = false;
 	}
 
 	PageBufferManager::~PageBufferManager()
 	{
 		// BEGINNING of your solution -- do not remove this comment
-		for (FrameId i = 0; i < numBufs; i++)
+		// Let asynchronous reads complete while the frames they publish still exist
+		delete ioEngine;
 		{
-			// Flush out all dirty pages
-			if (bufferStatTable[i].dirty)
-			{
-				File *file = bufferStatTable[i].file;
-				file->writePage(pageBufferPool[i]);
-			}
+			std::lock_guard<std::mutex> prefetchGuard(prefetchLatch);
+			prefetchStop = true;
 		}
+		prefetchQueued.notify_all();
+		prefetchThread.join();
+		stopBackgroundWriter();
+		// Flush out all dirty pages
+		writeBackAll();
 		// Reclaim the heap memory
-		delete[] bufferStatTable;
-		delete[] pageBufferPool;
+		delete policy;
+		delete bufferStatTable;
+		for (FrameId i = 0; i < numBufs; i++)
+		{
+			pageBufferPool[i].~Page();
+		}
+		::operator delete(pageBufferPool);
+		delete poolMemory;
 		delete hashTable;
 		// END of your solution -- do not remove this comment
 	}
 
-	void PageBufferManager::readPage(File *file, const PageId pageNumber, Page *&page)
+	void PageBufferManager::readPage(File *file, const PageId pageNumber, Page *&page, const AccessHint hint)
 	{
 		// BEGINNING of your solution -- do not remove this comment
 		FrameId frameNo;
-		try
+		bool hit;
+		std::uint32_t epoch;
+		bufStats.accesses++;
 		{
-			// Check whether the page is already in buffer pool
-			hashTable->lookup(file, pageNumber, frameNo);
-			bufferStatTable[frameNo].refbit = true;
-			bufferStatTable[frameNo].pinCnt += 1;
-			page = &pageBufferPool[frameNo];
+			// Check whether the page is already in buffer pool. The pin is taken under
+			// the partition latch so the page cannot be evicted in between.
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+			hit = hashTable->tryLookup(file, pageNumber, frameNo);
+			epoch = hashTable->epoch(file, pageNumber);
+			if (hit)
+			{
+				// Scans do not make pages look hot; a normal access to a page loaded by
+				// a scan takes it out of the ring
+				if (hint == AccessHint::NORMAL)
+				{
+					policy->recordAccess(frameNo);
+					bufferStatTable->setInRing(frameNo, false);
+				}
+				bufferStatTable->pin(frameNo);
+			}
+		}
+		if (readAhead > 0)
+		{
+			// Queue the next pages before reading this one so both reads overlap
+			detectSequential(file, pageNumber, hint);
 		}
-		catch (HashNotFoundException hashNotFoundException)
+		if (hit)
 		{
-			// Allocate new buffer frame and read the page into the buffer pool.
-			allocateBuffer(frameNo);
-			pageBufferPool[frameNo] = file->readPage(pageNumber);
 			page = &pageBufferPool[frameNo];
-			hashTable->insert(file, pageNumber, frameNo);
-			bufferStatTable[frameNo].Set(file, pageNumber);
+			return;
 		}
+		// Allocate new buffer frame and read the page into the buffer pool.
+		allocateBuffer(frameNo, hint);
+		// Another thread may have read the same page meanwhile, in which case we
+		// get its frame back instead of ours. If it also wrote the page back, our
+		// copy may be older than the disk and is read again.
+		do
+		{
+			try
+			{
+				// Page reads are positional and need no ioLatch
+				fillFrame(file, pageNumber, frameNo);
+			}
+			catch (...)
+			{
+				releaseFrame(frameNo);
+				throw;
+			}
+		} while (!publishReadFrame(file, pageNumber, frameNo, epoch));
+		page = &pageBufferPool[frameNo];
 		// END of your solution -- do not remove this comment
 	}
 
+	std::future<Page *> PageBufferManager::readPageAsync(File *file, const PageId pageNumber)
+	{
+		std::shared_ptr<std::promise<Page *>> promise(new std::promise<Page *>());
+		std::future<Page *> result = promise->get_future();
+		FrameId frameNo;
+		std::uint32_t epoch;
+		bufStats.accesses++;
+		{
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+			if (hashTable->tryLookup(file, pageNumber, frameNo))
+			{
+				policy->recordAccess(frameNo);
+				bufferStatTable->setInRing(frameNo, false);
+				bufferStatTable->pin(frameNo);
+				promise->set_value(&pageBufferPool[frameNo]);
+				return result;
+			}
+			epoch = hashTable->epoch(file, pageNumber);
+		}
+		allocateBuffer(frameNo, AccessHint::NORMAL);
+		if (mappedFileOf(file) != NULL)
+		{
+			// Served from the mapping as readPage() does: there is nothing to wait for
+			try
+			{
+				do
+				{
+					try
+					{
+						fillFrame(file, pageNumber, frameNo);
+					}
+					catch (...)
+					{
+						releaseFrame(frameNo);
+						throw;
+					}
+				} while (!publishReadFrame(file, pageNumber, frameNo, epoch));
+			}
+			catch (...)
+			{
+				promise->set_exception(std::current_exception());
+				return result;
+			}
+			promise->set_value(&pageBufferPool[frameNo]);
+			return result;
+		}
+		try
+		{
+			file->readPageAsync(*ioEngine, pageNumber, pageBufferPool[frameNo],
+								[this, file, pageNumber, frameNo, epoch, promise](bool read)
+								{
+									if (!read)
+									{
+										releaseFrame(frameNo);
+										promise->set_exception(std::make_exception_ptr(InvalidPageException(pageNumber, file->filename())));
+										return;
+									}
+									bufStats.diskreads++;
+									FrameId published = frameNo;
+									std::uint32_t readEpoch = epoch;
+									try
+									{
+										while (!publishReadFrame(file, pageNumber, published, readEpoch))
+										{
+											// Evicted during the read. Read it again right here: waiting
+											// for the engine from its own thread could deadlock.
+											try
+											{
+												fillFrame(file, pageNumber, frameNo);
+											}
+											catch (...)
+											{
+												releaseFrame(frameNo);
+												throw;
+											}
+										}
+									}
+									catch (...)
+									{
+										promise->set_exception(std::current_exception());
+										return;
+									}
+									promise->set_value(&pageBufferPool[published]);
+								});
+		}
+		catch (...)
+		{
+			releaseFrame(frameNo);
+			throw;
+		}
+		return result;
+	}
+
 	void PageBufferManager::allocatePage(File *file, PageId &pageNumber, Page *&page)
 	{
 		// BEGINNING of your solution -- do not remove this comment
 		FrameId frameNo;
-		// Allocate a new buffer from available frames using clock algorithm
-		allocateBuffer(frameNo);
+		if (mappedFileOf(file) != NULL)
+		{
+			throw ReadOnlyFileException(file->filename());
+		}
+		bufStats.accesses++;
+		// Allocate a new buffer from available frames using the replacement policy
+		allocateBuffer(frameNo, AccessHint::NORMAL);
 		page = &pageBufferPool[frameNo];
-		// Allocate page on the file
-		*page = file->allocatePage();
+		try
+		{
+			// Allocate page on the file
+			std::lock_guard<std::mutex> ioGuard(ioLatch);
+			file->allocatePageInto(*page);
+			bufStats.diskreads++;
+		}
+		catch (...)
+		{
+			releaseFrame(frameNo);
+			throw;
+		}
 		// Set page number of the newly allocated page
 		pageNumber = page->page_number();
-		// Set the entries in the buffer stat table
-		bufferStatTable[frameNo].Set(file, pageNumber);
-		// Insert the file, page and frame entry in the hash table
-		hashTable->insert(file, pageNumber, frameNo);
+		// Set the entries in the buffer stat table and insert the file, page and
+		// frame entry in the hash table
+		publishFrame(file, pageNumber, frameNo);
 		// END of your solution -- do not remove this comment
 	}
 
+	void PageBufferManager::allocatePages(File *file, const std::uint32_t count, std::vector<PageId> &pageNumbers, std::vector<Page *> &pages, const bool preallocate)
+	{
+		pageNumbers.clear();
+		pages.clear();
+		if (mappedFileOf(file) != NULL)
+		{
+			throw ReadOnlyFileException(file->filename());
+		}
+		std::vector<FrameId> frames;
+		try
+		{
+			// Take every frame before touching the file, so a full pool allocates nothing
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				FrameId frameNo;
+				allocateBuffer(frameNo, AccessHint::NORMAL);
+				frames.push_back(frameNo);
+				pages.push_back(&pageBufferPool[frameNo]);
+			}
+			std::lock_guard<std::mutex> ioGuard(ioLatch);
+			file->allocatePagesInto(pages, preallocate);
+		}
+		catch (...)
+		{
+			for (std::size_t i = 0; i < frames.size(); i++)
+			{
+				releaseFrame(frames[i]);
+			}
+			pages.clear();
+			throw;
+		}
+		bufStats.accesses += count;
+		bufStats.diskreads += count;
+
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
+		for (std::uint32_t i = 0; i < count; i++)
+		{
+			const PageId pageNumber = pages[i]->page_number();
+			try
+			{
+				if (!publishFrameLocked(file, pageNumber, frames[i]))
+				{
+					// Read by another thread since the file header was updated
+					pages[i] = &pageBufferPool[frames[i]];
+				}
+			}
+			catch (...)
+			{
+				// The failed frame is given back already. Unpin the pages published so far
+				// and give back the frames not published yet; the pages stay in the file.
+				for (std::uint32_t j = 0; j < i; j++)
+				{
+					std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumbers[j]));
+					unpinFrame(frames[j]);
+				}
+				for (std::uint32_t j = i + 1; j < count; j++)
+				{
+					releaseFrameLocked(frames[j]);
+				}
+				pageNumbers.clear();
+				pages.clear();
+				throw;
+			}
+			pageNumbers.push_back(pageNumber);
+		}
+	}
+
 	void PageBufferManager::unPinPage(File *file, const PageId pageNumber, const bool dirty)
 	{
 		// BEGINNING of your solution -- do not remove this comment
 		FrameId frameNo;
-		try
+		const bool readOnly = dirty && mappedFileOf(file) != NULL;
 		{
-			hashTable->lookup(file, pageNumber, frameNo);
-			if (bufferStatTable[frameNo].pinCnt == 0)
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+			if (!hashTable->tryLookup(file, pageNumber, frameNo))
+			{
+				throw HashNotFoundException(file->filename(), pageNumber);
+			}
+			if (bufferStatTable->pinCount(frameNo) == 0)
 			{
 				// Throw page not pinned exception if pin count is 0
 				throw PageNotPinnedException(file->filename(), pageNumber, frameNo);
 			}
-			if (dirty)
+			if (dirty && !readOnly)
 			{
 				// Set dirty bit to true if dirty paramter is true
-				bufferStatTable[frameNo].dirty = true;
+				bufferStatTable->setDirty(frameNo, true);
 			}
-			bufferStatTable[frameNo].pinCnt -= 1;
+			unpinFrame(frameNo);
 		}
-		catch (HashNotFoundException hashNotFoundException)
+		if (readOnly)
 		{
-			throw HashNotFoundException(file->filename(), pageNumber);
+			// Unpinned all the same, so the caller's pin is not leaked
+			throw ReadOnlyFileException(file->filename());
 		}
 		// END of your solution -- do not remove this comment
 	}
 
+	void PageBufferManager::unpinFrame(const FrameId frame)
+	{
+		bufferStatTable->unpin(frame);
+		if (bufferStatTable->pinCount(frame) == 0 && unpinWaiters.load() > 0)
+		{
+			{
+				std::lock_guard<std::mutex> unpinGuard(unpinLatch);
+				unpinSignals++;
+			}
+			pageUnpinned.notify_all();
+		}
+	}
+
 	void PageBufferManager::disposePage(File *file, const PageId pageNumber)
 	{
 		// BEGINNING of your solution -- do not remove this comment
 		FrameId frameNo;
-		try
+		if (mappedFileOf(file) != NULL)
 		{
-			hashTable->lookup(file, pageNumber, frameNo);
+			throw ReadOnlyFileException(file->filename());
+		}
+		{
+			std::lock_guard<std::mutex> clockGuard(clockLatch);
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+			if (!hashTable->tryLookup(file, pageNumber, frameNo))
+			{
+				throw HashNotFoundException(file->filename(), pageNumber);
+			}
 			// Clear buffer state table entries
-			bufferStatTable[frameNo].Clear();
+			bufferStatTable->clear(frameNo);
+			policy->recordRemove(frameNo);
 			// Remove entry from the hash table
 			hashTable->remove(file, pageNumber);
-			// Delete the page from the file
-			file->deletePage(pageNumber);
+			bufferStatTable->pushFree(frameNo);
 		}
-		catch (HashNotFoundException hashNotFoundException)
+		// Delete the page from the file
+		std::lock_guard<std::mutex> ioGuard(ioLatch);
+		file->deletePage(pageNumber);
+		// END of your solution -- do not remove this comment
+	}
+
+	void PageBufferManager::registerMappedFile(const MappedFile *file)
+	{
+		std::lock_guard<std::mutex> mappedGuard(mappedLatch);
+		if (mappedFiles.insert(std::make_pair(static_cast<const File *>(file), file)).second)
 		{
-			throw HashNotFoundException(file->filename(), pageNumber);
+			mappedFileCount++;
 		}
-		// END of your solution -- do not remove this comment
 	}
 
-	void PageBufferManager::advanceClock()
+	void PageBufferManager::unregisterMappedFile(const MappedFile *file)
 	{
-		// BEGINNING of your solution -- do not remove this comment
-		// Advance clock to the next frame in the buffer pool.
-		clockHand = (clockHand + 1) % numBufs;
-		// END of your solution -- do not remove this comment
+		// No frame views the mapping once the pages are out of the pool
+		flushFile(file);
+		std::lock_guard<std::mutex> mappedGuard(mappedLatch);
+		if (mappedFiles.erase(file) != 0)
+		{
+			mappedFileCount--;
+		}
 	}
 
-	void PageBufferManager::allocateBuffer(FrameId &frame)
+	void PageBufferManager::allocateBuffer(FrameId &frame, const AccessHint hint)
 	{
 		// BEGINNING of your solution -- do not remove this comment
-		// Allocates a free frame using the clock algorithm
+		// Allocates a free frame, or one chosen by the replacement policy
 		// If necessary, writing a dirty page back to disk
-		uint32_t nPinnedPages = 0;
+		if (hint == AccessHint::NORMAL && flushesInProgress.load() == 0 && bufferStatTable->popFree(frame))
+		{
+			// Warm-up and frames given back: no sweep and no clockLatch
+			viewFrame(frame, poolMemory->data() + (std::size_t)frame * Page::SIZE);
+			return;
+		}
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
+		BufferRing *ring = NULL;
+		std::uint32_t slot = 0;
+		if (hint != AccessHint::NORMAL)
+		{
+			// Recycle the frame this ring slot used last time, if it still holds an
+			// unpinned page loaded through the ring
+			ring = hint == AccessHint::SEQUENTIAL_SCAN ? &scanRing : &oneShotRing;
+			slot = ring->next;
+			ring->next = (ring->next + 1) % ring->frames.size();
+			const FrameId previous = ring->frames[slot];
+			if (previous != NO_FRAME && bufferStatTable->isInRing(previous) &&
+				bufferStatTable->pinCount(previous) == 0 && evictFrame(previous))
+			{
+				frame = previous;
+				bufferStatTable->setInRing(frame, true);
+				viewFrame(frame, poolMemory->data() + (std::size_t)frame * Page::SIZE);
+				return;
+			}
+		}
+
+		while (!bufferStatTable->popFree(frame))
+		{
+			FrameId victim;
+			if (!policy->pickVictim(victim))
+			{
+				// All pages are pinned, unless a frame was given back meanwhile
+				if (bufferStatTable->popFree(frame))
+				{
+					break;
+				}
+				// All pages are pinned, then throw buffer exceeded exception
+				throw BufferExceededException();
+			}
+			if (evictFrame(victim))
+			{
+				frame = victim;
+				break;
+			}
+		}
+		if (ring)
+		{
+			ring->frames[slot] = frame;
+			bufferStatTable->setInRing(frame, true);
+		}
+		// The frame may still view the mapping of a file it held a page of
+		viewFrame(frame, poolMemory->data() + (std::size_t)frame * Page::SIZE);
+		// END of your solution -- do not remove this comment
+	}
+
+	/**
+	 * Runs task(0) to task(count - 1) on up to the given number of threads
+	 */
+	static void runParallel(const std::size_t count, const std::uint32_t threads, const std::function<void(std::size_t)> &task)
+	{
+		std::atomic<std::size_t> next(0);
+		std::vector<std::thread> workers;
+		for (std::uint32_t t = 0; t < std::min<std::size_t>(threads, count); t++)
+		{
+			workers.push_back(std::thread([&next, count, &task]()
+										  {
+				for (std::size_t i; (i = next++) < count;)
+				{
+					task(i);
+				} }));
+		}
+		for (std::size_t t = 0; t < workers.size(); t++)
+		{
+			workers[t].join();
+		}
+	}
+
+	void PageBufferManager::writeBackAll()
+	{
+		// Group the dirty pages by file
+		std::map<File *, std::vector<const Page *>> dirtyPages;
+		for (std::uint32_t w = 0; w < bufferStatTable->words(); w++)
+		{
+			for (std::uint64_t bits = bufferStatTable->dirtyWord(w); bits != 0; bits &= bits - 1)
+			{
+				const FrameId i = w * FrameTable::WORD_BITS + __builtin_ctzll(bits);
+				dirtyPages[bufferStatTable->file(i)].push_back(&pageBufferPool[i]);
+			}
+		}
+
+		// Cut each file's pages, in page number order, into chunks written sequentially
+		std::vector<File *> files;
+		std::vector<File *> chunkFiles;
+		std::vector<std::vector<const Page *>> chunks;
+		for (std::map<File *, std::vector<const Page *>>::iterator it = dirtyPages.begin(); it != dirtyPages.end(); ++it)
+		{
+			std::vector<const Page *> &pages = it->second;
+			std::sort(pages.begin(), pages.end(), [](const Page *a, const Page *b)
+					  { return a->page_number() < b->page_number(); });
+			for (std::size_t start = 0; start < pages.size(); start += WRITE_BACK_CHUNK)
+			{
+				chunkFiles.push_back(it->first);
+				chunks.push_back(std::vector<const Page *>(pages.begin() + start,
+														   pages.begin() + std::min<std::size_t>(start + WRITE_BACK_CHUNK, pages.size())));
+			}
+			files.push_back(it->first);
+		}
+
+		// Chunks cover disjoint pages, so they are written concurrently; then each file
+		// is synced once all of its chunks are written
+		const std::uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+		const std::uint32_t threads = (std::uint32_t)std::min<std::size_t>(std::min(WRITE_BACK_THREADS, cores), chunks.size());
+		runParallel(chunks.size(), threads, [&](std::size_t i)
+					{
+			try
+			{
+				chunkFiles[i]->writePages(chunks[i]);
+			}
+			catch (const std::exception &e)
+			{
+				// A destructor cannot throw it; the other chunks are still written
+				reportWriteBackFailure(chunkFiles[i], "write back", e.what());
+			} });
+		runParallel(files.size(), threads, [&](std::size_t i)
+					{
+			try
+			{
+				files[i]->sync();
+			}
+			catch (const std::exception &e)
+			{
+				// Likewise; the other files are still synced
+				reportWriteBackFailure(files[i], "sync", e.what());
+			} });
+	}
+
+	void PageBufferManager::reportWriteBackFailure(const File *file, const char *step, const char *reason)
+	{
+		// One string per line, so that lines of concurrent failures do not interleave
+		std::cerr << std::string("PageBufferManager: failed to ") + step + " dirty pages of " +
+						 file->filename() + ": " + reason + "\n";
+	}
+
+	bool PageBufferManager::evictFrame(const FrameId victim)
+	{
+		// Hold the partition latch of the victim so that no thread can pin it
+		// while it is written back and removed from the hash table.
+		File *file = bufferStatTable->file(victim);
+		PageId pageNo = bufferStatTable->pageNo(victim);
+		std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+		if (bufferStatTable->pinCount(victim) > 0)
+		{
+			// Pinned by a buffer hit since the victim was chosen
+			return false;
+		}
+		if (bufferStatTable->isDirty(victim))
+		{
+			// Write to disk if page is dirty
+			std::lock_guard<std::mutex> ioGuard(ioLatch);
+			file->writePage(pageBufferPool[victim]);
+			bufStats.diskwrites++;
+			bufStats.foregroundwrites++;
+		}
+		// Remove entry from hash table since the frame has a valid page in it
+		hashTable->remove(file, pageNo);
+		policy->recordEvict(victim);
+		bufferStatTable->reserve(victim);
+		return true;
+	}
+
+	bool PageBufferManager::publishFrame(File *file, const PageId pageNumber, FrameId &frame)
+	{
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
+		return publishFrameLocked(file, pageNumber, frame);
+	}
+
+	bool PageBufferManager::publishFrameLocked(File *file, const PageId pageNumber, FrameId &frame)
+	{
+		std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+		FrameId existingFrame;
+		if (!hashTable->tryLookup(file, pageNumber, existingFrame))
+		{
+			try
+			{
+				hashTable->insert(file, pageNumber, frame);
+			}
+			catch (...)
+			{
+				// The partition is full: give the frame back so the caller leaks nothing
+				releaseFrameLocked(frame);
+				throw;
+			}
+			bufferStatTable->set(frame, file, pageNumber);
+			policy->recordInsert(frame, file, pageNumber);
+			return true;
+		}
+		// Lost the race to another reader of the same page, so pin its frame
+		policy->recordAccess(existingFrame);
+		bufferStatTable->pin(existingFrame);
+		releaseFrameLocked(frame);
+		frame = existingFrame;
+		return false;
+	}
+
+	bool PageBufferManager::publishReadFrame(File *file, const PageId pageNumber, FrameId &frame, std::uint32_t &epoch)
+	{
+		// Pages only leave the hash table under clockLatch, so none can between the
+		// check and the publication
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
+		{
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+			const std::uint32_t current = hashTable->epoch(file, pageNumber);
+			FrameId existingFrame;
+			if (current != epoch && !hashTable->tryLookup(file, pageNumber, existingFrame))
+			{
+				epoch = current;
+				return false;
+			}
+		}
+		publishFrameLocked(file, pageNumber, frame);
+		return true;
+	}
+
+	const MappedFile *PageBufferManager::mappedFileOf(const File *file)
+	{
+		if (mappedFileCount.load() == 0)
+		{
+			return NULL;
+		}
+		std::lock_guard<std::mutex> mappedGuard(mappedLatch);
+		std::unordered_map<const File *, const MappedFile *>::const_iterator it = mappedFiles.find(file);
+		return it != mappedFiles.end() ? it->second : NULL;
+	}
+
+	void PageBufferManager::fillFrame(File *file, const PageId pageNumber, const FrameId frame)
+	{
+		const MappedFile *mapped = mappedFileOf(file);
+		char *memory = mapped != NULL ? mapped->pageMemory(pageNumber) : NULL;
+		if (memory != NULL)
+		{
+			viewFrame(frame, memory);
+			return;
+		}
+		file->readPageInto(pageNumber, pageBufferPool[frame]);
+		bufStats.diskreads++;
+	}
+
+	void PageBufferManager::viewFrame(const FrameId frame, char *memory)
+	{
+		pageBufferPool[frame].view(memory);
+	}
+
+	void PageBufferManager::releaseFrame(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
+		releaseFrameLocked(frame);
+	}
+
+	void PageBufferManager::releaseFrameLocked(const FrameId frame)
+	{
+		bufferStatTable->clear(frame);
+		policy->recordRemove(frame);
+		bufferStatTable->pushFree(frame);
+	}
+
+	void PageBufferManager::prefetch(File *file, const PageId first, const std::uint32_t count, const AccessHint hint)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		PrefetchRequest request = {file, first, count, hint};
+		{
+			std::lock_guard<std::mutex> prefetchGuard(prefetchLatch);
+			prefetchQueue.push_back(request);
+		}
+		prefetchQueued.notify_one();
+	}
+
+	void PageBufferManager::prefetchWorker()
+	{
+		std::unique_lock<std::mutex> prefetchGuard(prefetchLatch);
 		while (true)
 		{
-			// For the first time, allocating buffer when isValid is false
-			if (!bufferStatTable[clockHand].valid)
+			while (!prefetchStop && prefetchQueue.empty())
+			{
+				prefetchQueued.wait(prefetchGuard);
+			}
+			if (prefetchStop)
+			{
+				return;
+			}
+			// Take one page at a time so that cancelPrefetch() can drop the rest of a run
+			PrefetchRequest &request = prefetchQueue.front();
+			File *file = request.file;
+			const PageId pageNumber = request.first;
+			const AccessHint hint = request.hint;
+			request.first++;
+			if (--request.count == 0)
+			{
+				prefetchQueue.pop_front();
+			}
+			prefetchActive = file;
+			prefetchGuard.unlock();
+			prefetchPage(file, pageNumber, hint);
+			prefetchGuard.lock();
+			prefetchActive = NULL;
+			prefetchDone.notify_all();
+		}
+	}
+
+	void PageBufferManager::prefetchPage(File *file, const PageId pageNumber, const AccessHint hint)
+	{
+		FrameId frameNo;
+		std::uint32_t epoch;
+		{
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+			if (hashTable->tryLookup(file, pageNumber, frameNo))
+			{
+				return;
+			}
+			epoch = hashTable->epoch(file, pageNumber);
+		}
+		try
+		{
+			allocateBuffer(frameNo, hint);
+		}
+		catch (BufferExceededException &)
+		{
+			// Every frame is pinned; reading ahead must not fail anyone
+			return;
+		}
+		try
+		{
+			fillFrame(file, pageNumber, frameNo);
+			bufStats.prefetches++;
+		}
+		catch (BadgerDbException &)
+		{
+			// Past the end of the file or a deleted page
+			releaseFrame(frameNo);
+			return;
+		}
+		try
+		{
+			if (!publishReadFrame(file, pageNumber, frameNo, epoch))
 			{
-				frame = clockHand;
-				bufferStatTable[clockHand].Clear();
+				// Evicted during the read, so the copy may be stale; reading ahead can skip it
+				releaseFrame(frameNo);
 				return;
 			}
-			else if (bufferStatTable[clockHand].pinCnt > 0)
+		}
+		catch (BadgerDbException &)
+		{
+			// No room in the hash table; the frame is given back already
+			return;
+		}
+		// Leave the page unpinned, as if it had been read and released
+		std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNumber));
+		unpinFrame(frameNo);
+	}
+
+	void PageBufferManager::detectSequential(File *file, const PageId pageNumber, const AccessHint hint)
+	{
+		std::uint32_t window = readAhead;
+		if (hint == AccessHint::ONE_SHOT)
+		{
+			return;
+		}
+		if (hint == AccessHint::SEQUENTIAL_SCAN)
+		{
+			// Pages read further ahead would be recycled by the ring before they are used
+			window = std::min<std::uint32_t>(window, scanRing.frames.size() / 2);
+			if (window == 0)
 			{
-				nPinnedPages += 1;
-				advanceClock();
+				return;
 			}
-			else if (bufferStatTable[clockHand].refbit)
+		}
+
+		std::lock_guard<std::mutex> prefetchGuard(prefetchLatch);
+		std::unordered_map<const File *, SequentialState>::iterator it = sequentialState.find(file);
+		if (it == sequentialState.end())
+		{
+			SequentialState state = {pageNumber, 1, pageNumber};
+			sequentialState[file] = state;
+			return;
+		}
+		SequentialState &state = it->second;
+		if (pageNumber == state.lastPage + 1)
+		{
+			state.runLength++;
+		}
+		else if (pageNumber != state.lastPage)
+		{
+			state.runLength = 1;
+			state.prefetchedTo = pageNumber;
+		}
+		state.lastPage = pageNumber;
+		// Queue the next half window at a time once the reader has used half of it
+		if (state.runLength >= SEQUENTIAL_THRESHOLD && state.prefetchedTo <= pageNumber + window / 2)
+		{
+			const PageId first = std::max(state.prefetchedTo, pageNumber) + 1;
+			const PageId last = pageNumber + window;
+			PrefetchRequest request = {file, first, last - first + 1, hint};
+			prefetchQueue.push_back(request);
+			state.prefetchedTo = last;
+			prefetchQueued.notify_one();
+		}
+	}
+
+	void PageBufferManager::cancelPrefetch(const File *file)
+	{
+		std::unique_lock<std::mutex> prefetchGuard(prefetchLatch);
+		for (std::deque<PrefetchRequest>::iterator it = prefetchQueue.begin(); it != prefetchQueue.end();)
+		{
+			if (it->file == file)
 			{
-				bufferStatTable[clockHand].refbit = false;
-				advanceClock();
+				it = prefetchQueue.erase(it);
 			}
 			else
 			{
-				if (bufferStatTable[clockHand].dirty)
-				{
-					// Write to disk if page is dirty
-					File *file = bufferStatTable[clockHand].file;
-					file->writePage(pageBufferPool[clockHand]);
-				}
-				// Remove entry from hash table if buffer frame has valid page in it
-				if (bufferStatTable[clockHand].valid)
-				{
-					File *file = bufferStatTable[clockHand].file;
-					PageId pageNo = bufferStatTable[clockHand].pageNo;
-					hashTable->remove(file, pageNo);
-				}
-				bufferStatTable[clockHand].Clear();
-				frame = clockHand;
+				++it;
+			}
+		}
+		sequentialState.erase(file);
+		while (prefetchActive == file)
+		{
+			prefetchDone.wait(prefetchGuard);
+		}
+	}
+
+	void PageBufferManager::startBackgroundWriter(const BackgroundWriterConfig &config)
+	{
+		std::lock_guard<std::mutex> writerGuard(writerLatch);
+		writerConfig = config;
+		if (writerThread.joinable())
+		{
+			writerWake.notify_all();
+			return;
+		}
+		writerStop = false;
+		writerThread = std::thread(&PageBufferManager::backgroundWriter, this);
+	}
+
+	void PageBufferManager::stopBackgroundWriter()
+	{
+		{
+			std::lock_guard<std::mutex> writerGuard(writerLatch);
+			if (!writerThread.joinable())
+			{
 				return;
 			}
-			// All pages are pinned, then throw buffer exceeded exception
-			if (nPinnedPages == numBufs)
+			writerStop = true;
+		}
+		writerWake.notify_all();
+		writerThread.join();
+	}
+
+	void PageBufferManager::backgroundWriter()
+	{
+		std::unique_lock<std::mutex> writerGuard(writerLatch);
+		std::uint32_t lookahead = 0;
+		while (!writerStop)
+		{
+			const BackgroundWriterConfig config = writerConfig;
+			writerGuard.unlock();
+			const bool behind = backgroundWriterRound(config, lookahead);
+			writerGuard.lock();
+			if (!behind && !writerStop)
 			{
-				throw BufferExceededException();
+				writerWake.wait_for(writerGuard, std::chrono::milliseconds(config.intervalMs));
 			}
 		}
-		// END of your solution -- do not remove this comment
 	}
 
-	void PageBufferManager::flushFile(const File *file)
+	bool PageBufferManager::backgroundWriterRound(const BackgroundWriterConfig &config, std::uint32_t &lookahead)
 	{
-		// BEGINNING of your solution -- do not remove this comment
-		// Iterate through all the pages of the file
-		for (FrameId i = 0; i < numBufs; i++)
+		// Count dirty frames like countDirtyPages, without the latch; an estimate will do
+		const std::uint32_t dirtyPages = bufferStatTable->countDirty();
+		const bool overLimit = dirtyPages > config.maxDirtyFraction * numBufs;
+		if (!overLimit || lookahead == 0)
+		{
+			lookahead = std::min(numBufs, config.pagesPerRound);
+		}
+		else
 		{
-			FrameId frameNo = i;
-			// If the page doesn't belong to the file, continue
-			if (bufferStatTable[frameNo].file != file)
+			lookahead = std::min(numBufs, 2 * lookahead);
+		}
+
+		// Collect the next victims and the pages they hold. Frames only change pages
+		// under clockLatch, so the hash table tells later whether a frame still holds it.
+		std::vector<FrameId> frames;
+		std::vector<File *> files;
+		std::vector<PageId> pageNos;
+		{
+			std::lock_guard<std::mutex> clockGuard(clockLatch);
+			policy->upcomingVictims(lookahead, frames);
+			for (std::size_t i = 0; i < frames.size(); i++)
+			{
+				files.push_back(bufferStatTable->file(frames[i]));
+				pageNos.push_back(bufferStatTable->pageNo(frames[i]));
+			}
+		}
+
+		std::uint32_t written = 0;
+		for (std::size_t i = 0; i < frames.size() && written < config.pagesPerRound; i++)
+		{
+			File *file = files[i];
+			const PageId pageNo = pageNos[i];
+			FrameId frameNo;
+			// The partition latch keeps the page from being pinned or evicted while it is written
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+			if (!hashTable->tryLookup(file, pageNo, frameNo) || frameNo != frames[i] ||
+				bufferStatTable->pinCount(frameNo) > 0 || !bufferStatTable->isDirty(frameNo))
 			{
 				continue;
 			}
-			PageId pageNo = bufferStatTable[frameNo].pageNo;
-			if (bufferStatTable[frameNo].pinCnt > 0)
+			try
 			{
-				File* file_ptr = bufferStatTable[frameNo].file;
-				// Throw page pinned exception if the page is pinned
-				throw PagePinnedException(file_ptr->filename(), pageNo, frameNo);
+				std::lock_guard<std::mutex> ioGuard(ioLatch);
+				file->writePage(pageBufferPool[frameNo]);
 			}
-			if (!bufferStatTable[frameNo].valid)
+			catch (BadgerDbException &)
 			{
-				// Throw bad buffer exception if the frame is not valid
-				throw BadBufferException(frameNo, bufferStatTable[frameNo].dirty, bufferStatTable[frameNo].valid, bufferStatTable[frameNo].refbit);
+				// Leave the page dirty; eviction will report the error to a caller
+				continue;
 			}
-			if (bufferStatTable[frameNo].dirty)
+			bufferStatTable->setDirty(frameNo, false);
+			bufStats.diskwrites++;
+			bufStats.backgroundwrites++;
+			written++;
+		}
+		// Keep going without a pause while there is still work within reach
+		return overLimit && written == config.pagesPerRound;
+	}
+
+	FlushSummary PageBufferManager::flushFile(const File *file, const FlushOptions &options)
+	{
+		// BEGINNING of your solution -- do not remove this comment
+		FlushSummary summary;
+		PinnedPageAction pinned = options.pinned;
+		if (pinned == PinnedPageAction::WAIT && options.waitTimeoutMs == 0)
+		{
+			// Nothing to wait for
+			pinned = PinnedPageAction::SKIP;
+		}
+		if (pinned != PinnedPageAction::WAIT)
+		{
+			return options.mode == FlushMode::CHECKPOINT ? checkpointFile(file, pinned)
+														 : removeFilePages(file, true, pinned);
+		}
+		const std::chrono::steady_clock::time_point deadline =
+			std::chrono::steady_clock::now() + std::chrono::milliseconds(options.waitTimeoutMs);
+		// Counted as a waiter throughout, so that no unpin after a round goes unnoticed
+		unpinWaiters++;
+		try
+		{
+			while (true)
+			{
+				std::uint64_t signals;
+				{
+					std::lock_guard<std::mutex> unpinGuard(unpinLatch);
+					signals = unpinSignals;
+				}
+				const FlushSummary round = options.mode == FlushMode::CHECKPOINT ? checkpointFile(file, pinned)
+																				 : removeFilePages(file, true, pinned);
+				summary.pagesWritten += round.pagesWritten;
+				summary.bytesWritten += round.bytesWritten;
+				summary.pagesSkipped = round.pagesSkipped;
+				if (round.pagesSkipped == 0)
+				{
+					break;
+				}
+				// Come back for the pages that were pinned once a page is unpinned
+				std::unique_lock<std::mutex> unpinGuard(unpinLatch);
+				const auto unpinned = [this, signals]()
+				{ return unpinSignals != signals; };
+				if (!pageUnpinned.wait_until(unpinGuard, deadline, unpinned))
+				{
+					// Out of time: a last round throws if a page is still pinned
+					pinned = PinnedPageAction::THROW;
+				}
+			}
+		}
+		catch (...)
+		{
+			unpinWaiters--;
+			throw;
+		}
+		unpinWaiters--;
+		return summary;
+		// END of your solution -- do not remove this comment
+	}
+
+	void PageBufferManager::evictFile(const File *file)
+	{
+		removeFilePages(file, false, PinnedPageAction::THROW);
+	}
+
+	FlushSummary PageBufferManager::removeFilePages(const File *file, const bool writeDirty, const PinnedPageAction pinnedAction)
+	{
+		// Read-ahead must not pin or load pages of the file while they are removed
+		cancelPrefetch(file);
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
+		// Take the frames of the file, found through its frame list, out of the hash
+		// table up to the first pinned page. A flush writes the dirty ones in one batch
+		// at the end, in page number order. The frames go on the free list only then.
+		// Readers of the pages miss and, while flushesInProgress is nonzero, wait for
+		// clockLatch to get a frame, so they only read the pages back once written.
+		if (writeDirty)
+		{
+			flushesInProgress++;
+		}
+		File *flushed = NULL;
+		std::vector<const Page *> dirtyPages;
+		std::vector<FrameId> frames;
+		std::vector<FrameId> freed;
+		bool pinned = false;
+		bool invalid = false;
+		FrameId frameNo = NO_FRAME;
+		PageId pageNo = Page::INVALID_NUMBER;
+		FlushSummary summary;
+		bufferStatTable->framesOf(file, frames);
+		for (std::size_t i = 0; i < frames.size(); i++)
+		{
+			frameNo = frames[i];
+			pageNo = bufferStatTable->pageNo(frameNo);
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNo));
+			if (bufferStatTable->pinCount(frameNo) > 0)
 			{
-				// Flush the page if its dirty
-				bufferStatTable[frameNo].file->writePage(pageBufferPool[frameNo]);
-				bufferStatTable[frameNo].dirty = false;
+				if (pinnedAction != PinnedPageAction::THROW)
+				{
+					summary.pagesSkipped++;
+					continue;
+				}
+				pinned = true;
+				break;
+			}
+			if (!bufferStatTable->isValid(frameNo))
+			{
+				invalid = true;
+				break;
+			}
+			if (writeDirty && bufferStatTable->isDirty(frameNo))
+			{
+				flushed = bufferStatTable->file(frameNo);
+				dirtyPages.push_back(&pageBufferPool[frameNo]);
 			}
 			// Remove the entry from the hash table and clear the corresponding frame
 			// in the buffer stat table, so that it can be set by the incoming request
 			hashTable->remove(file, pageNo);
-			bufferStatTable[frameNo].Clear();
+			bufferStatTable->clear(frameNo);
+			policy->recordRemove(frameNo);
+			freed.push_back(frameNo);
+		}
+
+		std::exception_ptr writeError;
+		try
+		{
+			if (!dirtyPages.empty())
+			{
+				// Flush the dirty pages
+				std::lock_guard<std::mutex> ioGuard(ioLatch);
+				flushed->writePages(dirtyPages);
+				bufStats.diskwrites += dirtyPages.size();
+				summary.pagesWritten = dirtyPages.size();
+				summary.bytesWritten = (std::uint64_t)dirtyPages.size() * Page::SIZE;
+			}
+		}
+		catch (...)
+		{
+			writeError = std::current_exception();
+		}
+		for (std::size_t i = 0; i < freed.size(); i++)
+		{
+			bufferStatTable->pushFree(freed[i]);
+		}
+		if (writeDirty)
+		{
+			flushesInProgress--;
+		}
+		if (writeError)
+		{
+			std::rethrow_exception(writeError);
+		}
+
+		if (pinned)
+		{
+			// Throw page pinned exception if the page is pinned
+			throw PagePinnedException(file->filename(), pageNo, frameNo);
+		}
+		if (invalid)
+		{
+			// Throw bad buffer exception if the frame is not valid
+			throw BadBufferException(frameNo, bufferStatTable->isDirty(frameNo), bufferStatTable->isValid(frameNo), bufferStatTable->isReferenced(frameNo));
+		}
+		return summary;
+	}
+
+	FlushSummary PageBufferManager::checkpointFile(const File *file, const PinnedPageAction pinnedAction)
+	{
+		// Read-ahead is left alone: the pages it loads are clean
+		std::vector<FrameId> frames;
+		std::vector<PageId> pageNos;
+		File *flushed = NULL;
+		{
+			// Frames only change pages under clockLatch, so the hash table tells later
+			// whether a frame still holds the page it held here
+			std::lock_guard<std::mutex> clockGuard(clockLatch);
+			bufferStatTable->framesOf(file, frames);
+			for (std::size_t i = 0; i < frames.size(); i++)
+			{
+				pageNos.push_back(bufferStatTable->pageNo(frames[i]));
+				flushed = bufferStatTable->file(frames[i]);
+			}
+		}
+
+		FlushSummary summary;
+		std::vector<Page> copies(std::min<std::size_t>(frames.size(), CHECKPOINT_BATCH));
+		std::vector<FrameId> copied;
+		std::size_t pinned = frames.size();
+		for (std::size_t i = 0; i < frames.size() && pinned == frames.size(); i++)
+		{
+			{
+				// The partition latch keeps the page from being pinned while it is copied
+				std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, pageNos[i]));
+				FrameId frameNo;
+				if (!hashTable->tryLookup(file, pageNos[i], frameNo) || frameNo != frames[i])
+				{
+					// Evicted since, and written then if it was dirty
+					continue;
+				}
+				if (bufferStatTable->pinCount(frameNo) > 0)
+				{
+					if (pinnedAction == PinnedPageAction::THROW)
+						pinned = i;
+					else
+						summary.pagesSkipped++;
+					continue;
+				}
+				if (!bufferStatTable->isDirty(frameNo))
+				{
+					continue;
+				}
+				// Pinned until written, so that it is not evicted clean and read back
+				// from disk before then. Changes made meanwhile dirty it again.
+				bufferStatTable->pin(frameNo);
+				bufferStatTable->setDirty(frameNo, false);
+				copies[copied.size()] = pageBufferPool[frameNo];
+				copied.push_back(frameNo);
+			}
+			if (copied.size() == copies.size())
+			{
+				writeCheckpointBatch(flushed, copies, copied, summary);
+			}
+		}
+		writeCheckpointBatch(flushed, copies, copied, summary);
+		if (pinned != frames.size())
+		{
+			// Throw page pinned exception if the page is pinned
+			throw PagePinnedException(file->filename(), pageNos[pinned], frames[pinned]);
+		}
+		return summary;
+	}
+
+	void PageBufferManager::writeCheckpointBatch(File *file, std::vector<Page> &copies, std::vector<FrameId> &frames, FlushSummary &summary)
+	{
+		if (frames.empty())
+		{
+			return;
+		}
+		std::vector<const Page *> pages;
+		for (std::size_t i = 0; i < frames.size(); i++)
+		{
+			pages.push_back(&copies[i]);
+		}
+		std::exception_ptr writeError;
+		try
+		{
+			std::lock_guard<std::mutex> ioGuard(ioLatch);
+			file->writePages(pages);
+			bufStats.diskwrites += pages.size();
+			summary.pagesWritten += pages.size();
+			summary.bytesWritten += (std::uint64_t)pages.size() * Page::SIZE;
+		}
+		catch (...)
+		{
+			writeError = std::current_exception();
+		}
+		for (std::size_t i = 0; i < frames.size(); i++)
+		{
+			std::lock_guard<std::mutex> partitionGuard(hashTable->partitionLatch(file, copies[i].page_number()));
+			if (writeError)
+			{
+				bufferStatTable->setDirty(frames[i], true);
+			}
+			unpinFrame(frames[i]);
+		}
+		frames.clear();
+		if (writeError)
+		{
+			std::rethrow_exception(writeError);
 		}
-		// END of your solution -- do not remove this comment
 	}
 
 	void PageBufferManager::printSelf(void)
 	{
-		BufferStatus *tempPageBuffer;
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
 		int validFrames = 0;
 
 		for (std::uint32_t i = 0; i < numBufs; i++)
 		{
-			tempPageBuffer = &(bufferStatTable[i]);
 			std::cout << "FrameNo:" << i << " ";
-			tempPageBuffer->Print();
+			bufferStatTable->print(i);
 
-			if (tempPageBuffer->valid == true)
+			if (bufferStatTable->isValid(i))
 				validFrames++;
 		}
 
@@ -260,16 +1258,8 @@ namespace badgerdb
 	{
 		// Counts all the dirty pages in the buffer pool which needs to be
 		// flushed
-		int dirtyPages = 0;
-		BufferStatus *tempPageBuffer;
-		for (std::uint32_t i = 0; i < numBufs; i++)
-		{
-			tempPageBuffer = &(bufferStatTable[i]);
-
-			if (tempPageBuffer->dirty == true)
-				dirtyPages++;
-		}
-		return dirtyPages;
+		std::lock_guard<std::mutex> clockGuard(clockLatch);
+		return bufferStatTable->countDirty();
 	}
 
 }
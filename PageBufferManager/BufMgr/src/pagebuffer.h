@@ -7,8 +7,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include "file.h"
 #include "bufHashTbl.h"
+#include "frame_table.h"
+#include "io_engine.h"
+#include "pool_memory.h"
+#include "replacement_policy.h"
 
 namespace badgerdb
 {
@@ -18,153 +31,303 @@ namespace badgerdb
 	 */
 	class PageBufferManager;
 
+	class MappedFile;
+
 	/**
-	 * @brief Class for maintaining information about buffer pool frames
+	 * @brief Class to maintain statistics of buffer usage
 	 */
-	class BufferStatus
+	struct BufStats
 	{
+		/**
+		 * Total number of accesses to buffer pool
+		 */
+		std::atomic<int> accesses;
 
-		friend class PageBufferManager;
+		/**
+		 * Number of pages read from disk (including allocs)
+		 */
+		std::atomic<int> diskreads;
 
-	private:
 		/**
-		 * Pointer to file to which corresponding frame is assigned
+		 * Number of pages written back to disk
 		 */
-		File *file;
+		std::atomic<int> diskwrites;
+
+		/**
+		 * Number of pages read ahead by the prefetcher (included in diskreads)
+		 */
+		std::atomic<int> prefetches;
 
 		/**
-		 * Page within file to which corresponding frame is assigned
+		 * Number of dirty pages written when their frame was reused, stalling the
+		 * readPage or allocatePage call that needed the frame (included in diskwrites)
 		 */
-		PageId pageNo;
+		std::atomic<int> foregroundwrites;
 
 		/**
-		 * Frame number of the frame, in the buffer pool, being used
+		 * Number of dirty pages written by the background writer (included in diskwrites)
 		 */
-		FrameId frameNo;
+		std::atomic<int> backgroundwrites;
+
+		/**
+		 * Clear all values
+		 */
+		void clear()
+		{
+			accesses = diskreads = diskwrites = prefetches = foregroundwrites = backgroundwrites = 0;
+		}
 
 		/**
-		 * Number of times this page has been pinned
+		 * Constructor of BufStats class
 		 */
-		int pinCnt;
+		BufStats()
+		{
+			clear();
+		}
+	};
 
+	/**
+	 * @brief How the caller of PageBufferManager::readPage is going to use the page
+	 */
+	enum class AccessHint
+	{
 		/**
-		 * True if page is dirty;  false otherwise
+		 * Regular access; the page competes for frames through the replacement policy
 		 */
-		bool dirty;
+		NORMAL,
 
 		/**
-		 * True if page is valid
+		 * Part of a sequential scan; on a miss the page goes into a small ring of
+		 * frames that is recycled by the scan instead of evicting other pages
 		 */
-		bool valid;
+		SEQUENTIAL_SCAN,
 
 		/**
-		 * Has this buffer frame been reference recently
+		 * Read once and not needed again; on a miss the page goes into a single
+		 * frame reused by the next one-shot read
 		 */
-		bool refbit;
+		ONE_SHOT
+	};
 
+	/**
+	 * @brief Frames reused round-robin by reads with a non-NORMAL AccessHint
+	 */
+	struct BufferRing
+	{
 		/**
-		 * Initialize buffer frame for a new user
+		 * Frame last used by each slot, or NO_FRAME
 		 */
-		void Clear()
-		{
-			pinCnt = 0;
-			file = NULL;
-			pageNo = Page::INVALID_NUMBER;
-			dirty = false;
-			refbit = false;
-			valid = false;
-		};
+		std::vector<FrameId> frames;
 
 		/**
-		 * Set values of member variables corresponding to assignment of frame to a page in the file. Called when a frame
-		 * in buffer pool is allocated to any page in the file through readPage() or allocPage()
-		 *
-		 * @param filePtr	File object
-		 * @param pageNum	Page number in the file
+		 * Next slot to use
 		 */
-		void Set(File *filePtr, PageId pageNum)
-		{
-			file = filePtr;
-			pageNo = pageNum;
-			pinCnt = 1;
-			dirty = false;
-			valid = true;
-			refbit = true;
-		}
+		std::uint32_t next;
+	};
 
-		void Print()
-		{
-			if (file)
-			{
-				std::cout << "file:" << file->filename() << " ";
-				std::cout << "pageNo:" << pageNo << " ";
-			}
-			else
-				std::cout << "file:NULL ";
-
-			std::cout << "valid:" << valid << " ";
-			std::cout << "pinCnt:" << pinCnt << " ";
-			std::cout << "dirty:" << dirty << " ";
-			std::cout << "refbit:" << refbit << "\n";
-		}
+	/**
+	 * @brief Tuning of the background writer
+	 */
+	struct BackgroundWriterConfig
+	{
+		/**
+		 * Fraction of the frames allowed to be dirty. Above it the writer looks further
+		 * ahead of the replacement policy and runs rounds back to back.
+		 */
+		double maxDirtyFraction;
+
+		/**
+		 * Maximum number of pages written per round
+		 */
+		std::uint32_t pagesPerRound;
+
+		/**
+		 * Pause between rounds, in milliseconds
+		 */
+		std::uint32_t intervalMs;
 
 		/**
-		 * Constructor of BufDesc class
+		 * Constructor of BackgroundWriterConfig class, with the default tuning
 		 */
-		BufferStatus()
+		BackgroundWriterConfig()
+			: maxDirtyFraction(0.1), pagesPerRound(32), intervalMs(20)
 		{
-			Clear();
 		}
 	};
 
 	/**
-	 * @brief Class to maintain statistics of buffer usage
+	 * @brief What flushFile does with the pages it writes
 	 */
-	struct BufStats
+	enum class FlushMode
 	{
 		/**
-		 * Total number of accesses to buffer pool
+		 * Write dirty pages and drop every page of the file from the pool
 		 */
-		int accesses;
+		EVICT,
 
 		/**
-		 * Number of pages read from disk (including allocs)
+		 * Write dirty unpinned pages and keep them in the pool, clean
 		 */
-		int diskreads;
+		CHECKPOINT
+	};
 
+	/**
+	 * @brief What flushFile does when it finds a pinned page
+	 */
+	enum class PinnedPageAction
+	{
 		/**
-		 * Number of pages written back to disk
+		 * Stop at the first pinned page and throw PagePinnedException
 		 */
-		int diskwrites;
+		THROW,
 
 		/**
-		 * Clear all values
+		 * Leave pinned pages alone and count them as skipped
 		 */
-		void clear()
+		SKIP,
+
+		/**
+		 * Come back to pinned pages each time a page is unpinned, until none is left
+		 * or FlushOptions::waitTimeoutMs passed, and then throw PagePinnedException.
+		 * Pins held by the calling thread are never released meanwhile: unpin them
+		 * first, or such a flush always runs into the timeout.
+		 */
+		WAIT
+	};
+
+	/**
+	 * @brief Options of PageBufferManager::flushFile
+	 */
+	struct FlushOptions
+	{
+		FlushMode mode;
+		PinnedPageAction pinned;
+
+		/**
+		 * Longest time WAIT waits for pinned pages in milliseconds. With 0 WAIT does
+		 * not wait at all and skips pinned pages as SKIP does.
+		 */
+		std::uint32_t waitTimeoutMs;
+
+		/**
+		 * Constructor of FlushOptions class: evict, and throw on pinned pages; WAIT
+		 * would wait up to a second
+		 */
+		FlushOptions()
+			: mode(FlushMode::EVICT), pinned(PinnedPageAction::THROW), waitTimeoutMs(1000)
 		{
-			accesses = diskreads = diskwrites = 0;
 		}
+	};
 
+	/**
+	 * @brief What a flushFile call did
+	 */
+	struct FlushSummary
+	{
 		/**
-		 * Constructor of BufStats class
+		 * Number of dirty pages written to the file
 		 */
-		BufStats()
+		std::uint32_t pagesWritten;
+
+		/**
+		 * Number of pinned pages left alone
+		 */
+		std::uint32_t pagesSkipped;
+
+		/**
+		 * Number of bytes written to the file
+		 */
+		std::uint64_t bytesWritten;
+
+		/**
+		 * Constructor of FlushSummary class, for a flush that did nothing
+		 */
+		FlushSummary()
+			: pagesWritten(0), pagesSkipped(0), bytesWritten(0)
 		{
-			clear();
 		}
 	};
 
 	/**
-	 * @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file
+	 * @brief Run of consecutive pages queued for the prefetcher
 	 */
-	class PageBufferManager
+	struct PrefetchRequest
+	{
+		/**
+		 * File to read from
+		 */
+		File *file;
+
+		/**
+		 * Next page of the run to read
+		 */
+		PageId first;
+
+		/**
+		 * Number of pages of the run left to read
+		 */
+		std::uint32_t count;
+
+		/**
+		 * Access hint the pages are read with
+		 */
+		AccessHint hint;
+	};
+
+	/**
+	 * @brief Recent reads of a file, used to detect sequential access
+	 */
+	struct SequentialState
 	{
-	private:
 		/**
-		 * Current position of clockhand in our buffer pool
+		 * Page read most recently
 		 */
-		FrameId clockHand;
+		PageId lastPage;
 
+		/**
+		 * Number of consecutive page numbers read up to lastPage
+		 */
+		std::uint32_t runLength;
+
+		/**
+		 * Last page already queued for read-ahead
+		 */
+		PageId prefetchedTo;
+	};
+
+	/**
+	 * @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file
+	 *
+	 * The manager may be shared by several threads. Latches are taken in this order:
+	 * - clockLatch: victim selection, frame assignment (file, pageNo, valid) and eviction
+	 * - the hash table partition latch of a page: lookup plus pin/unpin of that page
+	 * - ioLatch: calls into File that write pages or change the file header and
+	 *   page lists, which are not threadsafe. Page reads are positional and run
+	 *   concurrently without it.
+	 *
+	 * The files registered with registerMappedFile() are guarded by mappedLatch, which
+	 * is never held while taking any other latch.
+	 *
+	 * Buffer hits only take the partition latch (and, for policies other than the
+	 * clock, the policy's own latch), so they proceed while another thread looks for
+	 * a victim.
+	 *
+	 * A prefetch thread reads pages ahead of time into unpinned frames, either on
+	 * request (prefetch()) or when readPage() sees consecutive page numbers of a file
+	 * and read-ahead is enabled (setReadAhead()). Its queue is guarded by
+	 * prefetchLatch, which is never held while taking any of the latches above.
+	 *
+	 * Reads queued by readPageAsync() complete on a thread of the I/O engine (io_uring
+	 * when available), which publishes the frame like a synchronous miss would.
+	 *
+	 * An optional background writer (startBackgroundWriter()) writes dirty unpinned
+	 * pages the replacement policy is about to evict, so that eviction rarely has to
+	 * write. Its settings are guarded by writerLatch, likewise never held while
+	 * taking other latches.
+	 */
+	class PageBufferManager
+	{
+	private:
 		/**
 		 * Number of frames in the buffer pool
 		 */
@@ -176,9 +339,14 @@ namespace badgerdb
 		BufHashTbl *hashTable;
 
 		/**
-		 * Array of BufDesc objects to hold information corresponding to every frame allocation from 'bufPool' (the buffer pool)
+		 * Metadata of every frame of the buffer pool (page held, pin count and flags)
+		 */
+		FrameTable *bufferStatTable;
+
+		/**
+		 * Replacement algorithm choosing the frame to reuse
 		 */
-		BufferStatus *bufferStatTable;
+		ReplacementPolicy *policy;
 
 		/**
 		 * Maintains Buffer pool usage statistics
@@ -186,28 +354,406 @@ namespace badgerdb
 		BufStats bufStats;
 
 		/**
-		 * Advance clock to next frame in the buffer pool
+		 * Runs asynchronous page reads for readPageAsync()
+		 */
+		IoEngine *ioEngine;
+
+		/**
+		 * Serializes victim selection and changes to the page assigned to a frame
+		 */
+		std::mutex clockLatch;
+
+		/**
+		 * Serializes calls into File objects other than page reads
+		 */
+		std::mutex ioLatch;
+
+		/**
+		 * Guards mappedFiles
+		 */
+		std::mutex mappedLatch;
+
+		/**
+		 * Files whose pages are served from their mapping, by the File they are
+		 */
+		std::unordered_map<const File *, const MappedFile *> mappedFiles;
+
+		/**
+		 * Number of entries in mappedFiles, so that misses of other files skip mappedLatch
+		 */
+		std::atomic<std::uint32_t> mappedFileCount;
+
+		/**
+		 * Number of flushFile calls writing pages out. While nonzero, frames are only
+		 * taken off the free list under clockLatch, so that a page being flushed is not
+		 * read back from disk before it is written.
+		 */
+		std::atomic<std::uint32_t> flushesInProgress;
+
+		/**
+		 * Guards unpinSignals; taken after a partition latch
+		 */
+		std::mutex unpinLatch;
+
+		/**
+		 * Signalled when a frame is unpinned while flushes wait for pinned pages
+		 */
+		std::condition_variable pageUnpinned;
+
+		/**
+		 * Number of such signals, so that a flush notices unpins during its last round
+		 */
+		std::uint64_t unpinSignals;
+
+		/**
+		 * Number of flushFile calls waiting for pinned pages, so that unpins skip
+		 * unpinLatch otherwise
+		 */
+		std::atomic<std::uint32_t> unpinWaiters;
+
+		/**
+		 * Frame number meaning no frame
+		 */
+		static const FrameId NO_FRAME = ~0u;
+
+		/**
+		 * Ring of frames for SEQUENTIAL_SCAN reads, guarded by clockLatch
+		 */
+		BufferRing scanRing;
+
+		/**
+		 * Ring of frames for ONE_SHOT reads, guarded by clockLatch
+		 */
+		BufferRing oneShotRing;
+
+		/**
+		 * Number of consecutive page reads after which read-ahead starts
+		 */
+		static const std::uint32_t SEQUENTIAL_THRESHOLD = 2;
+
+		/**
+		 * Number of pages read ahead of a sequential reader, 0 if disabled
+		 */
+		std::atomic<std::uint32_t> readAhead;
+
+		/**
+		 * Guards the prefetch queue, the sequential detection state and prefetchActive
+		 */
+		std::mutex prefetchLatch;
+
+		/**
+		 * Signalled when requests are queued or the prefetcher has to stop
+		 */
+		std::condition_variable prefetchQueued;
+
+		/**
+		 * Signalled whenever the prefetcher finishes a page
+		 */
+		std::condition_variable prefetchDone;
+
+		/**
+		 * Runs of pages waiting to be read ahead
+		 */
+		std::deque<PrefetchRequest> prefetchQueue;
+
+		/**
+		 * Sequential access detection, per file
+		 */
+		std::unordered_map<const File *, SequentialState> sequentialState;
+
+		/**
+		 * File the prefetcher is reading a page of, or NULL
+		 */
+		const File *prefetchActive;
+
+		/**
+		 * Tells the prefetcher to exit
+		 */
+		bool prefetchStop;
+
+		/**
+		 * Thread reading queued pages ahead
+		 */
+		std::thread prefetchThread;
+
+		/**
+		 * Guards writerConfig and writerStop
+		 */
+		std::mutex writerLatch;
+
+		/**
+		 * Signalled when the background writer has to stop or its tuning changed
+		 */
+		std::condition_variable writerWake;
+
+		/**
+		 * Tuning of the background writer
+		 */
+		BackgroundWriterConfig writerConfig;
+
+		/**
+		 * Tells the background writer to exit
+		 */
+		bool writerStop;
+
+		/**
+		 * Background writer thread, not joinable while the writer is off
 		 */
-		void advanceClock();
+		std::thread writerThread;
 
 		/**
-		 * Allocate a free frame.
+		 * Allocate a free frame: one off the free list if there is one, otherwise a
+		 * victim chosen by the replacement policy. The frame is returned pinned and not
+		 * yet present in the hash table, so no other thread can hit or evict it.
 		 *
 		 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
+		 * @param hint   	Access hint of the read; non-NORMAL reads recycle frames of their ring
 		 * @throws BufferExceededException If no such buffer is found which can be allocated
 		 */
-		void allocateBuffer(FrameId &frame);
+		void allocateBuffer(FrameId &frame, const AccessHint hint);
+
+		/**
+		 * Empty a resident frame and hand it out pinned, writing its page back if dirty.
+		 * Called with clockLatch held.
+		 *
+		 * @param victim   	Frame to empty
+		 * @return False if the frame's page got pinned meanwhile and was left alone
+		 */
+		bool evictFrame(const FrameId victim);
+
+		/**
+		 * Publish a frame returned by allocateBuffer() as holding the given page.
+		 * If another thread published the same page in the meantime, the frame is
+		 * given back and the other thread's frame is pinned instead.
+		 *
+		 * @param file   		File object
+		 * @param pageNumber  	Page number in the file
+		 * @param frame   		Frame holding the page, updated if the page was already present
+		 * @return True if the frame passed in was published
+		 * @throws  HashTableException If the hash table partition of the page is full; the frame is given back
+		 */
+		bool publishFrame(File *file, const PageId pageNumber, FrameId &frame);
+
+		/**
+		 * publishFrame() for a caller already holding the clockLatch.
+		 *
+		 * @param file   		File object
+		 * @param pageNumber  	Page number in the file
+		 * @param frame   		Frame holding the page, updated if the page was already present
+		 * @return True if the frame passed in was published
+		 * @throws  HashTableException If the hash table partition of the page is full; the frame is given back
+		 */
+		bool publishFrameLocked(File *file, const PageId pageNumber, FrameId &frame);
+
+		/**
+		 * publishFrame() for a frame a page was read into, which may be stale: if the page
+		 * is not in the pool but was evicted since the caller missed it, it may have been
+		 * written back after the read, so nothing is published and the page has to be
+		 * read again.
+		 *
+		 * @param file   		File object
+		 * @param pageNumber  	Page number in the file
+		 * @param frame   		Frame holding the page, updated if the page was already present
+		 * @param epoch   		Eviction epoch of the page when the caller missed it, updated
+		 * 						to the current one if the read has to be repeated
+		 * @return False if the frame was left reserved and the page has to be read again
+		 * @throws  HashTableException If the hash table partition of the page is full; the frame is given back
+		 */
+		bool publishReadFrame(File *file, const PageId pageNumber, FrameId &frame, std::uint32_t &epoch);
+
+		/**
+		 * Look up the registration of a file, without mappedLatch while no file is registered.
+		 *
+		 * @param file   	File object
+		 * @return The registered mapped file, NULL if the file is not registered
+		 */
+		const MappedFile *mappedFileOf(const File *file);
+
+		/**
+		 * Fill a frame returned by allocateBuffer() with a page: make it view the page
+		 * where its file is mapped if the file is registered and the page mapped, read
+		 * the page into it otherwise.
+		 *
+		 * @param file   		File object
+		 * @param pageNumber  	Page number in the file
+		 * @param frame   		Frame to fill
+		 * @throws  InvalidPageException If the page doesn't exist in the file or is not used
+		 */
+		void fillFrame(File *file, const PageId pageNumber, const FrameId frame);
+
+		/**
+		 * Make the page of a frame view the given memory, with no other thread using the frame.
+		 *
+		 * @param frame   	Frame
+		 * @param memory   	Page::SIZE bytes: a slice of poolMemory or of a file mapping
+		 */
+		void viewFrame(const FrameId frame, char *memory);
+
+		/**
+		 * Drop a pin of a frame, partition latch held, and wake the flushes waiting
+		 * for pinned pages once the frame is pinned no more.
+		 *
+		 * @param frame   	Frame to unpin
+		 */
+		void unpinFrame(const FrameId frame);
+
+		/**
+		 * Give back a frame returned by allocateBuffer() that was never published.
+		 *
+		 * @param frame   	Frame to release
+		 */
+		void releaseFrame(const FrameId frame);
+
+		/**
+		 * releaseFrame() for a caller already holding the clockLatch.
+		 *
+		 * @param frame   	Frame to release
+		 */
+		void releaseFrameLocked(const FrameId frame);
+
+		/**
+		 * Take all pages of a file out of the pool, up to the first pinned one unless
+		 * pinned pages are skipped.
+		 *
+		 * @param file   		File object
+		 * @param writeDirty	True to write dirty pages back (flushFile), false to drop them (evictFile)
+		 * @param pinned  		THROW to stop at the first pinned page, otherwise skip pinned pages
+		 * @return  			Pages written and pinned pages skipped
+		 * @throws  PagePinnedException If a page of the file is pinned and pinned is THROW
+		 * @throws BadBufferException If a frame of the file is found to be invalid
+		 */
+		FlushSummary removeFilePages(const File *file, const bool writeDirty, const PinnedPageAction pinned);
+
+		/**
+		 * Write the dirty unpinned pages of a file, keeping them in the pool.
+		 *
+		 * @param file   		File object
+		 * @param pinned  		THROW to stop at the first pinned page, otherwise skip pinned pages
+		 * @return  			Pages written and pinned pages skipped
+		 * @throws  PagePinnedException If a page of the file is pinned and pinned is THROW
+		 */
+		FlushSummary checkpointFile(const File *file, const PinnedPageAction pinned);
+
+		/**
+		 * Write copies of pages taken by checkpointFile, then unpin their frames. If
+		 * the write fails, the pages still in the pool are marked dirty again.
+		 *
+		 * @param file   		File object
+		 * @param copies  		Copies of the pages, in the order of frames
+		 * @param frames  		Frames of the pages, pinned by checkpointFile; emptied
+		 * @param summary  		Pages written, updated
+		 */
+		void writeCheckpointBatch(File *file, std::vector<Page> &copies, std::vector<FrameId> &frames, FlushSummary &summary);
+
+		/**
+		 * Maximum number of pages copied by checkpointFile before they are written
+		 */
+		static const std::uint32_t CHECKPOINT_BATCH = 64;
+
+		/**
+		 * Write every dirty page back at shutdown: grouped by file, in page number
+		 * order, in chunks written by several threads, then fsync each file.
+		 * Failures are logged to std::cerr and the rest is still written, since the
+		 * destructor cannot throw them and an exception escaping a thread would end
+		 * the process.
+		 */
+		void writeBackAll();
+
+		/**
+		 * Log a failed write or sync of writeBackAll.
+		 *
+		 * @param file   	File whose pages were being written back
+		 * @param step   	"write back" or "sync"
+		 * @param reason   	What the exception said
+		 */
+		static void reportWriteBackFailure(const File *file, const char *step, const char *reason);
+
+		/**
+		 * Number of pages per chunk written by one thread of writeBackAll
+		 */
+		static const std::uint32_t WRITE_BACK_CHUNK = 1024;
+
+		/**
+		 * Maximum number of threads of writeBackAll, which uses no more than there
+		 * are cores or chunks to write
+		 */
+		static const std::uint32_t WRITE_BACK_THREADS = 4;
+
+		/**
+		 * Body of the prefetch thread: reads queued pages until told to stop.
+		 */
+		void prefetchWorker();
+
+		/**
+		 * Read a page into the buffer pool unpinned unless it is already there. Failures
+		 * (no unpinned frame, page does not exist) are ignored.
+		 *
+		 * @param file   		File object
+		 * @param pageNumber  	Page number in the file
+		 * @param hint  		Access hint the page is read with
+		 */
+		void prefetchPage(File *file, const PageId pageNumber, const AccessHint hint);
+
+		/**
+		 * Record a read for sequential access detection and queue read-ahead if the
+		 * file is being read sequentially.
+		 *
+		 * @param file   		File object
+		 * @param pageNumber  	Page number just read
+		 * @param hint  		Access hint of the read
+		 */
+		void detectSequential(File *file, const PageId pageNumber, const AccessHint hint);
+
+		/**
+		 * Drop queued read-ahead of a file and wait until the prefetcher is not
+		 * reading one of its pages.
+		 *
+		 * @param file   	File object
+		 */
+		void cancelPrefetch(const File *file);
+
+		/**
+		 * Body of the background writer thread: runs rounds until told to stop.
+		 */
+		void backgroundWriter();
+
+		/**
+		 * One round of the background writer: writes dirty unpinned pages among the
+		 * next victims of the replacement policy.
+		 *
+		 * @param config   	Tuning of the writer
+		 * @param lookahead	Number of upcoming victims to examine; doubled while too many
+		 * 					pages are dirty and reset otherwise
+		 * @return True if too many pages are still dirty and the next round should not wait
+		 */
+		bool backgroundWriterRound(const BackgroundWriterConfig &config, std::uint32_t &lookahead);
 
 	public:
 		/**
-		 * Actual buffer pool from which frames are allocated
+		 * Actual buffer pool from which frames are allocated, one page viewing
+		 * each Page::SIZE slice of poolMemory
 		 */
 		Page *pageBufferPool;
 
+		/**
+		 * Memory of all frames, aligned to Page::ALIGNMENT
+		 */
+		PoolMemory *poolMemory;
+
 		/**
 		 * Constructor of BufMgr class
+		 *
+		 * @param bufs   	Number of frames in the buffer pool
+		 * @param policy   	Replacement algorithm used to choose victim frames
+		 * @param memory   	Page size and NUMA node of the memory of the frames and their status table
+		 */
+		PageBufferManager(std::uint32_t bufs, ReplacementPolicyType policy = ReplacementPolicyType::CLOCK,
+						  const PoolMemoryConfig &memory = PoolMemoryConfig());
+
+		/**
+		 * Page size actually backing the frames, which may be smaller than asked for
 		 */
-		PageBufferManager(std::uint32_t bufs);
+		PoolPageSize poolPageSize() const { return poolMemory->pageSize(); }
 
 		/**
 		 * Destructor of BufMgr class
@@ -222,8 +768,23 @@ namespace badgerdb
 		 * @param file   		File object
 		 * @param pageNumber  	Page number in the file to be read
 		 * @param page  		Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+		 * @param hint  		How the page will be used. Scans should pass SEQUENTIAL_SCAN so they do not flush the pool.
+		 */
+		void readPage(File *file, const PageId pageNumber, Page *&page, const AccessHint hint = AccessHint::NORMAL);
+
+		/**
+		 * Like readPage(), but returns as soon as the read of a missing page is queued,
+		 * so a caller can have many misses outstanding. A page of a registered mapped file
+		 * is served from the mapping as by readPage(), and the future is ready at once. The page is pinned once the
+		 * future is ready, and has to be unpinned like any page read.
+		 *
+		 * @param file   		File object
+		 * @param pageNumber  	Page number in the file to be read
+		 * @return Future for the page, holding InvalidPageException if the page is not in use
+		 * @throws  InvalidPageException If the page number is past the end of the file
+		 * @throws  BufferExceededException If every frame is pinned
 		 */
-		void readPage(File *file, const PageId pageNumber, Page *&page);
+		std::future<Page *> readPageAsync(File *file, const PageId pageNumber);
 
 		/**
 		 * Unpin a page from memory since it is no longer required for it to remain in memory.
@@ -232,6 +793,7 @@ namespace badgerdb
 		 * @param pageNumber  	Page number
 		 * @param dirty			True if the page to be unpinned needs to be marked dirty
 		 * @throws  PageNotPinnedException If the page is not already pinned
+		 * @throws  ReadOnlyFileException If dirty and the file is a registered mapped file; the page is unpinned still
 		 */
 		void unPinPage(File *file, const PageId pageNumber, const bool dirty);
 
@@ -242,19 +804,90 @@ namespace badgerdb
 		 * @param file   		File object
 		 * @param pageNumber  	Page number. The number assigned to the page in the file is returned via this reference.
 		 * @param page  		Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+		 * @throws  ReadOnlyFileException If the file is a registered mapped file
 		 */
 		void allocatePage(File *file, PageId &pageNumber, Page *&page);
 
+		/**
+		 * Allocates several new, empty pages as one extent at the end of the file
+		 * (File::allocatePagesInto) and pins each in a frame of the buffer pool, taking
+		 * the latches once for all of them. Either all pages are allocated or none is.
+		 *
+		 * @param file   		File object
+		 * @param count  		Number of pages to allocate
+		 * @param pageNumbers  	Numbers of the new pages, consecutive, are returned here
+		 * @param pages  		Pinned in-memory Page objects of the new pages are returned here, in the same order
+		 * @param preallocate  	Whether to reserve the disk space of the extent first (fallocate)
+		 * @throws  BufferExceededException If fewer than count frames can be had
+		 * @throws  ReadOnlyFileException If the file is a registered mapped file
+		 */
+		void allocatePages(File *file, const std::uint32_t count, std::vector<PageId> &pageNumbers, std::vector<Page *> &pages, const bool preallocate = false);
+
+		/**
+		 * Queues pages to be read into the buffer pool in the background, so that
+		 * later readPage() calls for them hit. Pages are read into unpinned frames;
+		 * pages that are already buffered or do not exist are skipped.
+		 *
+		 * @param file   		File object
+		 * @param first  		First page number to read
+		 * @param count  		Number of consecutive page numbers to read
+		 * @param hint  		Access hint the pages are read with
+		 */
+		void prefetch(File *file, const PageId first, const std::uint32_t count, const AccessHint hint = AccessHint::NORMAL);
+
+		/**
+		 * Sets how many pages readPage() reads ahead once it sees a file being read
+		 * in page number order. Read-ahead is disabled (0) by default. Scans read
+		 * ahead at most half of their buffer ring.
+		 *
+		 * @param pages  		Read-ahead window in pages, 0 to disable
+		 */
+		void setReadAhead(const std::uint32_t pages)
+		{
+			readAhead = pages;
+		}
+
+		/**
+		 * Starts the background writer, or changes its tuning if it is running.
+		 *
+		 * @param config  		Tuning of the writer
+		 */
+		void startBackgroundWriter(const BackgroundWriterConfig &config = BackgroundWriterConfig());
+
+		/**
+		 * Stops the background writer if it is running.
+		 */
+		void stopBackgroundWriter();
+
 		/**
 		 * Writes out all dirty pages of the file to disk.
-		 * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
-		 * Otherwise Error returned.
+		 * By default all the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called,
+		 * and the pages are evicted. Otherwise Error returned. Read-ahead queued for the file is cancelled.
+		 * Only the frames of the file are visited, and dirty pages are written in page number order.
+		 *
+		 * In CHECKPOINT mode the pages stay in the pool and may be used meanwhile: each dirty
+		 * page is copied and marked clean under its latch, and the copies are written in
+		 * batches without holding any page latch.
 		 *
 		 * @param file   	File object
-		 * @throws  PagePinnedException If any page of the file is pinned in the buffer pool
+		 * @param options   Whether to evict the pages, and what to do with pinned ones
+		 * @return  		Pages written and pinned pages skipped
+		 * @throws  PagePinnedException If a page of the file is pinned and options.pinned is THROW,
+		 * 			or still pinned after options.waitTimeoutMs with WAIT
 		 * @throws BadBufferException If any frame allocated to the file is found to be invalid
 		 */
-		void flushFile(const File *file);
+		FlushSummary flushFile(const File *file, const FlushOptions &options = FlushOptions());
+
+		/**
+		 * Drops all pages of the file from the buffer pool without writing dirty ones
+		 * back, for a file about to be removed or truncated. Costs time in the number
+		 * of pages of the file in the pool, not in the size of the pool. Read-ahead
+		 * queued for the file is cancelled.
+		 *
+		 * @param file   	File object
+		 * @throws  PagePinnedException If any page of the file is pinned in the buffer pool
+		 */
+		void evictFile(const File *file);
 
 		/**
 		 * Delete page from file and also from buffer pool if present.
@@ -262,9 +895,32 @@ namespace badgerdb
 		 *
 		 * @param file   		File object
 		 * @param pageNumber  	Page number
+		 * @throws  ReadOnlyFileException If the file is a registered mapped file
 		 */
 		void disposePage(File *file, const PageId pageNumber);
 
+		/**
+		 * Serve the pages of a mapped file from its mapping from now on: a page read into
+		 * the pool, by readPage() or readPageAsync(), is not copied, its frame views the
+		 * page in the mapping, so pointers to pinned pages point straight into it. The
+		 * mapping is read-only and so is the file in the pool while registered: unPinPage()
+		 * of a dirty page, allocatePage(), allocatePages() and disposePage() throw
+		 * ReadOnlyFileException for it. Change its pages through the File instead. The
+		 * file must stay registered, and so alive, while any of its pages is in the pool.
+		 *
+		 * @param file   	Mapped file
+		 */
+		void registerMappedFile(const MappedFile *file);
+
+		/**
+		 * Flush the pages of a mapped file out of the pool, as flushFile() does, and stop
+		 * serving them from its mapping. No page of the file may be read meanwhile.
+		 *
+		 * @param file   	Mapped file
+		 * @throws  PagePinnedException If a page of the file is pinned in the buffer pool
+		 */
+		void unregisterMappedFile(const MappedFile *file);
+
 		/**
 		 * Print member variable values.
 		 */
@@ -0,0 +1,99 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "pool_memory.h"
+
+namespace badgerdb
+{
+
+	const std::size_t PoolMemory::HUGE_PAGE_SIZE;
+
+	PoolMemory::PoolMemory(std::size_t bytes, const PoolMemoryConfig &config)
+		: memory(NULL), length(0), obtained(config.pageSize), bound(false)
+	{
+		// Fall back one page size at a time
+		while (!map(bytes, obtained))
+		{
+			if (obtained == PoolPageSize::NORMAL)
+			{
+				throw std::bad_alloc();
+			}
+			obtained = obtained == PoolPageSize::EXPLICIT_HUGE ? PoolPageSize::TRANSPARENT_HUGE : PoolPageSize::NORMAL;
+		}
+
+		// Bind before anything touches the memory, so that pages are placed on first use
+		if (config.numaNode >= 0)
+		{
+			const std::size_t bitsPerWord = 8 * sizeof(unsigned long);
+			std::vector<unsigned long> nodes(config.numaNode / bitsPerWord + 1, 0);
+			nodes[config.numaNode / bitsPerWord] = 1ul << (config.numaNode % bitsPerWord);
+			// The kernel reads one bit less than maxnode
+			bound = syscall(__NR_mbind, memory, length, MPOL_BIND, &nodes[0], nodes.size() * bitsPerWord + 1, 0) == 0;
+		}
+	}
+
+	PoolMemory::~PoolMemory()
+	{
+		munmap(memory, length);
+	}
+
+	bool PoolMemory::map(std::size_t bytes, PoolPageSize pageSize)
+	{
+		const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+		if (pageSize == PoolPageSize::NORMAL)
+		{
+			const std::size_t systemPage = sysconf(_SC_PAGESIZE);
+			length = (bytes + systemPage - 1) / systemPage * systemPage;
+			void *mapped = mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+			memory = mapped == MAP_FAILED ? NULL : static_cast<char *>(mapped);
+			return memory != NULL;
+		}
+
+		length = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		if (pageSize == PoolPageSize::EXPLICIT_HUGE)
+		{
+			void *mapped = mmap(NULL, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+			memory = mapped == MAP_FAILED ? NULL : static_cast<char *>(mapped);
+			return memory != NULL;
+		}
+
+		// Transparent huge pages only cover 2MB-aligned ranges, so map a huge page more
+		// than needed and trim the unaligned ends
+		void *mapped = mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+		if (mapped == MAP_FAILED)
+		{
+			return false;
+		}
+		const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(mapped);
+		const std::uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		if (aligned > start)
+		{
+			munmap(mapped, aligned - start);
+		}
+		if (start + HUGE_PAGE_SIZE > aligned)
+		{
+			munmap(reinterpret_cast<void *>(aligned + length), start + HUGE_PAGE_SIZE - aligned);
+		}
+		memory = reinterpret_cast<char *>(aligned);
+		if (madvise(memory, length, MADV_HUGEPAGE) != 0)
+		{
+			munmap(memory, length);
+			memory = NULL;
+			return false;
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,116 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace badgerdb
+{
+
+	/**
+	 * @brief Size of the virtual memory pages backing the buffer pool
+	 */
+	enum class PoolPageSize
+	{
+		/**
+		 * Pages of the default size of the system
+		 */
+		NORMAL,
+		/**
+		 * Transparent 2MB huge pages, requested with madvise
+		 */
+		TRANSPARENT_HUGE,
+		/**
+		 * 2MB pages reserved by the administrator (vm.nr_hugepages), mapped with MAP_HUGETLB
+		 */
+		EXPLICIT_HUGE
+	};
+
+	/**
+	 * @brief Placement of the memory of the buffer pool
+	 */
+	struct PoolMemoryConfig
+	{
+		/**
+		 * Page size asked for. Explicit huge pages fall back to transparent ones, and
+		 * those to normal pages, when the system does not provide them.
+		 */
+		PoolPageSize pageSize;
+
+		/**
+		 * NUMA node the memory is bound to with mbind, or -1 to leave placement to
+		 * the kernel. Binding is skipped if the node does not exist.
+		 */
+		int numaNode;
+
+		/**
+		 * Constructor of PoolMemoryConfig class, with normal pages and no binding
+		 */
+		PoolMemoryConfig()
+			: pageSize(PoolPageSize::NORMAL), numaNode(-1)
+		{
+		}
+	};
+
+	/**
+	 * @brief Anonymous memory mapping backing the frames or the frame table of a buffer pool
+	 *
+	 * The memory is zero-filled and aligned to at least the system page size (2MB for
+	 * huge pages). It is unmapped when the object is destroyed.
+	 */
+	class PoolMemory
+	{
+	public:
+		/**
+		 * Size of a huge page in bytes
+		 */
+		static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+		/**
+		 * Maps memory.
+		 *
+		 * @param bytes   	Number of bytes needed
+		 * @param config   	Page size and NUMA placement asked for
+		 * @throws  std::bad_alloc If no memory could be mapped at all
+		 */
+		PoolMemory(std::size_t bytes, const PoolMemoryConfig &config);
+
+		~PoolMemory();
+
+		PoolMemory(const PoolMemory &) = delete;
+		PoolMemory &operator=(const PoolMemory &) = delete;
+
+		/**
+		 * Start of the memory
+		 */
+		char *data() const { return memory; }
+
+		/**
+		 * Page size actually obtained. TRANSPARENT_HUGE means the kernel accepted the
+		 * request; it still assembles huge pages only where it can.
+		 */
+		PoolPageSize pageSize() const { return obtained; }
+
+		/**
+		 * Whether the memory is bound to the NUMA node asked for
+		 */
+		bool numaBound() const { return bound; }
+
+	private:
+		/**
+		 * Tries to map memory with the given page size, returns false if the system refuses
+		 */
+		bool map(std::size_t bytes, PoolPageSize pageSize);
+
+		char *memory;
+		std::size_t length;
+		PoolPageSize obtained;
+		bool bound;
+	};
+
+}
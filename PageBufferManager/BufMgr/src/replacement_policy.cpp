@@ -0,0 +1,834 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+
+#include "replacement_policy.h"
+#include "pagebuffer.h"
+
+namespace badgerdb
+{
+
+	ReplacementPolicy *ReplacementPolicy::create(ReplacementPolicyType type, std::uint32_t numBufs, FrameTable *bufferStatTable)
+	{
+		switch (type)
+		{
+		case ReplacementPolicyType::LRU_K:
+			return new LruKPolicy(numBufs, bufferStatTable);
+		case ReplacementPolicyType::TWO_Q:
+			return new TwoQPolicy(numBufs, bufferStatTable);
+		case ReplacementPolicyType::ARC:
+			return new ArcPolicy(numBufs, bufferStatTable);
+		case ReplacementPolicyType::CLOCK_PRO:
+			return new ClockProPolicy(numBufs, bufferStatTable);
+		case ReplacementPolicyType::CLOCK:
+		default:
+			return new ClockPolicy(numBufs, bufferStatTable);
+		}
+	}
+
+	ReplacementPolicy::ReplacementPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable)
+		: numBufs(numBufs), bufferStatTable(bufferStatTable)
+	{
+	}
+
+	bool ReplacementPolicy::isPinned(const FrameId frame) const
+	{
+		return bufferStatTable->pinCount(frame) > 0;
+	}
+
+	bool ReplacementPolicy::isValid(const FrameId frame) const
+	{
+		return bufferStatTable->isValid(frame);
+	}
+
+	bool ReplacementPolicy::isReferenced(const FrameId frame) const
+	{
+		return bufferStatTable->isReferenced(frame);
+	}
+
+	void ReplacementPolicy::setReferenced(const FrameId frame, const bool referenced)
+	{
+		bufferStatTable->setReferenced(frame, referenced);
+	}
+
+	ClockPolicy::ClockPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable)
+		: ReplacementPolicy(numBufs, bufferStatTable), clockHand(numBufs - 1)
+	{
+	}
+
+	void ClockPolicy::recordAccess(const FrameId frame)
+	{
+		setReferenced(frame, true);
+	}
+
+	void ClockPolicy::recordInsert(const FrameId frame, const File *file, const PageId pageNo)
+	{
+	}
+
+	void ClockPolicy::recordEvict(const FrameId frame)
+	{
+	}
+
+	void ClockPolicy::recordRemove(const FrameId frame)
+	{
+	}
+
+	bool ClockPolicy::takeVictim(const std::uint32_t word, const std::uint64_t mask, FrameId &frame, bool &unpinnedSeen)
+	{
+		const std::uint64_t unpinned = bufferStatTable->validWord(word) & ~bufferStatTable->pinnedWord(word) & mask;
+		const std::uint64_t candidates = unpinned & ~bufferStatTable->referencedWord(word);
+		if (candidates == 0)
+		{
+			bufferStatTable->clearReferenced(word, unpinned);
+			unpinnedSeen |= unpinned != 0;
+			return false;
+		}
+		const std::uint32_t victim = __builtin_ctzll(candidates);
+		bufferStatTable->clearReferenced(word, unpinned & ((1ull << victim) - 1));
+		clockHand = word * FrameTable::WORD_BITS + victim;
+		frame = clockHand;
+		return true;
+	}
+
+	bool ClockPolicy::pickVictim(FrameId &frame)
+	{
+		const std::uint32_t words = bufferStatTable->words();
+		std::uint32_t word = FrameTable::wordOf(clockHand);
+		bool unpinnedSeen = false;
+		// The hand's word from the hand on, then the following words, wrapping around
+		// to the hand's word again
+		if (takeVictim(word, ~0ull << (clockHand % FrameTable::WORD_BITS), frame, unpinnedSeen))
+		{
+			return true;
+		}
+		std::uint32_t start = word + 1;
+		while (true)
+		{
+			std::uint32_t next = bufferStatTable->secondChance(start, words, unpinnedSeen);
+			if (next == words)
+			{
+				next = bufferStatTable->secondChance(0, start, unpinnedSeen);
+				if (next == start)
+				{
+					// A whole revolution without victim: every page was pinned, or
+					// referenced and now has its reference bit cleared
+					if (!unpinnedSeen)
+					{
+						// All pages are pinned (or no frame holds a page)
+						return false;
+					}
+					unpinnedSeen = false;
+					continue;
+				}
+			}
+			if (takeVictim(next, ~0ull, frame, unpinnedSeen))
+			{
+				return true;
+			}
+			// The candidate was pinned or referenced in between
+			start = next + 1;
+		}
+	}
+
+	void ClockPolicy::upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames)
+	{
+		// Frames the hand reaches first; referenced ones only get a second chance, but
+		// will be reached again within one revolution
+		const std::size_t limit = frames.size() + count;
+		const std::uint32_t start = FrameTable::wordOf(clockHand);
+		const std::uint32_t words = bufferStatTable->words();
+		for (std::uint32_t i = 0; i <= words && frames.size() < limit; i++)
+		{
+			const std::uint32_t word = (start + i) % words;
+			std::uint64_t bits = bufferStatTable->validWord(word) & ~bufferStatTable->pinnedWord(word);
+			// The hand's word is visited first from the hand, and last up to it
+			const std::uint64_t fromHand = ~0ull << (clockHand % FrameTable::WORD_BITS);
+			if (i == 0)
+				bits &= fromHand;
+			else if (i == words)
+				bits &= ~fromHand;
+			for (; bits != 0 && frames.size() < limit; bits &= bits - 1)
+			{
+				frames.push_back(word * FrameTable::WORD_BITS + __builtin_ctzll(bits));
+			}
+		}
+	}
+
+	LruKPolicy::LruKPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable)
+		: ReplacementPolicy(numBufs, bufferStatTable), now(0), history(numBufs),
+		  keys(numBufs), resident(numBufs, false)
+	{
+	}
+
+	LruKPolicy::OrderKey LruKPolicy::orderKey(const FrameId frame) const
+	{
+		OrderKey key = {history[frame].refs[K - 1], history[frame].refs[0], frame};
+		return key;
+	}
+
+	void LruKPolicy::touch(const FrameId frame)
+	{
+		for (int i = K - 1; i > 0; i--)
+		{
+			history[frame].refs[i] = history[frame].refs[i - 1];
+		}
+		history[frame].refs[0] = ++now;
+	}
+
+	void LruKPolicy::recordAccess(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		if (!resident[frame])
+		{
+			return;
+		}
+		order.erase(orderKey(frame));
+		touch(frame);
+		order.insert(orderKey(frame));
+	}
+
+	void LruKPolicy::recordInsert(const FrameId frame, const File *file, const PageId pageNo)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const PageKey key = {file, pageNo};
+		keys[frame] = key;
+		std::unordered_map<PageKey, Retained, PageKeyHash>::iterator old = retained.find(key);
+		if (old != retained.end())
+		{
+			// Read in again while its history was retained
+			history[frame] = old->second.history;
+			retainedAge.erase(old->second.age);
+			retained.erase(old);
+		}
+		else
+		{
+			std::fill(history[frame].refs, history[frame].refs + K, 0);
+		}
+		touch(frame);
+		resident[frame] = true;
+		order.insert(orderKey(frame));
+	}
+
+	void LruKPolicy::recordEvict(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		order.erase(orderKey(frame));
+		resident[frame] = false;
+		retainedAge.push_back(keys[frame]);
+		Retained entry = {history[frame], --retainedAge.end()};
+		retained[keys[frame]] = entry;
+		// Retain the history of at most as many pages as fit in the pool
+		while (retained.size() > numBufs)
+		{
+			retained.erase(retainedAge.front());
+			retainedAge.pop_front();
+		}
+	}
+
+	void LruKPolicy::recordRemove(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		if (resident[frame])
+		{
+			order.erase(orderKey(frame));
+			resident[frame] = false;
+		}
+	}
+
+	bool LruKPolicy::pickVictim(FrameId &frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		for (std::set<OrderKey>::iterator it = order.begin(); it != order.end(); ++it)
+		{
+			if (!isPinned(it->frame))
+			{
+				frame = it->frame;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void LruKPolicy::upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const std::size_t limit = frames.size() + count;
+		for (std::set<OrderKey>::iterator it = order.begin(); it != order.end() && frames.size() < limit; ++it)
+		{
+			if (!isPinned(it->frame))
+			{
+				frames.push_back(it->frame);
+			}
+		}
+	}
+
+	TwoQPolicy::TwoQPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable)
+		: ReplacementPolicy(numBufs, bufferStatTable),
+		  kin(std::max<std::size_t>(1, numBufs / 4)), kout(std::max<std::size_t>(1, numBufs / 2)),
+		  queue(numBufs, NONE), position(numBufs), keys(numBufs)
+	{
+	}
+
+	void TwoQPolicy::unlink(const FrameId frame)
+	{
+		if (queue[frame] == A1IN)
+		{
+			a1in.erase(position[frame]);
+		}
+		else if (queue[frame] == AM)
+		{
+			am.erase(position[frame]);
+		}
+		queue[frame] = NONE;
+	}
+
+	void TwoQPolicy::recordAccess(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		// Hits in A1in are deliberately ignored: they are usually correlated references
+		if (queue[frame] == AM)
+		{
+			am.splice(am.begin(), am, position[frame]);
+		}
+	}
+
+	void TwoQPolicy::recordInsert(const FrameId frame, const File *file, const PageId pageNo)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const PageKey key = {file, pageNo};
+		keys[frame] = key;
+		std::unordered_map<PageKey, std::list<PageKey>::iterator, PageKeyHash>::iterator ghost = a1outIndex.find(key);
+		if (ghost != a1outIndex.end())
+		{
+			// Referenced again after leaving A1in, so it is worth keeping
+			a1out.erase(ghost->second);
+			a1outIndex.erase(ghost);
+			am.push_front(frame);
+			position[frame] = am.begin();
+			queue[frame] = AM;
+		}
+		else
+		{
+			a1in.push_front(frame);
+			position[frame] = a1in.begin();
+			queue[frame] = A1IN;
+		}
+	}
+
+	void TwoQPolicy::recordEvict(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		if (queue[frame] == A1IN)
+		{
+			a1out.push_front(keys[frame]);
+			a1outIndex[keys[frame]] = a1out.begin();
+			while (a1out.size() > kout)
+			{
+				a1outIndex.erase(a1out.back());
+				a1out.pop_back();
+			}
+		}
+		unlink(frame);
+	}
+
+	void TwoQPolicy::recordRemove(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		unlink(frame);
+	}
+
+	bool TwoQPolicy::pickVictim(FrameId &frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		std::list<FrameId> *queues[2] = {&am, &a1in};
+		if (a1in.size() > kin)
+		{
+			std::swap(queues[0], queues[1]);
+		}
+		for (int q = 0; q < 2; q++)
+		{
+			// Oldest entries are at the back
+			for (std::list<FrameId>::reverse_iterator it = queues[q]->rbegin(); it != queues[q]->rend(); ++it)
+			{
+				if (!isPinned(*it))
+				{
+					frame = *it;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void TwoQPolicy::upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const std::size_t limit = frames.size() + count;
+		std::list<FrameId> *queues[2] = {&am, &a1in};
+		if (a1in.size() > kin)
+		{
+			std::swap(queues[0], queues[1]);
+		}
+		for (int q = 0; q < 2; q++)
+		{
+			for (std::list<FrameId>::reverse_iterator it = queues[q]->rbegin(); it != queues[q]->rend() && frames.size() < limit; ++it)
+			{
+				if (!isPinned(*it))
+				{
+					frames.push_back(*it);
+				}
+			}
+		}
+	}
+
+	bool ArcPolicy::GhostList::erase(const PageKey &key)
+	{
+		std::unordered_map<PageKey, std::list<PageKey>::iterator, PageKeyHash>::iterator it = index.find(key);
+		if (it == index.end())
+		{
+			return false;
+		}
+		keys.erase(it->second);
+		index.erase(it);
+		return true;
+	}
+
+	void ArcPolicy::GhostList::pushFront(const PageKey &key)
+	{
+		keys.push_front(key);
+		index[key] = keys.begin();
+	}
+
+	void ArcPolicy::GhostList::popBack()
+	{
+		index.erase(keys.back());
+		keys.pop_back();
+	}
+
+	ArcPolicy::ArcPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable)
+		: ReplacementPolicy(numBufs, bufferStatTable), target(0), list(numBufs, NONE),
+		  position(numBufs), keys(numBufs)
+	{
+	}
+
+	void ArcPolicy::unlink(const FrameId frame)
+	{
+		if (list[frame] == T1)
+		{
+			t1.erase(position[frame]);
+		}
+		else if (list[frame] == T2)
+		{
+			t2.erase(position[frame]);
+		}
+		list[frame] = NONE;
+	}
+
+	void ArcPolicy::recordAccess(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		if (list[frame] == T1)
+		{
+			t2.splice(t2.begin(), t1, position[frame]);
+			list[frame] = T2;
+		}
+		else if (list[frame] == T2)
+		{
+			t2.splice(t2.begin(), t2, position[frame]);
+		}
+	}
+
+	void ArcPolicy::recordInsert(const FrameId frame, const File *file, const PageId pageNo)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const PageKey key = {file, pageNo};
+		keys[frame] = key;
+		if (b1.index.count(key))
+		{
+			// Recently evicted from T1: grow T1's target
+			const std::size_t delta = b1.size() >= b2.size() ? 1 : b2.size() / b1.size();
+			target = std::min<std::size_t>(numBufs, target + delta);
+			b1.erase(key);
+			t2.push_front(frame);
+			list[frame] = T2;
+		}
+		else if (b2.index.count(key))
+		{
+			// Recently evicted from T2: shrink T1's target
+			const std::size_t delta = b2.size() >= b1.size() ? 1 : b1.size() / b2.size();
+			target = target > delta ? target - delta : 0;
+			b2.erase(key);
+			t2.push_front(frame);
+			list[frame] = T2;
+		}
+		else
+		{
+			t1.push_front(frame);
+			list[frame] = T1;
+		}
+		position[frame] = list[frame] == T1 ? t1.begin() : t2.begin();
+
+		// Keep T1 + B1 within c and the whole directory within 2c
+		while (t1.size() + b1.size() > numBufs && b1.size() > 0)
+		{
+			b1.popBack();
+		}
+		while (t1.size() + t2.size() + b1.size() + b2.size() > 2 * (std::size_t)numBufs)
+		{
+			if (b2.size() > 0)
+			{
+				b2.popBack();
+			}
+			else if (b1.size() > 0)
+			{
+				b1.popBack();
+			}
+			else
+			{
+				break;
+			}
+		}
+	}
+
+	void ArcPolicy::recordEvict(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		if (list[frame] == T1)
+		{
+			b1.pushFront(keys[frame]);
+		}
+		else if (list[frame] == T2)
+		{
+			b2.pushFront(keys[frame]);
+		}
+		unlink(frame);
+	}
+
+	void ArcPolicy::recordRemove(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		unlink(frame);
+	}
+
+	bool ArcPolicy::pickFrom(std::list<FrameId> &from, FrameId &frame)
+	{
+		// Least recently used entries are at the back
+		for (std::list<FrameId>::reverse_iterator it = from.rbegin(); it != from.rend(); ++it)
+		{
+			if (!isPinned(*it))
+			{
+				frame = *it;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ArcPolicy::pickVictim(FrameId &frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		if (!t1.empty() && (t1.size() > target || t2.empty()))
+		{
+			return pickFrom(t1, frame) || pickFrom(t2, frame);
+		}
+		return pickFrom(t2, frame) || pickFrom(t1, frame);
+	}
+
+	void ArcPolicy::listFrom(const std::list<FrameId> &from, const std::uint32_t count, std::vector<FrameId> &frames) const
+	{
+		const std::size_t limit = frames.size() + count;
+		for (std::list<FrameId>::const_reverse_iterator it = from.rbegin(); it != from.rend() && frames.size() < limit; ++it)
+		{
+			if (!isPinned(*it))
+			{
+				frames.push_back(*it);
+			}
+		}
+	}
+
+	void ArcPolicy::upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const std::size_t start = frames.size();
+		const bool fromT1 = !t1.empty() && (t1.size() > target || t2.empty());
+		listFrom(fromT1 ? t1 : t2, count, frames);
+		listFrom(fromT1 ? t2 : t1, count - (frames.size() - start), frames);
+	}
+
+	ClockProPolicy::ClockProPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable)
+		: ReplacementPolicy(numBufs, bufferStatTable), entryOf(numBufs, clock.end()),
+		  countHot(0), countCold(0), coldTarget(std::max<std::uint32_t>(1, numBufs / 10))
+	{
+		handHot = handCold = handTest = clock.end();
+	}
+
+	ClockProPolicy::Hand ClockProPolicy::next(Hand hand)
+	{
+		++hand;
+		return hand == clock.end() ? clock.begin() : hand;
+	}
+
+	void ClockProPolicy::insertEntry(const Entry &entry)
+	{
+		Hand inserted;
+		if (clock.empty())
+		{
+			clock.push_back(entry);
+			inserted = handHot = handCold = handTest = clock.begin();
+		}
+		else
+		{
+			// The list head is just behind the hot hand
+			inserted = clock.insert(handHot, entry);
+		}
+		if (entry.frame != NO_FRAME)
+		{
+			entryOf[entry.frame] = inserted;
+		}
+	}
+
+	void ClockProPolicy::eraseEntry(Hand entry)
+	{
+		if (clock.size() == 1)
+		{
+			clock.clear();
+			handHot = handCold = handTest = clock.end();
+			return;
+		}
+		if (handHot == entry)
+			handHot = next(entry);
+		if (handCold == entry)
+			handCold = next(entry);
+		if (handTest == entry)
+			handTest = next(entry);
+		clock.erase(entry);
+	}
+
+	void ClockProPolicy::runHandHot()
+	{
+		// Demote one unreferenced hot page, ending test periods on the way
+		for (std::size_t steps = 0, n = clock.size(); steps < n && !clock.empty(); steps++)
+		{
+			Hand current = handHot;
+			handHot = next(handHot);
+			if (current->hot)
+			{
+				if (isReferenced(current->frame))
+				{
+					setReferenced(current->frame, false);
+				}
+				else
+				{
+					current->hot = false;
+					countHot--;
+					countCold++;
+					return;
+				}
+			}
+			else if (current->test)
+			{
+				if (current->frame == NO_FRAME)
+				{
+					// Not re-accessed during its test period: cold pages need less room
+					nonResident.erase(current->key);
+					eraseEntry(current);
+					coldTarget = std::max<std::size_t>(1, coldTarget - 1);
+				}
+				else
+				{
+					current->test = false;
+				}
+			}
+		}
+	}
+
+	void ClockProPolicy::runHandTest()
+	{
+		// Drop the metadata of one non-resident page
+		for (std::size_t steps = 0, n = clock.size(); steps < n && !clock.empty(); steps++)
+		{
+			Hand current = handTest;
+			handTest = next(handTest);
+			if (!current->hot && current->test)
+			{
+				if (current->frame == NO_FRAME)
+				{
+					nonResident.erase(current->key);
+					eraseEntry(current);
+					coldTarget = std::max<std::size_t>(1, coldTarget - 1);
+					return;
+				}
+				current->test = false;
+			}
+		}
+	}
+
+	void ClockProPolicy::recordAccess(const FrameId frame)
+	{
+		setReferenced(frame, true);
+	}
+
+	void ClockProPolicy::recordInsert(const FrameId frame, const File *file, const PageId pageNo)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const PageKey key = {file, pageNo};
+		const std::size_t maxColdTarget = std::max<std::uint32_t>(1, numBufs - 1);
+		std::unordered_map<PageKey, Hand, PageKeyHash>::iterator old = nonResident.find(key);
+		if (old != nonResident.end())
+		{
+			// Re-accessed during its test period: it becomes hot and cold pages get more room
+			coldTarget = std::min(coldTarget + 1, maxColdTarget);
+			eraseEntry(old->second);
+			nonResident.erase(old);
+			Entry entry = {key, frame, true, false};
+			insertEntry(entry);
+			countHot++;
+		}
+		else
+		{
+			Entry entry = {key, frame, false, true};
+			insertEntry(entry);
+			countCold++;
+		}
+		// The read that brought the page in is not a re-reference
+		setReferenced(frame, false);
+
+		for (std::size_t guard = clock.size(); countHot > numBufs - coldTarget && guard > 0; guard--)
+		{
+			runHandHot();
+		}
+	}
+
+	void ClockProPolicy::recordEvict(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		Hand entry = entryOf[frame];
+		entryOf[frame] = clock.end();
+		if (entry == clock.end())
+		{
+			return;
+		}
+		if (handCold == entry)
+		{
+			handCold = next(handCold);
+		}
+		if (entry->hot)
+		{
+			countHot--;
+			eraseEntry(entry);
+		}
+		else
+		{
+			countCold--;
+			if (entry->test)
+			{
+				// Keep it as a non-resident page until its test period ends
+				entry->frame = NO_FRAME;
+				nonResident[entry->key] = entry;
+			}
+			else
+			{
+				eraseEntry(entry);
+			}
+		}
+		for (std::size_t guard = clock.size(); nonResident.size() > numBufs && guard > 0; guard--)
+		{
+			runHandTest();
+		}
+	}
+
+	void ClockProPolicy::recordRemove(const FrameId frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		Hand entry = entryOf[frame];
+		if (entry != clock.end())
+		{
+			if (entry->hot)
+				countHot--;
+			else
+				countCold--;
+			eraseEntry(entry);
+			entryOf[frame] = clock.end();
+		}
+	}
+
+	bool ClockProPolicy::pickVictim(FrameId &frame)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		const std::size_t maxColdTarget = std::max<std::uint32_t>(1, numBufs - 1);
+		for (std::size_t steps = 0, limit = 4 * clock.size(); steps < limit && !clock.empty(); steps++)
+		{
+			if (countCold == 0)
+			{
+				runHandHot();
+			}
+			Hand current = handCold;
+			if (current->hot || current->frame == NO_FRAME || isPinned(current->frame))
+			{
+				handCold = next(handCold);
+				continue;
+			}
+			if (!isReferenced(current->frame))
+			{
+				frame = current->frame;
+				return true;
+			}
+			setReferenced(current->frame, false);
+			handCold = next(handCold);
+			if (current->test)
+			{
+				// Re-accessed during its test period: promote to hot
+				current->hot = true;
+				current->test = false;
+				countCold--;
+				countHot++;
+				coldTarget = std::min(coldTarget + 1, maxColdTarget);
+				for (std::size_t hotGuard = clock.size(); countHot > numBufs - coldTarget && hotGuard > 0; hotGuard--)
+				{
+					runHandHot();
+				}
+			}
+			else
+			{
+				// Start a new test period at the list head
+				current->test = true;
+				if (current != handHot)
+				{
+					clock.splice(handHot, clock, current);
+				}
+			}
+		}
+
+		// No evictable cold page, fall back to any unpinned resident page
+		for (Hand entry = clock.begin(); entry != clock.end(); ++entry)
+		{
+			if (entry->frame != NO_FRAME && !isPinned(entry->frame))
+			{
+				frame = entry->frame;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ClockProPolicy::upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames)
+	{
+		std::lock_guard<std::mutex> guard(latch);
+		// Resident cold pages in the order the cold hand reaches them
+		const std::size_t limit = frames.size() + count;
+		Hand current = handCold;
+		for (std::size_t steps = 0; steps < clock.size() && frames.size() < limit; steps++, current = next(current))
+		{
+			if (!current->hot && current->frame != NO_FRAME && !isPinned(current->frame))
+			{
+				frames.push_back(current->frame);
+			}
+		}
+	}
+
+}
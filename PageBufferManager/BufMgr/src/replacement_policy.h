@@ -0,0 +1,444 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "file.h"
+
+namespace badgerdb
+{
+
+	class FrameTable;
+
+	/**
+	 * @brief Page replacement algorithms the buffer manager can be constructed with
+	 */
+	enum class ReplacementPolicyType
+	{
+		CLOCK,
+		LRU_K,
+		TWO_Q,
+		ARC,
+		CLOCK_PRO
+	};
+
+	/**
+	 * @brief Identity of a page, used by policies that remember pages after evicting them
+	 */
+	struct PageKey
+	{
+		/**
+		 * File the page belongs to
+		 */
+		const File *file;
+
+		/**
+		 * Page number within the file
+		 */
+		PageId pageNo;
+
+		bool operator==(const PageKey &rhs) const
+		{
+			return file == rhs.file && pageNo == rhs.pageNo;
+		}
+	};
+
+	/**
+	 * @brief Hash functor for PageKey
+	 */
+	struct PageKeyHash
+	{
+		std::size_t operator()(const PageKey &key) const
+		{
+			return std::hash<const void *>()(key.file) * 31 + key.pageNo;
+		}
+	};
+
+	/**
+	 * @brief Decides which frame of the buffer pool is reused when a new page has to be read in.
+	 *
+	 * The buffer manager reports every page it places in a frame, every hit, and every
+	 * frame it empties, and asks the policy for a victim when it needs a frame and its
+	 * free list is empty. A frame is always in one of three states as far as the policy
+	 * is concerned: free (never used, or emptied through recordRemove; the buffer
+	 * manager hands these out itself), resident (after recordInsert), or handed out
+	 * (taken from the free list or evicted, and not yet passed to recordInsert or
+	 * recordRemove).
+	 *
+	 * recordAccess may be called from any thread at any time. All other methods are
+	 * only called with the buffer manager's clock latch held.
+	 */
+	class ReplacementPolicy
+	{
+	public:
+		/**
+		 * Creates a policy of the given type for a pool of numBufs frames.
+		 *
+		 * @param type   			Replacement algorithm
+		 * @param numBufs   		Number of frames in the buffer pool
+		 * @param bufferStatTable	Frame metadata of the buffer pool, used to check pin counts
+		 * @return  				Newly allocated policy, owned by the caller.
+		 */
+		static ReplacementPolicy *create(ReplacementPolicyType type, std::uint32_t numBufs, FrameTable *bufferStatTable);
+
+		virtual ~ReplacementPolicy() {}
+
+		/**
+		 * Name of the replacement algorithm.
+		 */
+		virtual const char *name() const = 0;
+
+		/**
+		 * The page in a resident frame was referenced again.
+		 *
+		 * @param frame   	Frame that was hit
+		 */
+		virtual void recordAccess(const FrameId frame) = 0;
+
+		/**
+		 * A page has been placed in a frame handed out.
+		 *
+		 * @param frame   	Frame now holding the page
+		 * @param file   	File of the page
+		 * @param pageNo  	Page number in the file
+		 */
+		virtual void recordInsert(const FrameId frame, const File *file, const PageId pageNo) = 0;
+
+		/**
+		 * The page in a resident frame chosen by pickVictim has been evicted. The frame
+		 * is handed out to the caller.
+		 *
+		 * @param frame   	Frame whose page was evicted
+		 */
+		virtual void recordEvict(const FrameId frame) = 0;
+
+		/**
+		 * A frame was emptied without being chosen as victim (the file was flushed, the
+		 * page disposed, or a frame handed out was not used). The frame becomes free.
+		 *
+		 * @param frame   	Frame that no longer holds a page
+		 */
+		virtual void recordRemove(const FrameId frame) = 0;
+
+		/**
+		 * Chooses an unpinned resident frame to reuse. It is handed out once the caller
+		 * reports recordEvict.
+		 *
+		 * @param frame   	Frame chosen, returned via this variable
+		 * @return  		False if no resident frame is unpinned
+		 */
+		virtual bool pickVictim(FrameId &frame) = 0;
+
+		/**
+		 * Lists unpinned resident frames roughly in the order pickVictim would evict
+		 * them, without changing any state. Used to clean pages before they are evicted.
+		 *
+		 * @param count   	Maximum number of frames to list
+		 * @param frames  	Frames listed, appended to this vector
+		 */
+		virtual void upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames) = 0;
+
+	protected:
+		/**
+		 * Constructor, used by subclasses
+		 */
+		ReplacementPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable);
+
+		/**
+		 * Returns true if the frame's page is pinned or the frame is handed out.
+		 */
+		bool isPinned(const FrameId frame) const;
+
+		/**
+		 * Returns true if the frame holds a page.
+		 */
+		bool isValid(const FrameId frame) const;
+
+		/**
+		 * Reads the reference bit of a frame.
+		 */
+		bool isReferenced(const FrameId frame) const;
+
+		/**
+		 * Sets or clears the reference bit of a frame.
+		 */
+		void setReferenced(const FrameId frame, const bool referenced);
+
+		/**
+		 * Number of frames in the buffer pool
+		 */
+		std::uint32_t numBufs;
+
+		/**
+		 * Frame metadata of the buffer pool
+		 */
+		FrameTable *bufferStatTable;
+	};
+
+	/**
+	 * @brief The clock (second chance) algorithm, using the refbit of each frame
+	 *
+	 * The hand sweeps the frame table's bitmaps 64 frames at a time (256 with AVX2), but
+	 * frames are chosen and given their second chance exactly as by a sweep of one frame
+	 * at a time.
+	 */
+	class ClockPolicy : public ReplacementPolicy
+	{
+	public:
+		ClockPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable);
+		const char *name() const { return "CLOCK"; }
+		void recordAccess(const FrameId frame);
+		void recordInsert(const FrameId frame, const File *file, const PageId pageNo);
+		void recordEvict(const FrameId frame);
+		void recordRemove(const FrameId frame);
+		bool pickVictim(FrameId &frame);
+		void upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames);
+
+	private:
+		/**
+		 * Current position of clockhand in our buffer pool
+		 */
+		FrameId clockHand;
+
+		/**
+		 * Takes the first unpinned frame of a word, among those selected by mask, that is
+		 * invalid or unreferenced, and moves the hand to it. Unpinned frames passed get
+		 * their second chance.
+		 *
+		 * @param word   			Bitmap word of the frame table
+		 * @param mask   			Frames of the word to consider
+		 * @param frame   			Frame taken, returned via this variable
+		 * @param unpinnedSeen   	Set to true if any frame considered is unpinned
+		 * @return  				False if no frame of the word could be taken
+		 */
+		bool takeVictim(const std::uint32_t word, const std::uint64_t mask, FrameId &frame, bool &unpinnedSeen);
+	};
+
+	/**
+	 * @brief LRU-K with K = 2: evicts the page whose second most recent reference is oldest.
+	 *
+	 * Pages referenced only once are evicted first, in LRU order. Reference history of
+	 * evicted pages is retained for as many pages as there are frames, so a page read
+	 * in again soon keeps its history.
+	 */
+	class LruKPolicy : public ReplacementPolicy
+	{
+	public:
+		/**
+		 * Number of references tracked per page
+		 */
+		static const int K = 2;
+
+		LruKPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable);
+		const char *name() const { return "LRU-2"; }
+		void recordAccess(const FrameId frame);
+		void recordInsert(const FrameId frame, const File *file, const PageId pageNo);
+		void recordEvict(const FrameId frame);
+		void recordRemove(const FrameId frame);
+		bool pickVictim(FrameId &frame);
+		void upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames);
+
+	private:
+		/**
+		 * Logical times of the last K references of a page, most recent first; 0 if unused
+		 */
+		struct History
+		{
+			std::uint64_t refs[K];
+		};
+
+		/**
+		 * Eviction order of a resident frame: oldest K-th reference first, then oldest last reference
+		 */
+		struct OrderKey
+		{
+			std::uint64_t kthRef;
+			std::uint64_t lastRef;
+			FrameId frame;
+
+			bool operator<(const OrderKey &rhs) const
+			{
+				if (kthRef != rhs.kthRef)
+					return kthRef < rhs.kthRef;
+				if (lastRef != rhs.lastRef)
+					return lastRef < rhs.lastRef;
+				return frame < rhs.frame;
+			}
+		};
+
+		/**
+		 * Retained history of an evicted page
+		 */
+		struct Retained
+		{
+			History history;
+			std::list<PageKey>::iterator age;
+		};
+
+		OrderKey orderKey(const FrameId frame) const;
+		void touch(const FrameId frame);
+
+		std::mutex latch;
+		std::uint64_t now;
+		std::vector<History> history;
+		std::vector<PageKey> keys;
+		std::vector<bool> resident;
+		std::set<OrderKey> order;
+		std::unordered_map<PageKey, Retained, PageKeyHash> retained;
+		std::list<PageKey> retainedAge;
+	};
+
+	/**
+	 * @brief Full 2Q: new pages enter a FIFO (A1in); pages referenced again after leaving
+	 * it (found in the A1out ghost queue) go to the LRU main queue (Am).
+	 */
+	class TwoQPolicy : public ReplacementPolicy
+	{
+	public:
+		TwoQPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable);
+		const char *name() const { return "2Q"; }
+		void recordAccess(const FrameId frame);
+		void recordInsert(const FrameId frame, const File *file, const PageId pageNo);
+		void recordEvict(const FrameId frame);
+		void recordRemove(const FrameId frame);
+		bool pickVictim(FrameId &frame);
+		void upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames);
+
+	private:
+		enum Queue
+		{
+			NONE,
+			A1IN,
+			AM
+		};
+
+		void unlink(const FrameId frame);
+
+		std::mutex latch;
+		std::size_t kin;
+		std::size_t kout;
+		std::list<FrameId> a1in;
+		std::list<FrameId> am;
+		std::vector<Queue> queue;
+		std::vector<std::list<FrameId>::iterator> position;
+		std::vector<PageKey> keys;
+		std::list<PageKey> a1out;
+		std::unordered_map<PageKey, std::list<PageKey>::iterator, PageKeyHash> a1outIndex;
+	};
+
+	/**
+	 * @brief Adaptive Replacement Cache: balances a recency list (T1) against a frequency
+	 * list (T2) using ghost lists (B1, B2) of recently evicted pages.
+	 */
+	class ArcPolicy : public ReplacementPolicy
+	{
+	public:
+		ArcPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable);
+		const char *name() const { return "ARC"; }
+		void recordAccess(const FrameId frame);
+		void recordInsert(const FrameId frame, const File *file, const PageId pageNo);
+		void recordEvict(const FrameId frame);
+		void recordRemove(const FrameId frame);
+		bool pickVictim(FrameId &frame);
+		void upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames);
+
+	private:
+		enum List
+		{
+			NONE,
+			T1,
+			T2
+		};
+
+		/**
+		 * LRU list of page keys with an index for removal by key
+		 */
+		struct GhostList
+		{
+			std::list<PageKey> keys;
+			std::unordered_map<PageKey, std::list<PageKey>::iterator, PageKeyHash> index;
+
+			bool erase(const PageKey &key);
+			void pushFront(const PageKey &key);
+			void popBack();
+			std::size_t size() const { return keys.size(); }
+		};
+
+		void unlink(const FrameId frame);
+		bool pickFrom(std::list<FrameId> &list, FrameId &frame);
+		void listFrom(const std::list<FrameId> &list, const std::uint32_t count, std::vector<FrameId> &frames) const;
+
+		std::mutex latch;
+		std::size_t target;
+		std::list<FrameId> t1;
+		std::list<FrameId> t2;
+		GhostList b1;
+		GhostList b2;
+		std::vector<List> list;
+		std::vector<std::list<FrameId>::iterator> position;
+		std::vector<PageKey> keys;
+	};
+
+	/**
+	 * @brief CLOCK-Pro: a clock over hot pages, resident cold pages and non-resident cold
+	 * pages in their test period, with the cold page allocation adapted to the workload.
+	 */
+	class ClockProPolicy : public ReplacementPolicy
+	{
+	public:
+		ClockProPolicy(std::uint32_t numBufs, FrameTable *bufferStatTable);
+		const char *name() const { return "CLOCK-Pro"; }
+		void recordAccess(const FrameId frame);
+		void recordInsert(const FrameId frame, const File *file, const PageId pageNo);
+		void recordEvict(const FrameId frame);
+		void recordRemove(const FrameId frame);
+		bool pickVictim(FrameId &frame);
+		void upcomingVictims(const std::uint32_t count, std::vector<FrameId> &frames);
+
+	private:
+		/**
+		 * Entry of the clock. Non-resident entries have frame == NO_FRAME.
+		 */
+		struct Entry
+		{
+			PageKey key;
+			FrameId frame;
+			bool hot;
+			bool test;
+		};
+
+		typedef std::list<Entry>::iterator Hand;
+
+		static const FrameId NO_FRAME = ~0u;
+
+		Hand next(Hand hand);
+		void insertEntry(const Entry &entry);
+		void eraseEntry(Hand entry);
+		void runHandHot();
+		void runHandTest();
+
+		std::mutex latch;
+		std::list<Entry> clock;
+		Hand handHot;
+		Hand handCold;
+		Hand handTest;
+		std::vector<Hand> entryOf;
+		std::unordered_map<PageKey, Hand, PageKeyHash> nonResident;
+		std::size_t countHot;
+		std::size_t countCold;
+		std::size_t coldTarget;
+	};
+
+}